@@ -38,7 +38,11 @@
 // a la salida y se pueden cambiar sin perder el patrón.
 // ---------------------------------------------------------------------------
 
-static const int ACID_MAX_STEPS = 16;
+// 16 pasos es el compás del 303 y la unidad de todo lo que hay aquí; los patrones pueden
+// llegar a cuatro compases. Los bucles que consumen RNG recorren al menos ACID_BASE_STEPS:
+// así una semilla da exactamente el mismo patrón de 16 que antes de existir los largos.
+static const int ACID_BASE_STEPS = 16;
+static const int ACID_MAX_STEPS = 64;
 
 // Escalas sin la octava: el grado que la cierra es el 0 de la octava siguiente, y así
 // el mismo índice de grado sirve para subir y bajar sin casos especiales.
@@ -60,12 +64,9 @@ static const AcidScale ACID_SCALES[] = {
 };
 static const int ACID_SCALES_LEN = 8;
 
-static const char* ACID_NOTE_NAMES[12] =
-	{"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
-
 // Los mandos de carácter, todos 0..1 salvo los que se dicen.
 struct AcidGenParams {
-	int steps = 16;        // 1..16
+	int steps = 16;        // 1..ACID_MAX_STEPS
 	int scale = 0;         // índice en ACID_SCALES
 	float density = 0.6f;  // cuántos pasos suenan
 	float accent = 0.55f;  // cuántos llevan acento
@@ -264,7 +265,7 @@ struct AcidGen {
 		// Desplazamiento por repetición dentro del vocabulario. La probabilidad ya no
 		// depende de RANGO: ese mando queda reservado al ámbito en octavas.
 		int vocShift[ACID_MAX_STEPS] = {};
-		for (int rep = 1; rep * CELL < ACID_MAX_STEPS; rep++) {
+		for (int rep = 1; rep * CELL < std::max(len, ACID_BASE_STEPS); rep++) {
 			if (nv > 1 && uniform() < 0.45f) {
 				static const int SHIFT[6] = {1, -1, 1, -1, 2, -2};
 				vocShift[rep] = SHIFT[(int) (uniform() * 6.f) % 6];
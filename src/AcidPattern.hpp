@@ -19,12 +19,13 @@ struct AcidPitchEvent {
 };
 
 struct AcidPatternV4 {
-	static const uint8_t SCHEMA_VERSION = 4;
+	// v5: patrones de hasta ACID_MAX_STEPS pasos y cadenas de slots en ATEK303 SEQ.
+	static const uint8_t SCHEMA_VERSION = 5;
 	static const uint8_t ALGORITHM_VERSION = 4;
 
 	uint32_t seed = 1u;
 	uint8_t algorithmVersion = ALGORITHM_VERSION;
-	uint8_t timeLength = ACID_MAX_STEPS;
+	uint8_t timeLength = ACID_BASE_STEPS;
 	uint8_t pitchLength = 1;
 	AcidTimeState time[ACID_MAX_STEPS] = {};
 	AcidPitchEvent pitch[ACID_MAX_STEPS] = {};
@@ -32,7 +33,7 @@ struct AcidPatternV4 {
 	void clear() {
 		seed = 1u;
 		algorithmVersion = ALGORITHM_VERSION;
-		timeLength = ACID_MAX_STEPS;
+		timeLength = ACID_BASE_STEPS;
 		pitchLength = 1;
 		for (int i = 0; i < ACID_MAX_STEPS; i++) {
 			time[i] = AcidTimeState::Rest;
@@ -132,6 +133,24 @@ struct AcidPatternV4 {
 		}
 	}
 
+	// Alarga el patrón hasta `length` pasos repitiendo su bucle, así que suena igual que
+	// antes de crecer; nunca lo acorta. Cada NOTE nueva repite la altura de la NOTE a la
+	// que copia. Supone un patrón saneado, con una altura por NOTE como mínimo.
+	void extend(int length) {
+		length = std::min(length, ACID_MAX_STEPS);
+		const int loop = timeLength;
+		if (length <= loop) return;
+		const int notes = noteCount();
+		for (int s = loop; s < length; s++)
+			time[s] = time[s - loop];
+		timeLength = (uint8_t) length;
+		if (notes == 0) return;
+		const int total = noteCount();
+		for (int i = notes; i < total; i++)
+			pitch[i] = pitch[i - notes];
+		pitchLength = (uint8_t) total;
+	}
+
 	// Importación sin pérdida audible desde la rejilla v3. Las alturas almacenadas bajo
 	// REST no tenían ataque ni semántica musical y se descartan deliberadamente.
 	void importRendered(const AcidGen& in, int length, uint32_t importedSeed,
@@ -379,14 +398,15 @@ struct AcidDualGenerator {
 		}
 
 		int vocabShift[ACID_MAX_STEPS] = {};
-		for (int rep = 1; rep * cell < ACID_MAX_STEPS; rep++) {
+		const int rngSpan = std::max(length, ACID_BASE_STEPS);
+		for (int rep = 1; rep * cell < rngSpan; rep++) {
 			if (vocabLength > 1 && pitchRng.unit() < 0.45f) {
 				static const int SHIFT[6] = {1, -1, 1, -1, 2, -2};
 				vocabShift[rep] = SHIFT[(int) (pitchRng.unit() * 6.f) % 6];
 			}
 		}
 
-		for (int i = 0; i < ACID_MAX_STEPS; i++) {
+		for (int i = 0; i < rngSpan; i++) {
 			const int cellPos = i % cell;
 			const int rep = i / cell;
 			int vi = (cellVocab[cellPos] + vocabShift[rep]) % vocabLength;
@@ -610,3 +630,196 @@ struct AcidPatternMutator {
 		return false;
 	}
 };
+
+// Historial de mutaciones para undo/redo de varios niveles. No guarda patrones enteros:
+// cada mutación se reduce a la lista de campos que cambió (celda de tiempo, evento de
+// altura o longitud de capa) con su valor antes y después. Todo vive en dos anillos de
+// tamaño fijo, así que grabar, deshacer y rehacer no reservan memoria en el hilo de audio.
+struct AcidPatternDelta {
+	enum Field : uint8_t { TimeCell = 0, PitchEvent = 1, Length = 2 };
+	uint8_t field = TimeCell;
+	uint8_t index = 0;     // paso, evento, o 0 = timeLength / 1 = pitchLength
+	uint16_t before = 0;
+	uint16_t after = 0;
+
+	// degree cabe en int8 (±24) y octave en tres bits (-2..2); acento y slide, un bit cada uno.
+	static uint16_t packPitch(const AcidPitchEvent& p) {
+		return (uint16_t) ((uint8_t) p.degree
+		                   | (((p.octave + 2) & 7) << 8)
+		                   | (p.accent ? 1 << 11 : 0)
+		                   | (p.slideOut ? 1 << 12 : 0));
+	}
+
+	static AcidPitchEvent unpackPitch(uint16_t v) {
+		AcidPitchEvent p;
+		p.degree = (int8_t) std::max(-24, std::min((int) (int8_t) (v & 0xff), 24));
+		p.octave = (int8_t) std::max(-2, std::min((int) ((v >> 8) & 7) - 2, 2));
+		p.accent = (v >> 11) & 1;
+		p.slideOut = (v >> 12) & 1;
+		return p;
+	}
+
+	static void apply(AcidPatternV4& pattern, uint8_t field, uint8_t index, uint16_t value) {
+		if (field == TimeCell && index < ACID_MAX_STEPS)
+			pattern.time[index] = (AcidTimeState) std::min((int) value, (int) AcidTimeState::Tie);
+		else if (field == PitchEvent && index < ACID_MAX_STEPS)
+			pattern.pitch[index] = unpackPitch(value);
+		else if (field == Length) {
+			const uint8_t length = (uint8_t) std::max(1, std::min((int) value, ACID_MAX_STEPS));
+			if (index == 0) pattern.timeLength = length;
+			else if (index == 1) pattern.pitchLength = length;
+		}
+	}
+};
+
+struct AcidPatternHistory {
+	static const int MAX_ENTRIES = 256;
+	static const int MAX_DELTAS = 4096;
+	// Peor caso de una mutación: todas las celdas, todos los eventos y las dos longitudes.
+	static const int MAX_ENTRY_DELTAS = 2 * ACID_MAX_STEPS + 2;
+
+	struct Entry {
+		uint16_t first = 0;    // primer delta dentro del anillo `deltas`
+		uint16_t count = 0;
+		uint8_t target = 0;    // qué patrón del módulo mutó; la numeración la decide el módulo
+		uint32_t counterBefore = 0;
+		uint32_t counterAfter = 0;
+	};
+
+	Entry entries[MAX_ENTRIES];
+	AcidPatternDelta deltas[MAX_DELTAS];
+	int oldest = 0;      // posición en `entries` de la entrada más antigua
+	int size = 0;        // entradas guardadas
+	int cursor = 0;      // entradas aplicadas: [0, cursor) se deshacen, [cursor, size) se rehacen
+	int deltaHead = 0;   // siguiente delta libre
+	int deltaUsed = 0;
+
+	void clear() {
+		oldest = size = cursor = 0;
+		deltaHead = deltaUsed = 0;
+	}
+
+	bool canUndo() const { return cursor > 0; }
+	bool canRedo() const { return cursor < size; }
+	int undoCount() const { return cursor; }
+	int redoCount() const { return size - cursor; }
+	// Patrón que tocaría el siguiente undo/redo: el historial es uno para todo el módulo.
+	int undoTarget() const { return canUndo() ? entry(cursor - 1).target : -1; }
+	int redoTarget() const { return canRedo() ? entry(cursor).target : -1; }
+
+	// Acceso en orden cronológico (0 = la más antigua).
+	const Entry& entry(int i) const { return entries[(oldest + i) % MAX_ENTRIES]; }
+	const AcidPatternDelta& delta(const Entry& e, int i) const { return deltas[(e.first + i) % MAX_DELTAS]; }
+
+	static int diff(const AcidPatternV4& a, const AcidPatternV4& b,
+	                AcidPatternDelta (&out)[MAX_ENTRY_DELTAS]) {
+		int n = 0;
+		auto add = [&](uint8_t field, int index, uint16_t before, uint16_t after) {
+			AcidPatternDelta& d = out[n++];
+			d.field = field;
+			d.index = (uint8_t) index;
+			d.before = before;
+			d.after = after;
+		};
+		if (a.timeLength != b.timeLength)
+			add(AcidPatternDelta::Length, 0, a.timeLength, b.timeLength);
+		if (a.pitchLength != b.pitchLength)
+			add(AcidPatternDelta::Length, 1, a.pitchLength, b.pitchLength);
+		const int timeSpan = std::max(a.timeLength, b.timeLength);
+		for (int i = 0; i < timeSpan && i < ACID_MAX_STEPS; i++)
+			if (a.time[i] != b.time[i])
+				add(AcidPatternDelta::TimeCell, i, (uint16_t) a.time[i], (uint16_t) b.time[i]);
+		const int pitchSpan = std::max(a.pitchLength, b.pitchLength);
+		for (int i = 0; i < pitchSpan && i < ACID_MAX_STEPS; i++) {
+			const uint16_t before = AcidPatternDelta::packPitch(a.pitch[i]);
+			const uint16_t after = AcidPatternDelta::packPitch(b.pitch[i]);
+			if (before != after)
+				add(AcidPatternDelta::PitchEvent, i, before, after);
+		}
+		return n;
+	}
+
+	// Añade una entrada tras el cursor. Lo que quedaba por rehacer se descarta, como en
+	// cualquier editor; si no hay sitio se olvidan las entradas más antiguas.
+	bool push(uint32_t counterBefore, uint32_t counterAfter, const AcidPatternDelta* d, int n,
+	          int target = 0) {
+		if (n <= 0 || n > MAX_DELTAS) return false;
+		while (size > cursor) {
+			const Entry& last = entry(size - 1);
+			deltaHead = (deltaHead - last.count + MAX_DELTAS) % MAX_DELTAS;
+			deltaUsed -= last.count;
+			size--;
+		}
+		while (size > 0 && (size >= MAX_ENTRIES || deltaUsed + n > MAX_DELTAS)) {
+			deltaUsed -= entries[oldest].count;
+			oldest = (oldest + 1) % MAX_ENTRIES;
+			size--;
+			cursor--;
+		}
+		Entry& e = entries[(oldest + size) % MAX_ENTRIES];
+		e.first = (uint16_t) deltaHead;
+		e.count = (uint16_t) n;
+		e.target = (uint8_t) target;
+		e.counterBefore = counterBefore;
+		e.counterAfter = counterAfter;
+		for (int i = 0; i < n; i++)
+			deltas[(deltaHead + i) % MAX_DELTAS] = d[i];
+		deltaHead = (deltaHead + n) % MAX_DELTAS;
+		deltaUsed += n;
+		size++;
+		cursor = size;
+		return true;
+	}
+
+	// Olvida las entradas de un patrón (al regenerarlo, sus deltas ya no casan con él) y
+	// conserva las de los demás en su orden. Compacta en el sitio: las entradas y los deltas
+	// que quedan solo se mueven hacia atrás en sus anillos.
+	void forget(int target) {
+		int kept = 0, keptApplied = 0, used = 0;
+		int head = size > 0 ? entries[oldest].first : deltaHead;
+		for (int i = 0; i < size; i++) {
+			Entry e = entry(i);
+			if (e.target == target) continue;
+			for (int k = 0; k < e.count; k++)
+				deltas[(head + k) % MAX_DELTAS] = deltas[(e.first + k) % MAX_DELTAS];
+			e.first = (uint16_t) head;
+			head = (head + e.count) % MAX_DELTAS;
+			used += e.count;
+			entries[(oldest + kept) % MAX_ENTRIES] = e;
+			if (i < cursor) keptApplied++;
+			kept++;
+		}
+		size = kept;
+		cursor = keptApplied;
+		deltaHead = head;
+		deltaUsed = used;
+	}
+
+	bool record(const AcidPatternV4& before, const AcidPatternV4& after,
+	            uint32_t counterBefore, uint32_t counterAfter, int target = 0) {
+		AcidPatternDelta d[MAX_ENTRY_DELTAS];
+		return push(counterBefore, counterAfter, d, diff(before, after, d), target);
+	}
+
+	bool undo(AcidPatternV4& pattern, uint32_t& mutationCounter) {
+		if (!canUndo()) return false;
+		const Entry& e = entry(--cursor);
+		for (int i = e.count - 1; i >= 0; i--) {
+			const AcidPatternDelta& d = delta(e, i);
+			AcidPatternDelta::apply(pattern, d.field, d.index, d.before);
+		}
+		mutationCounter = e.counterBefore;
+		return true;
+	}
+
+	bool redo(AcidPatternV4& pattern, uint32_t& mutationCounter) {
+		if (!canRedo()) return false;
+		const Entry& e = entry(cursor++);
+		for (int i = 0; i < e.count; i++) {
+			const AcidPatternDelta& d = delta(e, i);
+			AcidPatternDelta::apply(pattern, d.field, d.index, d.after);
+		}
+		mutationCounter = e.counterAfter;
+		return true;
+	}
+};
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "AcidGen.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// Las piezas de ATEK303 SEQ que no dependen de Rack: la tabla de pasos compilada, sus
+// tamaños y el tracker de tempo. Van aparte, como `AcidPattern.hpp`, para que los bancos
+// offline (`tools/atek_seq.cpp`) las usen tal cual.
+
+static const int MAX_STEPS = ACID_MAX_STEPS;
+
+// Carriles: cada uno es una línea acid independiente (semilla, contador de mutación y
+// patrón propios) que comparte reloj, reset y mandos con los demás y sale por su canal
+// de los cables polifónicos.
+static const int MAX_LANES = 16;
+
+// Cada carril guarda ocho patrones (slots). La cadena dice en qué orden suenan y cuántas
+// vueltas da cada uno; todos los carriles siguen la misma cadena.
+static const int CHAIN_SLOTS = 8;
+static const int MAX_REPEATS = 16;
+
+// Lo que suena en cada paso, ya resuelto: V/Oct destino, qué tipo de gate y qué flags
+// salen. Solo cambia con el patrón, PASOS, ESCALA, RAÍZ o las opciones de menú, así que se
+// compila en esos eventos y el audio se limita a leerla. Va indexada [slot][paso][carril]:
+// todos los carriles comparten slot y paso, así que en cada muestra se lee una fila
+// contigua, y cambiar de slot en la cadena es cambiar de índice, sin compilar nada.
+struct SeqStepTable {
+	enum HoldKind : uint8_t { HOLD_NONE, HOLD_NORMAL, HOLD_TIED, HOLD_THROUGH };
+
+	float voct[CHAIN_SLOTS][MAX_STEPS][MAX_LANES] = {};
+	uint8_t holdKind[CHAIN_SLOTS][MAX_STEPS][MAX_LANES] = {};
+	bool gate[CHAIN_SLOTS][MAX_STEPS][MAX_LANES] = {};
+	bool accent[CHAIN_SLOTS][MAX_STEPS][MAX_LANES] = {};
+	bool slide[CHAIN_SLOTS][MAX_STEPS][MAX_LANES] = {};
+	// Duración del gate por HoldKind, en segundos desde el flanco: -1 en silencio, INFINITY
+	// si cruza al paso siguiente. Lo único que depende del periodo de reloj.
+	float holdTime[4] = {-1.f, 0.f, 0.f, INFINITY};
+
+	// El último paso de cada slot cuando la cadena pasa a otro: su slide y si el gate cruza
+	// dependen del primer paso del slot que sigue. Va indexada [slot][slot siguiente][carril];
+	// con el mismo slot en las dos posiciones coincide con holdKind/slide del último paso.
+	uint8_t wrapHold[CHAIN_SLOTS][CHAIN_SLOTS][MAX_LANES] = {};
+	bool wrapSlide[CHAIN_SLOTS][CHAIN_SLOTS][MAX_LANES] = {};
+
+	// Cómo sale el paso s de `gen` hacia el paso `next` de `to`, que es el mismo patrón salvo
+	// en el último paso de un slot cuando la cadena cambia de slot.
+	static void transition(const AcidGen& gen, int s, bool active, const AcidGen& to, int next,
+	                       int scaleIdx, bool legatoTies, uint8_t& hold, bool& slideOut) {
+		const bool nextActive = to.gate[next];
+		const bool tieIn = active && gen.tie[s];
+		const bool tieOut = active && nextActive && to.tie[next];
+		const int stepSemi = AcidGen::semiOf(gen.deg[s], gen.oct[s], scaleIdx);
+		const int nextSemi = AcidGen::semiOf(to.deg[next], to.oct[next], scaleIdx);
+		// PASOS puede cerrar el bucle antes del final y ESCALA puede colapsar dos grados.
+		// Se valida la transición que realmente va a sonar, no solo la que se generó.
+		slideOut = active && gen.slide[s] && nextActive
+		        && !tieIn && !to.tie[next] && stepSemi != nextSemi;
+		// Un tie real mantiene el gate desde su ataque hasta casi el final del último paso
+		// prolongado. Un slide, en cambio, solo cruza el cambio de paso si el usuario eligió
+		// la convención legato; en la convención corta cae antes y SLIDE mantiene viva la voz.
+		const bool legatoSlide = legatoTies && slideOut;
+		hold = !active ? HOLD_NONE
+		     : (tieOut || legatoSlide) ? HOLD_THROUGH
+		     : tieIn ? HOLD_TIED : HOLD_NORMAL;
+	}
+
+	void compile(int slot, int lane, const AcidGen& gen, int len, int scaleIdx, int rootSemi,
+	             int octaveBase, bool legatoTies) {
+		for (int s = 0; s < MAX_STEPS; s++) {
+			// El último paso se valida aquí contra el primero del mismo patrón (el slot se
+			// repite); compileWrap() cubre el paso a otro slot de la cadena.
+			const int next = (s + 1) % len;
+			const bool active = s < len && gen.gate[s];
+			const int stepSemi = AcidGen::semiOf(gen.deg[s], gen.oct[s], scaleIdx);
+			transition(gen, s, active, gen, next, scaleIdx, legatoTies,
+			           holdKind[slot][s][lane], slide[slot][s][lane]);
+			gate[slot][s][lane] = active;
+			accent[slot][s][lane] = active && gen.accent[s];
+			voct[slot][s][lane] = octaveBase + (rootSemi + stepSemi) / 12.f;
+		}
+	}
+
+	// Último paso de cada slot de un carril hacia el primero de cada slot; `gens` son los
+	// CHAIN_SLOTS patrones del carril.
+	void compileWrap(int lane, const AcidGen* gens, int len, int scaleIdx, bool legatoTies) {
+		const int s = len - 1;
+		for (int k = 0; k < CHAIN_SLOTS; k++)
+			for (int j = 0; j < CHAIN_SLOTS; j++)
+				transition(gens[k], s, gens[k].gate[s], gens[j], 0, scaleIdx, legatoTies,
+				           wrapHold[k][j][lane], wrapSlide[k][j][lane]);
+	}
+
+	void retime(float clockPeriod, float gateLen) {
+		const float gap = std::max(0.0015f, 0.03f * clockPeriod);
+		holdTime[HOLD_NORMAL] = std::min(gateLen * clockPeriod, clockPeriod - gap);
+		holdTime[HOLD_TIED] = clockPeriod - gap;
+	}
+};
+
+// Periodo del reloj de entrada, para lo que depende del tempo (duración del gate y glide).
+// Un reloj sacado de MIDI llega con jitter de un bloque de audio o más, y medir el periodo
+// flanco a flanco lo pasaba entero al gate. Aquí cada flanco se fecha por interpolación del
+// cruce de umbral, el periodo se suaviza con un filtro de un polo y un intervalo que se
+// aparta mucho de la estimación (un pulso perdido o duplicado) se descarta. Si dos seguidos
+// coinciden entre sí es un cambio de tempo de verdad, y se engancha al nuevo sin esperar.
+struct SeqTempoTracker {
+	static constexpr float THRESHOLD = 1.f;     // el umbral alto del Schmitt de CLOCK
+	static constexpr float MIN_PERIOD = 0.002f;
+	static constexpr float MAX_PERIOD = 4.f;
+	static constexpr float SMOOTHING = 0.25f;
+	static constexpr float TOLERANCE = 1.35f;   // intervalos fuera de [1/x, x] son atípicos
+
+	float period = 0.125f;
+	bool locked = false;
+	bool haveEdge = false;
+	// Tiempo desde el cruce del último flanco, no desde su muestra.
+	float sinceEdge = 0.f;
+	float prevV = 0.f;
+	float outlierPeriod = 0.f;
+	bool haveOutlier = false;
+
+	static bool near(float a, float b) {
+		return a < b * TOLERANCE && b < a * TOLERANCE;
+	}
+
+	// Llamar en cada muestra. Devuelve cuánto hace que se cruzó el umbral si `edge`, en
+	// segundos y dentro de esta muestra; 0 si no hubo flanco.
+	float process(float v, bool edge, float sampleTime) {
+		sinceEdge += sampleTime;
+		float late = 0.f;
+		if (edge) {
+			const float span = v - prevV;
+			const float frac = span > 1e-6f ? std::min(std::max((THRESHOLD - prevV) / span, 0.f), 1.f) : 1.f;
+			late = (1.f - frac) * sampleTime;
+			if (haveEdge)
+				measure(sinceEdge - late);
+			sinceEdge = late;
+			haveEdge = true;
+		}
+		prevV = v;
+		return late;
+	}
+
+	void measure(float interval) {
+		// Un reloj parado o un cable recién conectado no son un tempo.
+		if (interval < MIN_PERIOD || interval > MAX_PERIOD)
+			return;
+		if (!locked || near(interval, period)) {
+			period = locked ? period + SMOOTHING * (interval - period) : interval;
+			locked = true;
+			haveOutlier = false;
+		}
+		else if (haveOutlier && near(interval, outlierPeriod)) {
+			period = 0.5f * (interval + outlierPeriod);
+			haveOutlier = false;
+		}
+		else {
+			outlierPeriod = interval;
+			haveOutlier = true;
+		}
+	}
+};
@@ -188,14 +188,13 @@ struct Atek303 : Module {
 	static constexpr float ACCENT_STEP = 0.55f;   // cuánto carga cada acento
 	static constexpr float ACCENT_DEPTH = 0.8f;   // cuánto sube el acento efectivo
 
-	Atek303SeqMessage expMsgA, expMsgB;
+	ExpanderInbox<Atek303SeqMessage> expInbox;
 
 	Atek303() {
 		config(PARAMS_LEN, INPUTS_LEN, OUTPUTS_LEN, LIGHTS_LEN);
 		// Lado receptor del expander: el SEQ escribe aquí cuando está pegado a la
 		// izquierda. Un cable en cualquier jack siempre manda sobre el expander.
-		leftExpander.producerMessage = &expMsgA;
-		leftExpander.consumerMessage = &expMsgB;
+		expInbox.attach(leftExpander);
 
 		// Rangos tomados del wrapper VST original de Open303, para que el módulo
 		// se comporte exactamente igual que la referencia.
@@ -357,9 +356,8 @@ struct Atek303 : Module {
 			core.setSampleRate(sampleRate);
 		}
 
-		const Atek303SeqMessage* exp = NULL;
-		if (leftExpander.module && leftExpander.module->model == modelAtek303Seq)
-			exp = (const Atek303SeqMessage*) leftExpander.consumerMessage;
+		const Atek303SeqMessage* exp =
+			ExpanderInbox<Atek303SeqMessage>::read(leftExpander, modelAtek303Seq);
 
 		const float voct = inputs[VOCT_INPUT].isConnected()
 		                 ? inputs[VOCT_INPUT].getVoltage()
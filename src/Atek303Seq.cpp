@@ -1,9 +1,11 @@
 #include "plugin.hpp"
 #include "ui/AtekWidgets.hpp"
 #include "AcidPattern.hpp"
+#include "AcidSeq.hpp"
 
 #include <atomic>
 #include <cmath>
+#include <cstring>
 
 // ---------------------------------------------------------------------------
 // ATEK303 SEQ — generador de patrones acid.
@@ -11,13 +13,36 @@
 // No es un secuenciador de pasos: no hay knobs ni switches por paso. Hay un botón
 // GENERATE, unos mandos de carácter y un algoritmo. El modelo dual v4 vive en
 // `AcidPattern.hpp`, aparte y sin dependencias de Rack, para poder probarlo en el banco
-// offline (`tools/pattern_v4.cpp`); aquí queda el módulo: reloj, gate, salidas y panel.
+// offline (`tools/atek_seq.cpp`); aquí queda el módulo: reloj, gate, salidas y panel.
 // ---------------------------------------------------------------------------
 
-static const int MAX_STEPS = ACID_MAX_STEPS;
+// La fila de LEDs es de 16: con patrones más largos enseña la página del paso en curso.
+static const int LED_STEPS = 16;
+
+// Multiplicación/división del reloj de entrada, para seguir un reloj a negras o a corcheas
+// sin otro módulo delante.
+struct SeqClockRatio { const char* name; int mul, div; };
+static const SeqClockRatio CLOCK_RATIOS[] = {
+	{"÷4", 1, 4}, {"÷3", 1, 3}, {"÷2", 1, 2}, {"×1", 1, 1}, {"×2", 2, 1}, {"×3", 3, 1}, {"×4", 4, 1},
+};
+static const int CLOCK_RATIOS_LEN = sizeof(CLOCK_RATIOS) / sizeof(CLOCK_RATIOS[0]);
+
+// Nombres de la raíz, para el menú y la lectura del panel.
+static const char* ACID_NOTE_NAMES[12] =
+	{"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+
+// STEPS va de 1 a 16 como siempre y Pattern length lo multiplica: con 64 cada posición
+// son cuatro pasos. El tooltip enseña y acepta los pasos que suenan.
+struct SeqStepsQuantity : ParamQuantity {
+	std::string getDisplayValueString() override;
+	void setDisplayValueString(std::string s) override;
+};
 
 struct Atek303Seq : Module {
-	enum PatternAction { ACTION_NONE, MUTATE_TIME, MUTATE_PITCH, MUTATE_ARTICULATION, UNDO_MUTATION };
+	enum PatternAction {
+		ACTION_NONE, MUTATE_TIME, MUTATE_PITCH, MUTATE_ARTICULATION, UNDO_MUTATION, REDO_MUTATION,
+		GENERATE_ALL_LANES
+	};
 	enum ParamId {
 		GENERATE_PARAM, STEPS_PARAM, GATELEN_PARAM, DENSITY_PARAM, RANGE_PARAM,
 		ACCENT_PARAM, SLIDEAMT_PARAM, ROOT_PARAM, SCALE_PARAM,
@@ -27,29 +52,50 @@ struct Atek303Seq : Module {
 	};
 	static_assert(GENERATE_PARAM == 0 && SCALE_PARAM == 8 && SEED_LOCK_PARAM == 9,
 	              "No cambiar los IDs históricos de parámetros de ATEK303SEQ");
-	enum InputId { CLOCK_INPUT, RESET_INPUT, GEN_INPUT, INPUTS_LEN };
+	enum InputId { CLOCK_INPUT, RESET_INPUT, GEN_INPUT, UNDO_INPUT, REDO_INPUT, INPUTS_LEN };
 	enum OutputId { VOCT_OUTPUT, GATE_OUTPUT, ACCENT_OUTPUT, SLIDE_OUTPUT, EOC_OUTPUT, OUTPUTS_LEN };
 	enum LightId {
-		ENUMS(STEP_LIGHT, MAX_STEPS * 3),
+		ENUMS(STEP_LIGHT, LED_STEPS * 3),
 		GENERATE_LIGHT, SEED_LOCK_LIGHT, MUTATE_TIME_LIGHT, MUTATE_PITCH_LIGHT,
 		MUTATE_ARTICULATION_LIGHT, LIGHTS_LEN
 	};
 
-	AcidPatternV4 pattern;
-	AcidDualGenerator generator;
+	// Estado por carril y slot, en arrays paralelos. El carril 0, slot 0, es el de siempre:
+	// es el que se guarda en las claves de primer nivel del JSON y el que lee un ATEK303 SEQ
+	// anterior a los carriles.
+	AcidPatternV4 patterns[MAX_LANES][CHAIN_SLOTS];
 	// Vista temporal derivada. Mantenerla permite que el motor de audio, los LEDs y la
 	// comunicación con ATEK303 sigan siendo simples mientras el patrón ya vive en dos capas.
-	AcidGen gen;
-	uint32_t patternSeed = 1u;
+	AcidGen gens[MAX_LANES][CHAIN_SLOTS];
+	uint32_t seeds[MAX_LANES][CHAIN_SLOTS];
+	uint32_t mutationCounters[MAX_LANES][CHAIN_SLOTS] = {};
+	AcidGenParams generatedWith[MAX_LANES][CHAIN_SLOTS];
+	float glideVoct[MAX_LANES] = {};
+	bool prevSlide[MAX_LANES] = {};
+
+	AcidDualGenerator generator;
+	int laneCount = 1;
+	// Carril y slot a los que van GENERATE, BLOCK, las mutaciones y los LEDs.
+	int editLane = 0;
+	int editSlot = 0;
+	// Longitud con la que GENERATE crea patrones nuevos: 16, 32 o 64. También escala STEPS.
+	int patternLength = ACID_BASE_STEPS;
 	bool seedLocked = false;
-	AcidGenParams generatedWith;
-	AcidPatternV4 undoPattern;
-	uint32_t mutationCounter = 0;
-	uint32_t undoMutationCounter = 0;
-	bool hasUndo = false;
+	// Undo/redo de mutaciones en deltas, uno para todo el módulo: cada entrada lleva su
+	// carril y su slot. Una semilla nueva lo vacía: deshacer por encima de un GENERATE
+	// mezclaría dos identidades distintas.
+	AcidPatternHistory history;
 	std::atomic<int> pendingPatternAction {ACTION_NONE};
 
-	dsp::SchmittTrigger clockTrig, resetTrig, genTrig;
+	// Cadena: chainLength entradas, cada una un slot y sus repeticiones. Con una sola
+	// entrada (slot 1, una vuelta) el módulo es el de siempre.
+	int chainLength = 1;
+	int chainSlot[CHAIN_SLOTS] = {0, 1, 2, 3, 4, 5, 6, 7};
+	int chainRepeats[CHAIN_SLOTS] = {1, 1, 1, 1, 1, 1, 1, 1};
+	int chainPos = 0;
+	int chainRepeat = 0;
+
+	dsp::SchmittTrigger clockTrig, resetTrig, genTrig, undoTrig, redoTrig;
 	dsp::BooleanTrigger genButton, mutateTimeButton, mutatePitchButton, mutateArticulationButton;
 	dsp::PulseGenerator eocPulse, genPulse, mutateTimePulse, mutatePitchPulse, mutateArticulationPulse;
 
@@ -58,9 +104,35 @@ struct Atek303Seq : Module {
 	// una nota al cargarse y el primer clock se salta el paso 0.
 	bool clockStarted = false;
 	float stepTime = 0.f;
+	// Periodo de un paso: el de entrada ya suavizado, multiplicado o dividido.
 	float clockPeriod = 0.125f;
-	float glideVoct = 0.f;
-	bool prevSlide = false;
+	SeqTempoTracker tempo;
+	// Índice en CLOCK_RATIOS; 3 es ×1. divCount cuenta flancos para dividir; subIndex es la
+	// siguiente subdivisión al multiplicar (0 = ninguna pendiente) y subTimer el tiempo desde
+	// el cruce del flanco que las ancla.
+	int clockRatio = 3;
+	int divCount = 0;
+	int subIndex = 0;
+	float subTimer = 0.f;
+
+	SeqStepTable table;
+	// Lo que se compiló en la tabla. Los parámetros se comparan a ritmo de control; cada
+	// patrón marca su bit (carril, slot) al renderizarse. Solo se compilan los carriles que
+	// suenan; los demás esperan con el bit puesto a que se suba el número de carriles.
+	uint8_t dirtySlots[MAX_LANES];
+	bool tableDirty = true;
+	int tableLanes = 0;
+	int tableLen = ACID_BASE_STEPS;
+	// STEPS en la última comprobación: solo subirlo alarga los patrones (growPatterns).
+	int stepsSeen = ACID_BASE_STEPS;
+	int tableScale = 0;
+	int tableRoot = 0;
+	int tableOctave = 0;
+	bool tableLegato = false;
+	float tableGateLen = 0.f;
+	float tableSampleTime = 0.f;
+	float glideCoef = 1.f;
+	dsp::ClockDivider paramDivider;
 
 	// Nombre conservado por compatibilidad con el JSON de los patches existentes. Esta
 	// opción solo cambia la convención de los slides; los ties reales siempre sostienen gate.
@@ -78,7 +150,7 @@ struct Atek303Seq : Module {
 		config(PARAMS_LEN, INPUTS_LEN, OUTPUTS_LEN, LIGHTS_LEN);
 		configButton(GENERATE_PARAM,
 		             "New seed; with BLOCK, mutate time + notes/octaves + slides/accents");
-		configParam(STEPS_PARAM, 1.f, 16.f, 16.f, "Steps");
+		configParam<SeqStepsQuantity>(STEPS_PARAM, 1.f, 16.f, 16.f, "Steps");
 		getParamQuantity(STEPS_PARAM)->snapEnabled = true;
 		configParam(GATELEN_PARAM, 0.05f, 1.f, 0.85f, "Gate length", " %", 0.f, 100.f);
 		configParam(DENSITY_PARAM, 0.05f, 1.f, 0.65f, "Note density", " %", 0.f, 100.f);
@@ -102,21 +174,36 @@ struct Atek303Seq : Module {
 		configInput(CLOCK_INPUT, "Clock");
 		configInput(RESET_INPUT, "Reset");
 		configInput(GEN_INPUT, "GENERATE; with BLOCK, mutate all three layers (trigger)");
-		configOutput(VOCT_OUTPUT, "1V/oct");
-		configOutput(GATE_OUTPUT, "Gate");
-		configOutput(ACCENT_OUTPUT, "Accent");
-		configOutput(SLIDE_OUTPUT, "Slide");
+		configInput(UNDO_INPUT, "Undo mutation (trigger)");
+		configInput(REDO_INPUT, "Redo mutation (trigger)");
+		configOutput(VOCT_OUTPUT, "1V/oct (one channel per lane)");
+		configOutput(GATE_OUTPUT, "Gate (one channel per lane)");
+		configOutput(ACCENT_OUTPUT, "Accent (one channel per lane)");
+		configOutput(SLIDE_OUTPUT, "Slide (one channel per lane)");
 		configOutput(EOC_OUTPUT, "End of cycle");
-		generate();
+		paramDivider.setDivision(32);
+		for (int c = 0; c < MAX_LANES; c++) {
+			dirtySlots[c] = 0xff;
+			for (int k = 0; k < CHAIN_SLOTS; k++) {
+				seeds[c][k] = 1u;
+				generate(c, k, true);
+			}
+		}
 	}
 
-	int length() { return clamp((int) std::round(params[STEPS_PARAM].getValue()), 1, MAX_STEPS); }
+	int stepsScale() { return patternLength / ACID_BASE_STEPS; }
+	int length() {
+		return clamp((int) std::round(params[STEPS_PARAM].getValue()), 1, 16) * stepsScale();
+	}
 	int scaleIdx() { return clamp((int) std::round(params[SCALE_PARAM].getValue()), 0, ACID_SCALES_LEN - 1); }
 	int rootSemi() { return clamp((int) std::round(params[ROOT_PARAM].getValue()), 0, 11); }
 
+	// El historial numera los patrones como carril * CHAIN_SLOTS + slot.
+	static int historyTarget(int lane, int slot) { return lane * CHAIN_SLOTS + slot; }
+
 	AcidGenParams currentGenerationParams() {
 		AcidGenParams p;
-		p.steps = MAX_STEPS;
+		p.steps = clamp(patternLength, 1, MAX_STEPS);
 		p.scale = clamp((int) std::round(params[SCALE_PARAM].getValue()), 0, ACID_SCALES_LEN - 1);
 		p.density = std::max(0.05f, params[DENSITY_PARAM].getValue());
 		p.accent = params[ACCENT_PARAM].getValue();
@@ -126,42 +213,106 @@ struct Atek303Seq : Module {
 		return p;
 	}
 
-	void renderPattern() {
-		pattern.render(gen);
+	void renderPattern(int lane, int slot) {
+		patterns[lane][slot].render(gens[lane][slot]);
+		dirtySlots[lane] |= 1u << slot;
+		tableDirty = true;
 	}
 
-	void generate(bool forceNewSeed = false) {
+	void markAllDirty() {
+		for (int c = 0; c < MAX_LANES; c++) dirtySlots[c] = 0xff;
+		tableDirty = true;
+	}
+
+	void compileTable() {
+		tableLanes = clamp(laneCount, 1, MAX_LANES);
+		tableLen = length();
+		tableScale = scaleIdx();
+		tableRoot = rootSemi();
+		tableOctave = octaveBase;
+		tableLegato = legatoTies;
+		for (int c = 0; c < tableLanes; c++) {
+			if (!dirtySlots[c]) continue;
+			for (int k = 0; k < CHAIN_SLOTS; k++)
+				if (dirtySlots[c] & (1u << k))
+					table.compile(k, c, gens[c][k], tableLen, tableScale, tableRoot,
+					              tableOctave, tableLegato);
+			table.compileWrap(c, gens[c], tableLen, tableScale, tableLegato);
+			dirtySlots[c] = 0;
+		}
+		tableDirty = false;
+		retimeTable();
+	}
+
+	// El periodo se mide en cada flanco, así que esto corre una vez por paso: dos duraciones
+	// y la exponencial del glide, en vez de una exponencial por muestra.
+	void retimeTable() {
+		tableGateLen = params[GATELEN_PARAM].getValue();
+		table.retime(clockPeriod, tableGateLen);
+		// La constante va atada al paso, no en milisegundos fijos: así el slide ocupa
+		// la misma fracción de la nota a cualquier tempo, que es lo que lo hace sonar
+		// a 303 y no a portamento de sintetizador.
+		const float tau = clamp(0.45f * clockPeriod, 0.005f, 1.f);
+		glideCoef = 1.f - std::exp(-tableSampleTime / tau);
+	}
+
+	// Subir STEPS por encima de la longitud de un patrón lo alarga repitiendo su bucle, así
+	// que lo que ya sonaba sigue igual. No es una mutación: no toca el historial ni el
+	// contador, y bajar STEPS no acorta nada.
+	void growPatterns(int len) {
+		for (int c = 0; c < MAX_LANES; c++)
+			for (int k = 0; k < CHAIN_SLOTS; k++)
+				if (patterns[c][k].timeLength < len) {
+					patterns[c][k].extend(len);
+					renderPattern(c, k);
+				}
+	}
+
+	void checkTableParams() {
+		if (length() > stepsSeen)
+			growPatterns(length());
+		stepsSeen = length();
+		if (length() != tableLen || scaleIdx() != tableScale || rootSemi() != tableRoot
+		    || octaveBase != tableOctave || legatoTies != tableLegato)
+			markAllDirty();
+		else if (params[GATELEN_PARAM].getValue() != tableGateLen)
+			retimeTable();
+	}
+
+	void generate(int lane, int slot, bool forceNewSeed = false) {
+		uint32_t& seed = seeds[lane][slot];
 		if (forceNewSeed || !seedLocked)
-			patternSeed = random::u32();
-		if (!patternSeed) patternSeed = 1u;
-		generatedWith = currentGenerationParams();
-		generator.generate(pattern, generatedWith, patternSeed);
-		renderPattern();
-		mutationCounter = 0;
-		hasUndo = false;
+			seed = random::u32();
+		if (!seed) seed = 1u;
+		generatedWith[lane][slot] = currentGenerationParams();
+		generator.generate(patterns[lane][slot], generatedWith[lane][slot], seed);
+		renderPattern(lane, slot);
+		mutationCounters[lane][slot] = 0;
+		history.forget(historyTarget(lane, slot));
 	}
 
-	bool mutatePattern(AcidPatternMutator::Layer layer) {
+	bool mutatePattern(int lane, int slot, AcidPatternMutator::Layer layer) {
+		AcidPatternV4& pattern = patterns[lane][slot];
+		uint32_t& counter = mutationCounters[lane][slot];
 		const AcidPatternV4 before = pattern;
-		const uint32_t beforeCounter = mutationCounter;
+		const uint32_t beforeCounter = counter;
 		const int operations = layer == AcidPatternMutator::Articulation ? 3 : 2;
 		uint32_t lastMutationIndex = beforeCounter;
 		if (AcidPatternMutator::mutateBurst(pattern, layer, beforeCounter + 1,
 		                                    operations, scaleIdx(), lastMutationIndex)) {
-			undoPattern = before;
-			undoMutationCounter = beforeCounter;
-			mutationCounter = lastMutationIndex;
-			hasUndo = true;
-			renderPattern();
+			counter = lastMutationIndex;
+			history.record(before, pattern, beforeCounter, counter, historyTarget(lane, slot));
+			renderPattern(lane, slot);
 			return true;
 		}
 		pattern = before;
 		return false;
 	}
 
-	bool mutateAllLayers() {
+	bool mutateAllLayers(int lane, int slot) {
+		AcidPatternV4& pattern = patterns[lane][slot];
 		const AcidPatternV4 before = pattern;
-		const uint32_t beforeCounter = mutationCounter;
+		const uint32_t beforeCounter = mutationCounters[lane][slot];
 		uint32_t cursor = beforeCounter;
 		const AcidPatternMutator::Layer layers[3] = {
 			AcidPatternMutator::Time,
@@ -178,171 +329,291 @@ struct Atek303Seq : Module {
 			}
 			cursor = lastMutationIndex;
 		}
-		undoPattern = before;
-		undoMutationCounter = beforeCounter;
-		mutationCounter = cursor;
-		hasUndo = true;
-		renderPattern();
+		mutationCounters[lane][slot] = cursor;
+		history.record(before, pattern, beforeCounter, cursor, historyTarget(lane, slot));
+		renderPattern(lane, slot);
 		return true;
 	}
 
 	bool undoMutation() {
-		if (!hasUndo) return false;
-		pattern = undoPattern;
-		mutationCounter = undoMutationCounter;
-		hasUndo = false;
-		renderPattern();
+		const int target = history.undoTarget();
+		if (target < 0 || target >= MAX_LANES * CHAIN_SLOTS)
+			return false;
+		const int lane = target / CHAIN_SLOTS, slot = target % CHAIN_SLOTS;
+		if (!history.undo(patterns[lane][slot], mutationCounters[lane][slot]))
+			return false;
+		renderPattern(lane, slot);
+		genPulse.trigger(0.12f);
+		return true;
+	}
+
+	bool redoMutation() {
+		const int target = history.redoTarget();
+		if (target < 0 || target >= MAX_LANES * CHAIN_SLOTS)
+			return false;
+		const int lane = target / CHAIN_SLOTS, slot = target % CHAIN_SLOTS;
+		if (!history.redo(patterns[lane][slot], mutationCounters[lane][slot]))
+			return false;
+		renderPattern(lane, slot);
 		genPulse.trigger(0.12f);
 		return true;
 	}
 
+	// Un paso adelante. La vuelta al 0 pasa siempre por aquí, también la de una subdivisión
+	// saltada: cambia de slot en la cadena y dispara EOC.
+	void advanceStep(int len) {
+		step = (step + 1) % len;
+		if (step == 0) {
+			advanceChain();
+			eocPulse.trigger(1e-3f);
+		}
+	}
+
+	// Slot que suena cuando acabe esta vuelta del slot en curso.
+	int nextChainSlot() const {
+		const int entries = clamp(chainLength, 1, CHAIN_SLOTS);
+		int pos = chainPos;
+		if (chainRepeat + 1 >= clamp(chainRepeats[chainPos], 1, MAX_REPEATS))
+			pos = (pos + 1) % entries;
+		return clamp(chainSlot[pos], 0, CHAIN_SLOTS - 1);
+	}
+
+	// Se llama en el flanco que devuelve el paso a 0: el cambio de slot cae exactamente en
+	// esa muestra, y la tabla del slot nuevo ya está compilada.
+	void advanceChain() {
+		const int entries = clamp(chainLength, 1, CHAIN_SLOTS);
+		if (chainPos >= entries) {
+			chainPos = 0;
+			chainRepeat = 0;
+			return;
+		}
+		if (++chainRepeat >= clamp(chainRepeats[chainPos], 1, MAX_REPEATS)) {
+			chainRepeat = 0;
+			chainPos = (chainPos + 1) % entries;
+		}
+	}
+
 	void onReset(const ResetEvent& e) override {
 		Module::onReset(e);
 		step = 0;
+		laneCount = 1;
+		editLane = 0;
+		editSlot = 0;
+		patternLength = ACID_BASE_STEPS;
+		stepsSeen = ACID_BASE_STEPS;
+		chainLength = 1;
+		for (int i = 0; i < CHAIN_SLOTS; i++) {
+			chainSlot[i] = i;
+			chainRepeats[i] = 1;
+		}
+		chainPos = chainRepeat = 0;
+		clockRatio = 3;
 		seedLocked = params[SEED_LOCK_PARAM].getValue() > 0.5f;
-		generate();
+		// El historial de undo vive solo en memoria: un patch cargado empieza sin él.
+		history.clear();
+		for (int c = 0; c < MAX_LANES; c++)
+			for (int k = 0; k < CHAIN_SLOTS; k++)
+				generate(c, k);
 	}
 
 	void process(const ProcessArgs& args) override {
 		seedLocked = params[SEED_LOCK_PARAM].getValue() > 0.5f;
+		const int lane = clamp(editLane, 0, MAX_LANES - 1);
+		const int eslot = clamp(editSlot, 0, CHAIN_SLOTS - 1);
 		const bool genPressed = genButton.process(params[GENERATE_PARAM].getValue() > 0.5f);
 		const bool genTrigged = genTrig.process(inputs[GEN_INPUT].getVoltage(), 0.1f, 1.f);
 		if (genPressed || genTrigged) {
 			if (seedLocked) {
-				if (mutateAllLayers()) {
+				if (mutateAllLayers(lane, eslot)) {
 					mutateTimePulse.trigger(0.12f);
 					mutatePitchPulse.trigger(0.12f);
 					mutateArticulationPulse.trigger(0.12f);
 				}
 			}
 			else {
-				generate();
+				generate(lane, eslot);
 			}
 			genPulse.trigger(0.12f);
 		}
 		if (mutateTimeButton.process(params[MUTATE_TIME_PARAM].getValue() > 0.5f)
-		    && mutatePattern(AcidPatternMutator::Time))
+		    && mutatePattern(lane, eslot, AcidPatternMutator::Time))
 			mutateTimePulse.trigger(0.12f);
 		if (mutatePitchButton.process(params[MUTATE_PITCH_PARAM].getValue() > 0.5f)
-		    && mutatePattern(AcidPatternMutator::Pitch))
+		    && mutatePattern(lane, eslot, AcidPatternMutator::Pitch))
 			mutatePitchPulse.trigger(0.12f);
 		if (mutateArticulationButton.process(params[MUTATE_ARTICULATION_PARAM].getValue() > 0.5f)
-		    && mutatePattern(AcidPatternMutator::Articulation))
+		    && mutatePattern(lane, eslot, AcidPatternMutator::Articulation))
 			mutateArticulationPulse.trigger(0.12f);
 		const int action = pendingPatternAction.exchange(ACTION_NONE);
-		if (action == MUTATE_TIME && mutatePattern(AcidPatternMutator::Time))
+		if (action == MUTATE_TIME && mutatePattern(lane, eslot, AcidPatternMutator::Time))
 			mutateTimePulse.trigger(0.12f);
-		else if (action == MUTATE_PITCH && mutatePattern(AcidPatternMutator::Pitch))
+		else if (action == MUTATE_PITCH && mutatePattern(lane, eslot, AcidPatternMutator::Pitch))
 			mutatePitchPulse.trigger(0.12f);
-		else if (action == MUTATE_ARTICULATION && mutatePattern(AcidPatternMutator::Articulation))
+		else if (action == MUTATE_ARTICULATION
+		         && mutatePattern(lane, eslot, AcidPatternMutator::Articulation))
 			mutateArticulationPulse.trigger(0.12f);
 		else if (action == UNDO_MUTATION) undoMutation();
+		else if (action == REDO_MUTATION) redoMutation();
+		else if (action == GENERATE_ALL_LANES) {
+			// Solo los carriles activos: los ocultos conservan su patrón y su semilla.
+			for (int c = 0; c < clamp(laneCount, 1, MAX_LANES); c++)
+				generate(c, eslot, true);
+			genPulse.trigger(0.12f);
+		}
+		if (undoTrig.process(inputs[UNDO_INPUT].getVoltage(), 0.1f, 1.f)) undoMutation();
+		if (redoTrig.process(inputs[REDO_INPUT].getVoltage(), 0.1f, 1.f)) redoMutation();
 
 		if (resetTrig.process(inputs[RESET_INPUT].getVoltage(), 0.1f, 1.f)) {
 			// Reset deja el paso 0 preparado, no en curso: lo arranca el siguiente flanco,
-			// que es lo que espera cualquier reloj con reset.
+			// que es lo que espera cualquier reloj con reset. La cadena vuelve a su principio.
 			step = 0;
 			stepTime = 0.f;
 			clockStarted = false;
+			chainPos = chainRepeat = 0;
+			divCount = 0;
+			subIndex = 0;
+		}
+		const int lanes = clamp(laneCount, 1, MAX_LANES);
+		if (paramDivider.process())
+			checkTableParams();
+		if (args.sampleTime != tableSampleTime) {
+			tableSampleTime = args.sampleTime;
+			retimeTable();
 		}
-		const int len = length();
-		if (clockTrig.process(inputs[CLOCK_INPUT].getVoltage(), 0.1f, 1.f)) {
+		if (tableDirty || lanes != tableLanes)
+			compileTable();
+
+		// Reloj, reset, paso y cadena son uno para todos los carriles: cada carril extra solo
+		// añade unas lecturas de la fila de la tabla.
+		const int len = tableLen;
+		const float clockV = inputs[CLOCK_INPUT].getVoltage();
+		const bool edge = clockTrig.process(clockV, 0.1f, 1.f);
+		const float edgeLate = tempo.process(clockV, edge, args.sampleTime);
+		const int ratio = clamp(clockRatio, 0, CLOCK_RATIOS_LEN - 1);
+		const int mul = CLOCK_RATIOS[ratio].mul, div = CLOCK_RATIOS[ratio].div;
+		stepTime += args.sampleTime;
+		subTimer += args.sampleTime;
+		bool tick = false;
+		float late = 0.f;
+		if (edge && divCount++ % div == 0) {
+			// Al multiplicar, una subdivisión que no llegó a sonar antes de este flanco
+			// (el tempo ha acelerado) se salta en silencio: así el paso sigue alineado con
+			// el compás del reloj maestro en vez de retrasarse para siempre. Si la vuelta
+			// cae en lo saltado, la cadena cambia de slot y EOC suena en este flanco.
+			if (clockStarted)
+				for (; subIndex > 0 && subIndex < mul; subIndex++)
+					advanceStep(len);
+			tick = true;
+			late = edgeLate;
+			subIndex = 1;
+			subTimer = edgeLate;
+		}
+		else if (subIndex > 0 && subIndex < mul) {
+			// Subdivisiones repartidas sobre el periodo suavizado, contadas desde el cruce
+			// del flanco: no se amontonan ni derivan entre flancos.
+			const float at = subIndex * tempo.period / mul;
+			if (subTimer >= at) {
+				tick = true;
+				late = subTimer - at;
+				subIndex++;
+			}
+		}
+		if (tick) {
 			if (!clockStarted) {
-				// Primer flanco: arranca en el paso 0 y no mide periodo, porque lo que
-				// llevaba contado es el tiempo desde que se cargó el módulo.
+				// Primer paso: arranca en el 0. El periodo lo lleva el tracker, que mide de
+				// flanco a flanco y no cuenta el tiempo desde que se cargó el módulo.
 				clockStarted = true;
 				step = 0;
+				eocPulse.trigger(1e-3f);
 			}
 			else {
-				if (stepTime > 1e-4f)
-					clockPeriod = clamp(stepTime, 0.002f, 4.f);
-				step = (step + 1) % len;
+				advanceStep(len);
+			}
+			// El paso empieza en el cruce del umbral, no al final de la muestra que lo vio.
+			stepTime = late;
+			const float period = clamp(tempo.period * div / mul, 0.002f, 4.f);
+			if (period != clockPeriod) {
+				clockPeriod = period;
+				retimeTable();
 			}
-			stepTime = 0.f;
-			if (step == 0)
-				eocPulse.trigger(1e-3f);
 		}
 		if (step >= len)
 			step = 0;
-		stepTime += args.sampleTime;
-
-		const int next = (step + 1) % len;
-		const bool active = clockStarted && gen.gate[step];
-		const bool nextActive = clockStarted && gen.gate[next];
-		const bool tieIn = active && gen.tie[step];
-		const bool tieOut = active && nextActive && gen.tie[next];
-		const int stepSemi = AcidGen::semiOf(gen.deg[step], gen.oct[step], scaleIdx());
-		const int nextSemi = AcidGen::semiOf(gen.deg[next], gen.oct[next], scaleIdx());
-		// PASOS puede cerrar el bucle antes del paso 16 y ESCALA puede colapsar dos grados.
-		// Se valida la transición que realmente va a sonar, no solo la que se generó.
-		const bool slide = active && gen.slide[step] && nextActive
-		                && !tieIn && !gen.tie[next] && stepSemi != nextSemi;
-
-		// Un tie real mantiene el gate desde su ataque hasta casi el final del último paso
-		// prolongado. Un slide, en cambio, solo cruza el cambio de paso si el usuario eligió
-		// la convención legato; en la convención corta cae antes y SLIDE mantiene viva la voz.
-		const bool legatoSlide = legatoTies && slide && nextActive && !gen.tie[next];
-		const float gap = std::max(0.0015f, 0.03f * clockPeriod);
-		const float normalHold = std::min(params[GATELEN_PARAM].getValue() * clockPeriod,
-		                                  clockPeriod - gap);
-		const float tiedHold = clockPeriod - gap;
-		const bool gate = active && ((tieOut || legatoSlide)
-		                         || stepTime < (tieIn ? tiedHold : normalHold));
+		if (chainPos >= clamp(chainLength, 1, CHAIN_SLOTS))
+			chainPos = chainRepeat = 0;
 
 		const bool voiceDoesSlide = rightExpander.module
 		                         && rightExpander.module->model == modelAtek303;
-		const float target = octaveBase
-		                   + (rootSemi() + stepSemi) / 12.f;
-		if (internalGlide && !voiceDoesSlide) {
-			// La constante va atada al paso, no en milisegundos fijos: así el slide ocupa
-			// la misma fracción de la nota a cualquier tempo, que es lo que lo hace sonar
-			// a 303 y no a portamento de sintetizador.
-			const float tau = clamp(0.45f * clockPeriod, 0.005f, 1.f);
-			const float a = 1.f - std::exp(-args.sampleTime / tau);
-			glideVoct += (prevSlide ? a : 1.f) * (target - glideVoct);
-		}
-		else {
-			glideVoct = target;
-		}
-		prevSlide = slide;
-
-		const bool accent = active && gen.accent[step];
-		// El acento como CV se mantiene todo el paso y da un nivel también a las notas sin
-		// acento: así otra voz lo puede leer de velocity con un S&H o directo a un VCA.
-		const float accentV = accentAsCV ? (active ? (accent ? accentLevel : accentBase) : 0.f)
-		                                 : (accent ? 10.f : 0.f);
-		outputs[VOCT_OUTPUT].setVoltage(glideVoct);
-		outputs[GATE_OUTPUT].setVoltage(gate ? 10.f : 0.f);
-		outputs[ACCENT_OUTPUT].setVoltage(accentV);
-		outputs[SLIDE_OUTPUT].setVoltage(slide ? 10.f : 0.f);
+		const bool glide = internalGlide && !voiceDoesSlide;
+		const int slot = clamp(chainSlot[chainPos], 0, CHAIN_SLOTS - 1);
+		// El último paso sale hacia el primero del slot que le sigue en la cadena.
+		const int nextSlot = step == len - 1 ? nextChainSlot() : slot;
+		const float* voctRow = table.voct[slot][step];
+		const uint8_t* holdRow = nextSlot != slot ? table.wrapHold[slot][nextSlot]
+		                                          : table.holdKind[slot][step];
+		const bool* gateRow = table.gate[slot][step];
+		const bool* accentRow = table.accent[slot][step];
+		const bool* slideRow = nextSlot != slot ? table.wrapSlide[slot][nextSlot]
+		                                        : table.slide[slot][step];
+		for (int c = 0; c < lanes; c++) {
+			// Antes del primer flanco no hay paso en curso: todo apagado salvo el V/Oct.
+			const bool active = clockStarted && gateRow[c];
+			const bool slide = clockStarted && slideRow[c];
+			const bool gate = clockStarted && stepTime < table.holdTime[holdRow[c] & 3];
+			const bool accent = clockStarted && accentRow[c];
+
+			const float target = voctRow[c];
+			if (glide)
+				glideVoct[c] += (prevSlide[c] ? glideCoef : 1.f) * (target - glideVoct[c]);
+			else
+				glideVoct[c] = target;
+			prevSlide[c] = slide;
+
+			// El acento como CV se mantiene todo el paso y da un nivel también a las notas sin
+			// acento: así otra voz lo puede leer de velocity con un S&H o directo a un VCA.
+			const float accentV = accentAsCV ? (active ? (accent ? accentLevel : accentBase) : 0.f)
+			                                 : (accent ? 10.f : 0.f);
+			outputs[VOCT_OUTPUT].setVoltage(glideVoct[c], c);
+			outputs[GATE_OUTPUT].setVoltage(gate ? 10.f : 0.f, c);
+			outputs[ACCENT_OUTPUT].setVoltage(accentV, c);
+			outputs[SLIDE_OUTPUT].setVoltage(slide ? 10.f : 0.f, c);
+		}
+		outputs[VOCT_OUTPUT].setChannels(lanes);
+		outputs[GATE_OUTPUT].setChannels(lanes);
+		outputs[ACCENT_OUTPUT].setChannels(lanes);
+		outputs[SLIDE_OUTPUT].setChannels(lanes);
 		outputs[EOC_OUTPUT].setVoltage(eocPulse.process(args.sampleTime) ? 10.f : 0.f);
 
-		if (rightExpander.module && rightExpander.module->model == modelAtek303) {
-			Module::Expander& dst = rightExpander.module->leftExpander;
-			if (dst.producerMessage) {
-				Atek303SeqMessage* m = (Atek303SeqMessage*) dst.producerMessage;
-				m->voct = glideVoct;
-				m->gate = gate;
-				m->accent = accent;
-				m->slide = slide;
-				dst.requestMessageFlip();
-			}
+		// El ATEK303 es una voz mono: recibe el carril 1.
+		ExpanderOutbox<Atek303SeqMessage> m(this, true, modelAtek303);
+		if (m) {
+			m->voct = glideVoct[0];
+			m->gate = clockStarted && stepTime < table.holdTime[holdRow[0] & 3];
+			m->accent = clockStarted && accentRow[0];
+			m->slide = clockStarted && slideRow[0];
+			m.send();
 		}
 
-		// Una fila de LEDs para ver el patrón, sin controles: apagado = silencio,
+		// Una fila de LEDs para ver el patrón en edición, sin controles: apagado = silencio,
 		// verde = ataque, azul = tie, ámbar = slide, rojo = acento; el paso en curso brilla.
-		for (int i = 0; i < MAX_STEPS; i++) {
+		// Si el slot en edición es el que suena, la fila sigue la página del paso en curso.
+		const AcidGen& gen = gens[lane][eslot];
+		const bool playing = slot == eslot;
+		const int page = playing ? step / LED_STEPS : 0;
+		for (int i = 0; i < LED_STEPS; i++) {
+			const int s = page * LED_STEPS + i;
 			float r = 0.f, g = 0.f, b = 0.f;
-			if (i < len && gen.gate[i]) {
-				if (gen.tie[i]) { r = 0.1f; g = 0.45f; b = 1.f; }
-				else if (gen.accent[i]) { r = 1.f; g = 0.15f; }
-				else if (gen.slide[i]) { r = 0.8f; g = 0.7f; }
+			if (s < len && gen.gate[s]) {
+				if (gen.tie[s]) { r = 0.1f; g = 0.45f; b = 1.f; }
+				else if (gen.accent[s]) { r = 1.f; g = 0.15f; }
+				else if (gen.slide[s]) { r = 0.8f; g = 0.7f; }
 				else { g = 0.8f; }
 			}
-			const float dim = (i == step) ? 1.f : 0.28f;
+			const bool current = playing && s == step;
+			const float dim = current ? 1.f : 0.28f;
 			lights[STEP_LIGHT + i * 3 + 0].setBrightness(r * dim);
 			lights[STEP_LIGHT + i * 3 + 1].setBrightness(g * dim);
-			lights[STEP_LIGHT + i * 3 + 2].setBrightness(b * dim + (i == step ? 0.25f : 0.f));
+			lights[STEP_LIGHT + i * 3 + 2].setBrightness(b * dim + (current ? 0.25f : 0.f));
 		}
 		lights[GENERATE_LIGHT].setBrightnessSmooth(
 			genPulse.process(args.sampleTime) ? 1.f : 0.f, args.sampleTime);
@@ -355,35 +626,54 @@ struct Atek303Seq : Module {
 			mutateArticulationPulse.process(args.sampleTime) ? 1.f : 0.f, args.sampleTime);
 	}
 
-	json_t* dataToJson() override {
-		json_t* rootJ = json_object();
-		// schemaVersion describe el JSON; algorithmVersion identifica el generador. No se
-		// vuelven a mezclar: una versión nueva puede leer un esquema viejo sin fingir que
-		// aquel patrón fue generado por el algoritmo actual.
-		json_object_set_new(rootJ, "schemaVersion", json_integer(AcidPatternV4::SCHEMA_VERSION));
-		json_object_set_new(rootJ, "patternVersion", json_integer(AcidPatternV4::SCHEMA_VERSION));
+	// Suena o se está editando: carril activo y slot en la cadena o en edición.
+	bool slotInUse(int lane, int slot) {
+		if (lane >= laneCount) return false;
+		if (slot == editSlot) return true;
+		for (int i = 0; i < clamp(chainLength, 1, CHAIN_SLOTS); i++)
+			if (chainSlot[i] == slot) return true;
+		return false;
+	}
+
+	// Su semilla y sus ajustes lo vuelven a dar tal cual: ni mutado ni alargado. Con un
+	// generador propio, porque el patch se guarda fuera del hilo de audio.
+	bool matchesSeed(int lane, int slot) {
+		AcidDualGenerator regen;
+		AcidPatternV4 fresh;
+		regen.generate(fresh, generatedWith[lane][slot], seeds[lane][slot]);
+		return AcidPatternMutator::same(fresh, patterns[lane][slot]);
+	}
+
+	// Las claves de un patrón (carril, slot). El carril 0, slot 0, las escribe en el primer
+	// nivel, como siempre; los demás slots van en "slots" y los demás carriles en "lanes".
+	// Una versión sin carriles ni cadenas carga ese patrón y no ve nada más.
+	//
+	// Un patrón que no suena y que su semilla vuelve a dar se guarda sin sus datos, con
+	// "fromSeed", y se regenera al cargar. El carril 0, slot 0, va siempre entero para que
+	// una versión anterior lo lea.
+	void slotToJson(int lane, int slot, json_t* rootJ) {
+		const AcidPatternV4& pattern = patterns[lane][slot];
+		const AcidGenParams& with = generatedWith[lane][slot];
 		json_object_set_new(rootJ, "algorithmVersion", json_integer(pattern.algorithmVersion));
-		json_object_set_new(rootJ, "seed", json_integer((json_int_t) patternSeed));
-		json_object_set_new(rootJ, "seedLocked",
-		                    json_boolean(params[SEED_LOCK_PARAM].getValue() > 0.5f));
-		json_object_set_new(rootJ, "mutationCounter", json_integer((json_int_t) mutationCounter));
-		json_object_set_new(rootJ, "legatoTies", json_boolean(legatoTies));
-		json_object_set_new(rootJ, "internalGlide", json_boolean(internalGlide));
-		json_object_set_new(rootJ, "octaveBase", json_integer(octaveBase));
-		json_object_set_new(rootJ, "accentAsCV", json_boolean(accentAsCV));
-		json_object_set_new(rootJ, "accentLevel", json_real(accentLevel));
-		json_object_set_new(rootJ, "accentBase", json_real(accentBase));
+		json_object_set_new(rootJ, "seed", json_integer((json_int_t) seeds[lane][slot]));
+		json_object_set_new(rootJ, "mutationCounter",
+		                    json_integer((json_int_t) mutationCounters[lane][slot]));
 
 		json_t* paramsJ = json_object();
-		json_object_set_new(paramsJ, "steps", json_integer(generatedWith.steps));
-		json_object_set_new(paramsJ, "scale", json_integer(generatedWith.scale));
-		json_object_set_new(paramsJ, "density", json_real(generatedWith.density));
-		json_object_set_new(paramsJ, "accent", json_real(generatedWith.accent));
-		json_object_set_new(paramsJ, "slide", json_real(generatedWith.slide));
-		json_object_set_new(paramsJ, "range", json_real(generatedWith.range));
-		json_object_set_new(paramsJ, "tie", json_real(generatedWith.tie));
+		json_object_set_new(paramsJ, "steps", json_integer(with.steps));
+		json_object_set_new(paramsJ, "scale", json_integer(with.scale));
+		json_object_set_new(paramsJ, "density", json_real(with.density));
+		json_object_set_new(paramsJ, "accent", json_real(with.accent));
+		json_object_set_new(paramsJ, "slide", json_real(with.slide));
+		json_object_set_new(paramsJ, "range", json_real(with.range));
+		json_object_set_new(paramsJ, "tie", json_real(with.tie));
 		json_object_set_new(rootJ, "generatedWith", paramsJ);
 
+		if ((lane || slot) && !slotInUse(lane, slot) && matchesSeed(lane, slot)) {
+			json_object_set_new(rootJ, "fromSeed", json_true());
+			return;
+		}
+
 		json_object_set_new(rootJ, "timeLength", json_integer(pattern.timeLength));
 		json_t* timeJ = json_array();
 		for (int i = 0; i < pattern.timeLength; i++)
@@ -401,11 +691,72 @@ struct Atek303Seq : Module {
 			json_array_append_new(pitchJ, p);
 		}
 		json_object_set_new(rootJ, "pitchData", pitchJ);
+	}
 
-		// Copia renderizada para downgrade y diagnóstico. v4 siempre carga timeData/pitchData;
-		// una versión v3 puede seguir leyendo "pattern" sin saber nada del modelo dual.
+	// Slot 0 en el propio objeto, slots 1..7 en su "slots". Están todos aunque la cadena no
+	// los use, al menos con su semilla: quitar una entrada y volver a ponerla no debe
+	// perder el patrón.
+	void laneToJson(int lane, json_t* rootJ) {
+		slotToJson(lane, 0, rootJ);
+		json_t* slotsJ = json_array();
+		for (int k = 1; k < CHAIN_SLOTS; k++) {
+			json_t* slotJ = json_object();
+			slotToJson(lane, k, slotJ);
+			json_array_append_new(slotsJ, slotJ);
+		}
+		json_object_set_new(rootJ, "slots", slotsJ);
+	}
+
+	json_t* dataToJson() override {
+		json_t* rootJ = json_object();
+		// schemaVersion describe el JSON; algorithmVersion identifica el generador. No se
+		// vuelven a mezclar: una versión nueva puede leer un esquema viejo sin fingir que
+		// aquel patrón fue generado por el algoritmo actual.
+		json_object_set_new(rootJ, "schemaVersion", json_integer(AcidPatternV4::SCHEMA_VERSION));
+		json_object_set_new(rootJ, "patternVersion", json_integer(AcidPatternV4::SCHEMA_VERSION));
+		json_object_set_new(rootJ, "seedLocked",
+		                    json_boolean(params[SEED_LOCK_PARAM].getValue() > 0.5f));
+		json_object_set_new(rootJ, "legatoTies", json_boolean(legatoTies));
+		json_object_set_new(rootJ, "internalGlide", json_boolean(internalGlide));
+		json_object_set_new(rootJ, "octaveBase", json_integer(octaveBase));
+		json_object_set_new(rootJ, "accentAsCV", json_boolean(accentAsCV));
+		json_object_set_new(rootJ, "accentLevel", json_real(accentLevel));
+		json_object_set_new(rootJ, "accentBase", json_real(accentBase));
+		json_object_set_new(rootJ, "clockRatio", json_integer(clockRatio));
+		json_object_set_new(rootJ, "laneCount", json_integer(laneCount));
+		json_object_set_new(rootJ, "editLane", json_integer(editLane));
+		json_object_set_new(rootJ, "editSlot", json_integer(editSlot));
+		json_object_set_new(rootJ, "patternLength", json_integer(patternLength));
+
+		// La cadena, como [slot, repeticiones] por entrada. La posición de reproducción no
+		// se guarda: al cargar se empieza por el principio, como tras un reset.
+		json_t* chainJ = json_array();
+		for (int i = 0; i < clamp(chainLength, 1, CHAIN_SLOTS); i++) {
+			json_t* entryJ = json_array();
+			json_array_append_new(entryJ, json_integer(chainSlot[i]));
+			json_array_append_new(entryJ, json_integer(chainRepeats[i]));
+			json_array_append_new(chainJ, entryJ);
+		}
+		json_object_set_new(rootJ, "chain", chainJ);
+
+		laneToJson(0, rootJ);
+		// Van los dieciséis aunque suenen menos, los que no suenan casi siempre solo con sus
+		// semillas: bajar y volver a subir el número de carriles no debe perder las líneas
+		// que había.
+		json_t* lanesJ = json_array();
+		for (int c = 1; c < MAX_LANES; c++) {
+			json_t* laneJ = json_object();
+			laneToJson(c, laneJ);
+			json_array_append_new(lanesJ, laneJ);
+		}
+		json_object_set_new(rootJ, "lanes", lanesJ);
+
+		// Copia renderizada del carril 0, slot 0, para downgrade y diagnóstico. v4 siempre
+		// carga timeData/pitchData; una versión v3 puede seguir leyendo "pattern" sin saber
+		// nada del modelo dual. Solo lleva el primer compás: v3 no conoce más.
+		const AcidGen& gen = gens[0][0];
 		json_t* pat = json_array();
-		for (int i = 0; i < MAX_STEPS; i++) {
+		for (int i = 0; i < ACID_BASE_STEPS; i++) {
 			json_t* st = json_object();
 			json_object_set_new(st, "d", json_integer(gen.deg[i]));
 			json_object_set_new(st, "o", json_integer(gen.oct[i]));
@@ -418,17 +769,78 @@ struct Atek303Seq : Module {
 		json_object_set_new(rootJ, "pattern", pat);
 		return rootJ;
 	}
+
+	// Devuelve false si el objeto no trae un patrón dual v4.
+	bool slotFromJson(int lane, int slot, json_t* rootJ) {
+		uint32_t seed = seeds[lane][slot];
+		if (json_t* j = json_object_get(rootJ, "seed"))
+			seed = (uint32_t) json_integer_value(j);
+		seeds[lane][slot] = seed ? seed : 1u;
+		if (json_t* j = json_object_get(rootJ, "mutationCounter"))
+			mutationCounters[lane][slot] = (uint32_t) json_integer_value(j);
+
+		AcidGenParams& with = generatedWith[lane][slot];
+		with = currentGenerationParams();
+		if (json_t* p = json_object_get(rootJ, "generatedWith")) {
+			if (json_t* v = json_object_get(p, "steps")) with.steps = (int) json_integer_value(v);
+			if (json_t* v = json_object_get(p, "scale")) with.scale = (int) json_integer_value(v);
+			if (json_t* v = json_object_get(p, "density")) with.density = json_number_value(v);
+			if (json_t* v = json_object_get(p, "accent")) with.accent = json_number_value(v);
+			if (json_t* v = json_object_get(p, "slide")) with.slide = json_number_value(v);
+			if (json_t* v = json_object_get(p, "range")) with.range = json_number_value(v);
+			if (json_t* v = json_object_get(p, "tie")) with.tie = json_number_value(v);
+		}
+
+		if (json_is_true(json_object_get(rootJ, "fromSeed"))) {
+			generator.generate(patterns[lane][slot], with, seeds[lane][slot]);
+			renderPattern(lane, slot);
+			return true;
+		}
+
+		json_t* timeJ = json_object_get(rootJ, "timeData");
+		json_t* pitchJ = json_object_get(rootJ, "pitchData");
+		if (!json_is_array(timeJ) || !json_is_array(pitchJ))
+			return false;
+		AcidPatternV4& pattern = patterns[lane][slot];
+		pattern.clear();
+		pattern.seed = seeds[lane][slot];
+		if (json_t* j = json_object_get(rootJ, "algorithmVersion"))
+			pattern.algorithmVersion = (uint8_t) json_integer_value(j);
+		if (json_t* j = json_object_get(rootJ, "timeLength"))
+			pattern.timeLength = (uint8_t) json_integer_value(j);
+		const int timeCount = std::min(ACID_MAX_STEPS, (int) json_array_size(timeJ));
+		for (int i = 0; i < timeCount; i++)
+			pattern.time[i] = (AcidTimeState) json_integer_value(json_array_get(timeJ, i));
+		if (json_t* j = json_object_get(rootJ, "pitchLength"))
+			pattern.pitchLength = (uint8_t) json_integer_value(j);
+		const int pitchCount = std::min(ACID_MAX_STEPS, (int) json_array_size(pitchJ));
+		for (int i = 0; i < pitchCount; i++) {
+			json_t* p = json_array_get(pitchJ, i);
+			if (json_t* v = json_object_get(p, "d")) pattern.pitch[i].degree = (int8_t) json_integer_value(v);
+			if (json_t* v = json_object_get(p, "o")) pattern.pitch[i].octave = (int8_t) json_integer_value(v);
+			if (json_t* v = json_object_get(p, "a")) pattern.pitch[i].accent = json_boolean_value(v);
+			if (json_t* v = json_object_get(p, "s")) pattern.pitch[i].slideOut = json_boolean_value(v);
+		}
+		pattern.sanitize(scaleIdx());
+		renderPattern(lane, slot);
+		return true;
+	}
+
+	bool laneFromJson(int lane, json_t* rootJ) {
+		json_t* slotsJ = json_object_get(rootJ, "slots");
+		for (int k = 1; k < CHAIN_SLOTS && json_is_array(slotsJ) && k - 1 < (int) json_array_size(slotsJ); k++)
+			slotFromJson(lane, k, json_array_get(slotsJ, k - 1));
+		return slotFromJson(lane, 0, rootJ);
+	}
+
 	void dataFromJson(json_t* rootJ) override {
 		seedLocked = params[SEED_LOCK_PARAM].getValue() > 0.5f;
-		if (json_t* j = json_object_get(rootJ, "seed"))
-			patternSeed = (uint32_t) json_integer_value(j);
-		if (!patternSeed) patternSeed = 1u;
+		// El historial de undo vive solo en memoria: un patch cargado empieza sin él.
+		history.clear();
 		if (json_t* j = json_object_get(rootJ, "seedLocked")) {
 			seedLocked = json_boolean_value(j);
 			params[SEED_LOCK_PARAM].setValue(seedLocked ? 1.f : 0.f);
 		}
-		if (json_t* j = json_object_get(rootJ, "mutationCounter"))
-			mutationCounter = (uint32_t) json_integer_value(j);
 		if (json_t* j = json_object_get(rootJ, "legatoTies"))
 			legatoTies = json_boolean_value(j);
 		if (json_t* j = json_object_get(rootJ, "internalGlide"))
@@ -441,50 +853,56 @@ struct Atek303Seq : Module {
 			accentLevel = json_number_value(j);
 		if (json_t* j = json_object_get(rootJ, "accentBase"))
 			accentBase = json_number_value(j);
-
-		generatedWith = currentGenerationParams();
-		if (json_t* p = json_object_get(rootJ, "generatedWith")) {
-			if (json_t* v = json_object_get(p, "steps")) generatedWith.steps = (int) json_integer_value(v);
-			if (json_t* v = json_object_get(p, "scale")) generatedWith.scale = (int) json_integer_value(v);
-			if (json_t* v = json_object_get(p, "density")) generatedWith.density = json_number_value(v);
-			if (json_t* v = json_object_get(p, "accent")) generatedWith.accent = json_number_value(v);
-			if (json_t* v = json_object_get(p, "slide")) generatedWith.slide = json_number_value(v);
-			if (json_t* v = json_object_get(p, "range")) generatedWith.range = json_number_value(v);
-			if (json_t* v = json_object_get(p, "tie")) generatedWith.tie = json_number_value(v);
+		clockRatio = 3;
+		if (json_t* j = json_object_get(rootJ, "clockRatio"))
+			clockRatio = clamp((int) json_integer_value(j), 0, CLOCK_RATIOS_LEN - 1);
+		// Patches anteriores a los carriles: uno solo, el de siempre.
+		laneCount = 1;
+		editLane = 0;
+		if (json_t* j = json_object_get(rootJ, "laneCount"))
+			laneCount = clamp((int) json_integer_value(j), 1, MAX_LANES);
+		if (json_t* j = json_object_get(rootJ, "editLane"))
+			editLane = clamp((int) json_integer_value(j), 0, laneCount - 1);
+		// Patches anteriores a las cadenas (v4 y antes): slot 1 en bucle, compases de 16.
+		editSlot = 0;
+		patternLength = ACID_BASE_STEPS;
+		chainLength = 1;
+		chainSlot[0] = 0;
+		chainRepeats[0] = 1;
+		chainPos = chainRepeat = 0;
+		if (json_t* j = json_object_get(rootJ, "editSlot"))
+			editSlot = clamp((int) json_integer_value(j), 0, CHAIN_SLOTS - 1);
+		if (json_t* j = json_object_get(rootJ, "patternLength")) {
+			const int len = (int) json_integer_value(j);
+			patternLength = (len == 32 || len == 64) ? len : ACID_BASE_STEPS;
 		}
-
-		json_t* timeJ = json_object_get(rootJ, "timeData");
-		json_t* pitchJ = json_object_get(rootJ, "pitchData");
-		if (json_is_array(timeJ) && json_is_array(pitchJ)) {
-			pattern.clear();
-			pattern.seed = patternSeed;
-			if (json_t* j = json_object_get(rootJ, "algorithmVersion"))
-				pattern.algorithmVersion = (uint8_t) json_integer_value(j);
-			if (json_t* j = json_object_get(rootJ, "timeLength"))
-				pattern.timeLength = (uint8_t) json_integer_value(j);
-			const int timeCount = std::min(ACID_MAX_STEPS, (int) json_array_size(timeJ));
-			for (int i = 0; i < timeCount; i++)
-				pattern.time[i] = (AcidTimeState) json_integer_value(json_array_get(timeJ, i));
-			if (json_t* j = json_object_get(rootJ, "pitchLength"))
-				pattern.pitchLength = (uint8_t) json_integer_value(j);
-			const int pitchCount = std::min(ACID_MAX_STEPS, (int) json_array_size(pitchJ));
-			for (int i = 0; i < pitchCount; i++) {
-				json_t* p = json_array_get(pitchJ, i);
-				if (json_t* v = json_object_get(p, "d")) pattern.pitch[i].degree = (int8_t) json_integer_value(v);
-				if (json_t* v = json_object_get(p, "o")) pattern.pitch[i].octave = (int8_t) json_integer_value(v);
-				if (json_t* v = json_object_get(p, "a")) pattern.pitch[i].accent = json_boolean_value(v);
-				if (json_t* v = json_object_get(p, "s")) pattern.pitch[i].slideOut = json_boolean_value(v);
+		// Los patrones cargan con su longitud aunque STEPS sea mayor.
+		stepsSeen = length();
+		json_t* chainJ = json_object_get(rootJ, "chain");
+		if (json_is_array(chainJ) && json_array_size(chainJ) > 0) {
+			chainLength = std::min((int) json_array_size(chainJ), CHAIN_SLOTS);
+			for (int i = 0; i < chainLength; i++) {
+				json_t* entryJ = json_array_get(chainJ, i);
+				chainSlot[i] = clamp((int) json_integer_value(json_array_get(entryJ, 0)),
+				                     0, CHAIN_SLOTS - 1);
+				chainRepeats[i] = clamp((int) json_integer_value(json_array_get(entryJ, 1)),
+				                        1, MAX_REPEATS);
 			}
-			pattern.sanitize(scaleIdx());
-			renderPattern();
-			return;
 		}
 
+		json_t* lanesJ = json_object_get(rootJ, "lanes");
+		for (int c = 1; c < MAX_LANES && json_is_array(lanesJ) && c - 1 < (int) json_array_size(lanesJ); c++)
+			laneFromJson(c, json_array_get(lanesJ, c - 1));
+
+		if (laneFromJson(0, rootJ))
+			return;
+
 		if (json_t* pat = json_object_get(rootJ, "pattern")) {
 			// En la versión anterior no existía "t". Se limpia primero para que un patrón
 			// guardado no herede por accidente los ties del patrón generado en el constructor.
-			for (int i = 0; i < MAX_STEPS; i++) gen.tie[i] = false;
-			for (int i = 0; i < MAX_STEPS && i < (int) json_array_size(pat); i++) {
+			AcidGen& gen = gens[0][0];
+			for (int i = 0; i < ACID_BASE_STEPS; i++) gen.tie[i] = false;
+			for (int i = 0; i < ACID_BASE_STEPS && i < (int) json_array_size(pat); i++) {
 				json_t* st = json_array_get(pat, i);
 				// "d" es el grado dentro de la octava y "o" la octava; los patches
 				// anteriores guardaban "n" en semitonos y no se pueden reinterpretar,
@@ -499,7 +917,7 @@ struct Atek303Seq : Module {
 			// Sanea JSON editado a mano y mantiene una representación inequívoca: un tie
 			// continúa exactamente la altura anterior, sin acento ni slide alrededor.
 			gen.tie[0] = false;
-			for (int i = 1; i < MAX_STEPS; i++) {
+			for (int i = 1; i < ACID_BASE_STEPS; i++) {
 				if (!gen.tie[i]) continue;
 				if (!gen.gate[i - 1] || !gen.gate[i]) {
 					gen.tie[i] = false;
@@ -511,13 +929,28 @@ struct Atek303Seq : Module {
 				gen.slide[i - 1] = false;
 				gen.slide[i] = false;
 			}
-			pattern.importRendered(gen, MAX_STEPS, patternSeed, 3);
-			pattern.sanitize(scaleIdx());
-			renderPattern();
+			patterns[0][0].importRendered(gen, ACID_BASE_STEPS, seeds[0][0], 3);
+			patterns[0][0].sanitize(scaleIdx());
+			renderPattern(0, 0);
 		}
 	}
 };
 
+std::string SeqStepsQuantity::getDisplayValueString() {
+	Atek303Seq* m = dynamic_cast<Atek303Seq*>(module);
+	return m ? string::f("%d", m->length()) : ParamQuantity::getDisplayValueString();
+}
+
+void SeqStepsQuantity::setDisplayValueString(std::string s) {
+	Atek303Seq* m = dynamic_cast<Atek303Seq*>(module);
+	if (!m) {
+		ParamQuantity::setDisplayValueString(s);
+		return;
+	}
+	const float steps = std::atof(s.c_str());
+	setValue(clamp(std::round(steps / m->stepsScale()), 1.f, 16.f));
+}
+
 // Un knob de doce posiciones sin nada escrito no dice en qué nota está. Los valores de
 // RAIZ y ESCALA se pintan debajo de su knob.
 struct SeqReadout : Widget {
@@ -557,7 +990,7 @@ struct Atek303SeqWidget : ModuleWidget {
 	static constexpr float IO_SEC_Y = 96.5f;   // rótulos ENTRADAS / SALIDAS
 	static constexpr float IO_LABEL_Y = 100.5f;
 	static constexpr float IO_JACK_Y = 110.0f;
-	static constexpr float IO_SPLIT_X = 42.5f; // separador vertical entre los dos bloques
+	static constexpr float IO_SPLIT_X = 50.8f; // separador vertical entre los dos bloques
 
 	Atek303SeqWidget(Atek303Seq* module) {
 		setModule(module);
@@ -582,8 +1015,8 @@ struct Atek303SeqWidget : ModuleWidget {
 		addChild(new GroupBox("", mm2px(Vec(5.f, 19.f)), mm2px(Vec(W - 10.f, 8.f))));
 		{
 			const float x0 = 9.5f, x1 = W - 9.5f;
-			for (int i = 0; i < MAX_STEPS; i++) {
-				const float x = x0 + (x1 - x0) * i / (float)(MAX_STEPS - 1);
+			for (int i = 0; i < LED_STEPS; i++) {
+				const float x = x0 + (x1 - x0) * i / (float)(LED_STEPS - 1);
 				addChild(createLightCentered<SmallLight<RedGreenBlueLight>>(
 					mm2px(Vec(x, STEPS_Y)), module, Atek303Seq::STEP_LIGHT + i * 3));
 			}
@@ -666,19 +1099,22 @@ struct Atek303SeqWidget : ModuleWidget {
 			addChild(sep);
 		}
 
+		// Cinco y cinco, a paso de 9,16 mm: UNDO y REDO entraron sin cambiar el ancho.
 		struct Jack { const char* name; int id; float x; bool output; };
-		static const Jack JACKS[8] = {
-			{"CLOCK",  Atek303Seq::CLOCK_INPUT,   11.5f, false},
-			{"RESET",  Atek303Seq::RESET_INPUT,   22.5f, false},
-			{"GEN",    Atek303Seq::GEN_INPUT,     33.5f, false},
-			{"EOC",    Atek303Seq::EOC_OUTPUT,    51.0f, true},
-			{"V/OCT",  Atek303Seq::VOCT_OUTPUT,   62.0f, true},
-			{"GATE",   Atek303Seq::GATE_OUTPUT,   73.0f, true},
-			{"ACCENT", Atek303Seq::ACCENT_OUTPUT, 84.0f, true},
-			{"SLIDE",  Atek303Seq::SLIDE_OUTPUT,  95.0f, true},
+		static const Jack JACKS[10] = {
+			{"CLOCK",  Atek303Seq::CLOCK_INPUT,    9.6f, false},
+			{"RESET",  Atek303Seq::RESET_INPUT,   18.7f, false},
+			{"GEN",    Atek303Seq::GEN_INPUT,     27.9f, false},
+			{"UNDO",   Atek303Seq::UNDO_INPUT,    37.1f, false},
+			{"REDO",   Atek303Seq::REDO_INPUT,    46.2f, false},
+			{"EOC",    Atek303Seq::EOC_OUTPUT,    55.4f, true},
+			{"V/OCT",  Atek303Seq::VOCT_OUTPUT,   64.5f, true},
+			{"GATE",   Atek303Seq::GATE_OUTPUT,   73.7f, true},
+			{"ACCENT", Atek303Seq::ACCENT_OUTPUT, 82.9f, true},
+			{"SLIDE",  Atek303Seq::SLIDE_OUTPUT,  92.0f, true},
 		};
 		for (const Jack& j : JACKS) {
-			label(j.name, j.x, IO_LABEL_Y, 11.f, 6.5f);
+			label(j.name, j.x, IO_LABEL_Y, 9.f, 6.f);
 			if (j.output)
 				addOutput(createOutputCentered<AnimatekUI::TekOutputPort>(
 					mm2px(Vec(j.x, IO_JACK_Y)), module, j.id));
@@ -691,9 +1127,67 @@ struct Atek303SeqWidget : ModuleWidget {
 	void appendContextMenu(Menu* menu) override {
 		Atek303Seq* module = getModule<Atek303Seq>();
 		menu->addChild(new MenuSeparator);
-		menu->addChild(createMenuLabel(string::f("Pattern v%d · seed %08X",
-		                                     module->pattern.algorithmVersion,
-		                                     module->patternSeed)));
+		const int lane = clamp(module->editLane, 0, MAX_LANES - 1);
+		const int slot = clamp(module->editSlot, 0, CHAIN_SLOTS - 1);
+		menu->addChild(createMenuLabel(string::f("Lane %d · slot %d · pattern v%d · seed %08X",
+		                                     lane + 1, slot + 1,
+		                                     module->patterns[lane][slot].algorithmVersion,
+		                                     module->seeds[lane][slot])));
+		{
+			std::vector<std::string> counts;
+			for (int i = 1; i <= MAX_LANES; i++) counts.push_back(string::f("%d", i));
+			menu->addChild(createIndexSubmenuItem("Lanes (poly channels)", counts,
+				[=]() { return module->laneCount - 1; },
+				[=](int i) {
+					module->laneCount = i + 1;
+					module->editLane = std::min(module->editLane, i);
+				}));
+			std::vector<std::string> lanes;
+			for (int i = 1; i <= module->laneCount; i++) lanes.push_back(string::f("Lane %d", i));
+			menu->addChild(createIndexSubmenuItem("Edit lane (panel, LEDs, GEN)", lanes,
+				[=]() { return module->editLane; },
+				[=](int i) { module->editLane = i; }));
+			menu->addChild(createMenuItem("Generate all lanes (new seeds)", "", [=]() {
+				module->pendingPatternAction.store(Atek303Seq::GENERATE_ALL_LANES);
+			}));
+		}
+		{
+			std::vector<std::string> slots;
+			for (int i = 1; i <= CHAIN_SLOTS; i++) slots.push_back(string::f("Slot %d", i));
+			menu->addChild(createIndexSubmenuItem("Edit slot (panel, LEDs, GEN)", slots,
+				[=]() { return module->editSlot; },
+				[=](int i) { module->editSlot = i; }));
+			// Cambia la longitud de lo que genera GENERATE y cuántos pasos vale cada posición
+			// de STEPS; los patrones más cortos crecen repitiendo su bucle (growPatterns).
+			static const int LENGTHS[3] = {16, 32, 64};
+			menu->addChild(createIndexSubmenuItem("Pattern length",
+				{"16 steps", "32 steps", "64 steps"},
+				[=]() {
+					for (int i = 0; i < 3; i++)
+						if (module->patternLength == LENGTHS[i]) return i;
+					return 0;
+				},
+				[=](int i) { module->patternLength = LENGTHS[i]; }));
+			menu->addChild(createSubmenuItem("Chain", string::f("%d entries", module->chainLength),
+				[=](Menu* sub) {
+					std::vector<std::string> entries;
+					for (int i = 1; i <= CHAIN_SLOTS; i++) entries.push_back(string::f("%d", i));
+					sub->addChild(createIndexSubmenuItem("Chain length", entries,
+						[=]() { return module->chainLength - 1; },
+						[=](int i) { module->chainLength = i + 1; }));
+					std::vector<std::string> repeats;
+					for (int i = 1; i <= MAX_REPEATS; i++) repeats.push_back(string::f("×%d", i));
+					for (int e = 0; e < module->chainLength; e++) {
+						sub->addChild(new MenuSeparator);
+						sub->addChild(createIndexSubmenuItem(string::f("Entry %d: slot", e + 1), slots,
+							[=]() { return module->chainSlot[e]; },
+							[=](int i) { module->chainSlot[e] = i; }));
+						sub->addChild(createIndexSubmenuItem(string::f("Entry %d: repeats", e + 1), repeats,
+							[=]() { return module->chainRepeats[e] - 1; },
+							[=](int i) { module->chainRepeats[e] = i + 1; }));
+					}
+				}));
+		}
 		menu->addChild(createCheckMenuItem("Lock seed", "",
 			[=]() { return module->params[Atek303Seq::SEED_LOCK_PARAM].getValue() > 0.5f; },
 			[=]() {
@@ -710,15 +1204,27 @@ struct Atek303SeqWidget : ModuleWidget {
 		menu->addChild(createMenuItem("Mutate accents / slides (3 operations)", "", [=]() {
 			module->pendingPatternAction.store(Atek303Seq::MUTATE_ARTICULATION);
 		}));
-		menu->addChild(createMenuItem("Undo last mutation", "", [=]() {
+		menu->addChild(createMenuItem("Undo mutation",
+			string::f("%d left", module->history.undoCount()), [=]() {
 			module->pendingPatternAction.store(Atek303Seq::UNDO_MUTATION);
-		}, !module->hasUndo));
+		}, !module->history.canUndo()));
+		menu->addChild(createMenuItem("Redo mutation",
+			string::f("%d left", module->history.redoCount()), [=]() {
+			module->pendingPatternAction.store(Atek303Seq::REDO_MUTATION);
+		}, !module->history.canRedo()));
 		menu->addChild(new MenuSeparator);
 		menu->addChild(createBoolPtrMenuItem("Gate held through slides (legato)", "",
 		                                     &module->legatoTies));
 		menu->addChild(createBoolPtrMenuItem(
 			"Own glide on the V/Oct output (disables itself when ATEK303 is attached)", "",
 			&module->internalGlide));
+		{
+			std::vector<std::string> ratios;
+			for (int i = 0; i < CLOCK_RATIOS_LEN; i++) ratios.push_back(CLOCK_RATIOS[i].name);
+			menu->addChild(createIndexSubmenuItem("Clock ratio", ratios,
+				[=]() { return module->clockRatio; },
+				[=](int i) { module->clockRatio = i; }));
+		}
 		menu->addChild(createIndexSubmenuItem("Base octave",
 			{"C1 (-3)", "C2 (-2)", "C3 (-1)", "C4 (0)", "C5 (+1)"},
 			[=]() { return clamp(module->octaveBase + 3, 0, 4); },
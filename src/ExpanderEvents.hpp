@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+
+// Trigger log carried inside expander messages (see ExpanderLink.hpp). Plain
+// C++ with no Rack dependency, so tools/expander_events.cpp can check it.
+
+// One trigger, stamped with the sender's frame (ProcessArgs::frame).
+struct ExpanderEvent {
+    int64_t frame = 0;
+    uint8_t type = 0;
+    uint8_t arg = 0;
+};
+
+// The last CAP events a sender fired, plus how many it has fired in total.
+template <int CAP> struct ExpanderEvents {
+    static_assert(CAP >= 2 && (CAP & (CAP - 1)) == 0,
+                  "ExpanderEvents capacity must be a power of two");
+
+    uint32_t written = 0;
+    ExpanderEvent ring[CAP];
+
+    void push(int type, int64_t frame, int arg = 0) {
+        ExpanderEvent& e = ring[written & (CAP - 1)];
+        e.frame = frame;
+        e.type = (uint8_t)type;
+        e.arg = (uint8_t)arg;
+        ++written;
+    }
+};
+
+// Receiver's position in a sender's event log. The first log seen after
+// linking is adopted without running anything, so plugging a module in never
+// replays old triggers; unlink() when the sender goes away.
+struct ExpanderEventReader {
+    uint32_t read = 0;
+    uint32_t lost = 0; // events overwritten before they were read
+    bool linked = false;
+
+    void unlink() { linked = false; }
+
+    template <int CAP, typename F>
+    void drain(const ExpanderEvents<CAP>& log, F&& fn) {
+        if (!linked) {
+            read = log.written;
+            linked = true;
+            return;
+        }
+        const uint32_t pending = log.written - read;
+        if (pending > (uint32_t)CAP) {
+            lost += pending - CAP;
+            read = log.written - CAP;
+        }
+        for (; read != log.written; ++read)
+            fn(log.ring[read & (CAP - 1)]);
+    }
+};
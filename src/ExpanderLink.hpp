@@ -0,0 +1,69 @@
+#pragma once
+#include <rack.hpp>
+
+#include "ExpanderEvents.hpp"
+
+using namespace rack;
+
+// Expander transport shared by every module pair in the plugin.
+//
+// Messages are double-buffered the way Rack intends. The receiver owns both
+// buffers of the side it listens on (ExpanderInbox::attach() in its
+// constructor) and nobody else ever touches those pointers. The sender fills
+// the neighbour's producer buffer completely and requests a flip
+// (ExpanderOutbox). Rack swaps the buffers once every module has processed the
+// frame, so whatever the engine order or thread, the receiver reads in frame
+// n + 1 exactly what the sender wrote in frame n: never a half-written
+// message, and a fixed latency.
+//
+// Latency per link:
+//   UZZ-X -> UZZ                     1 sample
+//   ONE (OxiCv) -> MULTI (OxiCvExp)  1 sample
+//   ATEK303 SEQ -> ATEK303           1 sample
+//   UZZ chain, playhead and gates    1 sample per module from the leader
+//   UZZ chain, step rows             1 sample plus up to one control period
+//                                    (32 samples) per module
+//
+// Triggers travel as ExpanderEvents (ExpanderEvents.hpp): the sender keeps a
+// log of the last CAP events with a running total and copies it into every
+// message; the receiver runs each event it has not seen yet, in order, with
+// ExpanderEventReader. A burst of triggers between two reads is replayed in
+// full rather than collapsed into one.
+
+// Receiver side: the two buffers of one expander side.
+template <typename T> struct ExpanderInbox {
+    T buf[2];
+
+    void attach(Module::Expander& side) {
+        side.producerMessage = &buf[0];
+        side.consumerMessage = &buf[1];
+    }
+
+    // What a `model` neighbour on `side` sent last frame, or nullptr when the
+    // neighbour is missing or another model.
+    static const T* read(const Module::Expander& side, Model* model) {
+        if (!side.module || side.module->model != model)
+            return nullptr;
+        return (const T*)side.consumerMessage;
+    }
+};
+
+// Sender side: the producer buffer of the neighbour on this module's right
+// (toRight) or left, if it is a `model`. Fill *msg, then send().
+template <typename T> struct ExpanderOutbox {
+    Module::Expander* facing = nullptr;
+    T* msg = nullptr;
+
+    ExpanderOutbox(Module* self, bool toRight, Model* model) {
+        Module* n = toRight ? self->rightExpander.module
+                            : self->leftExpander.module;
+        if (!n || n->model != model)
+            return;
+        facing = toRight ? &n->leftExpander : &n->rightExpander;
+        msg = (T*)facing->producerMessage;
+    }
+
+    explicit operator bool() const { return msg != nullptr; }
+    T* operator->() const { return msg; }
+    void send() { facing->requestMessageFlip(); }
+};
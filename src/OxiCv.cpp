@@ -224,7 +224,6 @@ struct OxiCv : Module {
 
     float pitchBend = 0.f;       // current bend expressed in V/Oct
     float midiLightLevel = 0.f;  // MIDI activity LED (decays each frame)
-    OxiCvExpMsg expanderMsg;     // for right expander
 
     // -------------------------------------------------------------------------
     OxiCv() {
@@ -435,10 +434,11 @@ struct OxiCv : Module {
         lights[MIDI_LIGHT].setBrightness(midiLightLevel);
 
         // ── Expander ──────────────────────────────────────────────────────────
-        if (rightExpander.module && rightExpander.module->model == modelOxiCvExp) {
-            memcpy(expanderMsg.channels, allChannels, sizeof(allChannels));
-            expanderMsg.pitchBend = pitchBend;
-            rightExpander.module->leftExpander.consumerMessage = &expanderMsg;
+        ExpanderOutbox<OxiCvExpMsg> exp(this, true, modelOxiCvExp);
+        if (exp) {
+            memcpy(exp->channels, allChannels, sizeof(allChannels));
+            exp->pitchBend = pitchBend;
+            exp.send();
         }
     }
 
@@ -30,8 +30,11 @@ struct OxiCvExp : Module {
     };
     enum LightIds  { NUM_LIGHTS };
 
+    ExpanderInbox<OxiCvExpMsg> inbox;  // written by ONE on the left
+
     OxiCvExp() {
         config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
+        inbox.attach(leftExpander);
         for (int i = 0; i < NUM_TRACKS; i++) {
             configParam(CH_PARAM + i, 1.f, (float)MIDI_CHANNELS, (float)(i + 1),
                         string::f("Track %d Channel", i + 1));
@@ -43,9 +46,8 @@ struct OxiCvExp : Module {
     }
 
     void process(const ProcessArgs& args) override {
-        OxiCvExpMsg* msg = (OxiCvExpMsg*)leftExpander.consumerMessage;
-        if (leftExpander.module && leftExpander.module->model != modelOxiCv)
-            msg = nullptr;
+        const OxiCvExpMsg* msg =
+            ExpanderInbox<OxiCvExpMsg>::read(leftExpander, modelOxiCv);
 
         for (int i = 0; i < NUM_TRACKS; i++) {
             int chIdx = clamp((int)params[CH_PARAM + i].getValue() - 1, 0, MIDI_CHANNELS - 1);
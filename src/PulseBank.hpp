@@ -0,0 +1,76 @@
+#pragma once
+#include <rack.hpp>
+
+using namespace rack;
+
+// Pulse generators for the channels of one poly gate/trigger output.
+//
+// Same timing as one dsp::PulseGenerator per channel, but the remaining times
+// sit in float_4 lanes and a bitmask says which channels still have time
+// left, so a sample where no pulse is running costs one test, and one where a
+// few are costs a vector subtract per group of four. The result is a bitmask
+// too; writePolyGates() turns it into voltages four channels per store.
+// tools/pulse_bank.cpp checks the timing against PulseGenerator.
+
+// 10 V in the lanes whose bit is set, for every 4-bit pattern.
+static const float POLY_GATE_LANES[16][4] = {
+    {0.f, 0.f, 0.f, 0.f},     {10.f, 0.f, 0.f, 0.f},
+    {0.f, 10.f, 0.f, 0.f},    {10.f, 10.f, 0.f, 0.f},
+    {0.f, 0.f, 10.f, 0.f},    {10.f, 0.f, 10.f, 0.f},
+    {0.f, 10.f, 10.f, 0.f},   {10.f, 10.f, 10.f, 0.f},
+    {0.f, 0.f, 0.f, 10.f},    {10.f, 0.f, 0.f, 10.f},
+    {0.f, 10.f, 0.f, 10.f},   {10.f, 10.f, 0.f, 10.f},
+    {0.f, 0.f, 10.f, 10.f},   {10.f, 0.f, 10.f, 10.f},
+    {0.f, 10.f, 10.f, 10.f},  {10.f, 10.f, 10.f, 10.f},
+};
+
+#ifndef RACK_HEADLESS
+// Channels 0..channels-1 of `out`: 10 V where bit ch of `high` is set, else
+// 0 V. Writes whole groups of four; lanes past `channels` are left to Rack,
+// which ignores them.
+inline void writePolyGates(engine::Output& out, uint32_t high, int channels) {
+    for (int c = 0; c < channels; c += 4)
+        out.setVoltageSimd(simd::float_4::load(POLY_GATE_LANES[(high >> c) & 0xF]), c);
+}
+#endif
+
+template <int N> struct PulseBank {
+    static_assert(N > 0 && N <= 16, "PulseBank drives one poly output");
+    static constexpr int GROUPS = (N + 3) / 4;
+
+    simd::float_4 remaining[GROUPS];
+    uint32_t active = 0; // bit ch: channel ch has time left
+
+    PulseBank() { reset(); }
+
+    void reset() {
+        for (int g = 0; g < GROUPS; ++g)
+            remaining[g] = 0.f;
+        active = 0;
+    }
+
+    // Like PulseGenerator::trigger(): extends a running pulse, never cuts it.
+    void trigger(int ch, float duration) {
+        float& r = remaining[ch >> 2].s[ch & 3];
+        if (duration > r)
+            r = duration;
+        if (r > 0.f)
+            active |= 1u << ch;
+    }
+
+    // Advances every running pulse by dt. Returns the channels that are high
+    // this sample (the ones that had time left on entry, as with
+    // PulseGenerator::process()).
+    uint32_t process(float dt) {
+        const uint32_t high = active;
+        for (int g = 0; g < GROUPS; ++g) {
+            const int shift = 4 * g;
+            if (!((active >> shift) & 0xF))
+                continue;
+            remaining[g] = simd::fmax(remaining[g] - dt, 0.f);
+            const uint32_t left = (uint32_t)simd::movemask(remaining[g] > 0.f);
+            active = (active & ~(0xFu << shift)) | (left << shift);
+        }
+        return high;
+    }
+};
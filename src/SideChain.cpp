@@ -1,4 +1,5 @@
 #include "plugin.hpp"
+#include "PulseBank.hpp"
 #include "ui/CommonWidgets.hpp"
 
 #include <algorithm>
@@ -97,11 +98,11 @@ struct SideChain : Module {
         float walkRecovery = 0.f;
         float walkDepth = 0.f;
         float walkCurve = 0.f;
-        dsp::PulseGenerator eocPulse;
         random::Xoroshiro128Plus rng;
     };
 
     Voice voices[16];
+    PulseBank<16> eocPulses;
     int curveShape = CURVE_EXPONENTIAL;
     bool freezeJitter = false;
     uint64_t baseSeed = 0x5C1DECA1ULL;
@@ -192,6 +193,7 @@ struct SideChain : Module {
             voices[c].level = 1.f;
             voices[c].phase = 0.f;
         }
+        eocPulses.reset();
         reseedVoices(baseSeed);
     }
 
@@ -277,7 +279,7 @@ struct SideChain : Module {
                         // cycle. A retrigger cuts it short and fires nothing,
                         // otherwise EOC would degrade into a copy of TRIG at
                         // fast tempos.
-                        v.eocPulse.trigger(1e-3f);
+                        eocPulses.trigger(c, 1e-3f);
                     }
                     else {
                         v.level = v.floorLevel +
@@ -291,10 +293,10 @@ struct SideChain : Module {
             }
 
             outputs[ENV_OUTPUT].setVoltage(10.f * v.level * envScale, c);
-            // EOC is a trigger, never attenuated: a half-height trigger is
-            // just a trigger some modules miss.
-            outputs[EOC_OUTPUT].setVoltage(v.eocPulse.process(args.sampleTime) ? 10.f : 0.f, c);
         }
+        // EOC is a trigger, never attenuated: a half-height trigger is just a
+        // trigger some modules miss.
+        writePolyGates(outputs[EOC_OUTPUT], eocPulses.process(args.sampleTime), channels);
 
         outputs[ENV_OUTPUT].setChannels(channels);
         outputs[EOC_OUTPUT].setChannels(channels);
@@ -1,10 +1,22 @@
 #include "plugin.hpp"
+#include "PulseBank.hpp"
 #include "ui/CommonWidgets.hpp"
-#include "uzz/ClockProcessor.hpp"
-#include "uzz/StepNavigator.hpp"
+#include "uzz/CommandQueue.hpp"
+#include "uzz/UzzChain.hpp"
+#include "uzz/UzzChord.hpp"
+#include "uzz/UzzCond.hpp"
+#include "uzz/UzzEngine.hpp"
+#include "uzz/UzzGroove.hpp"
 #include "uzz/UzzLayout.hpp"
+#include "uzz/UzzQuantities.hpp"
+#include "uzz/UzzRandom.hpp"
+#include "uzz/UzzScan.hpp"
+#include "uzz/UzzSnapshots.hpp"
+#include "uzz/UzzTracks.hpp"
 #include "uzz/UzzTypes.hpp"
 
+#include <osdialog.h>
+
 using AnimatekUI::ConnectorLine;
 using AnimatekUI::DisplayBox;
 using AnimatekUI::drawScaled;
@@ -74,6 +86,10 @@ struct UZZ : Module {
     RND_M2_TRIG_INPUT,
     XPOSE_INPUT,
     RND_PROB_TRIG_INPUT,
+    // Appended: CV record
+    REC_INPUT,
+    REC_PITCH_INPUT,
+    REC_MOD_INPUT,
     NUM_INPUTS
   };
 
@@ -99,20 +115,114 @@ struct UZZ : Module {
     NUM_LIGHTS
   };
 
-  // State
-  int step = 0;
-  float pitchOut = 0.f;
-  bool pitchInit = false;
+  // State. The sequencing itself (clock, tracks, gates, compiled step tables)
+  // lives in engine; the step data of every track except the one on the panel
+  // lives in bank.
+  UzzEngine engine;
+  UzzTrackBank bank;
+  int editTrack = 0;
+
+  // Everything the context menu and the panel widgets change goes through
+  // this queue and is applied at the top of process(), so the audio thread
+  // never sees a row, the bank or the engine settings half written.
+  enum CommandType {
+    CMD_EDIT_TRACK,
+    CMD_TRACK_COUNT,
+    CMD_RESET_ROW, // arg: StepRow
+    CMD_DIRECTION,
+    CMD_JUMP_STRIDE,
+    CMD_PITCH_RANGE,
+    CMD_EOC_ON_RESET, // arg: 0/1
+    CMD_PHASE_LOCK,   // arg: 0/1
+    CMD_M1_RANGE,
+    CMD_M2_RANGE,
+    CMD_SNAP_STORE,
+    CMD_SNAP_RECALL,
+    CMD_SNAP_CLEAR,
+    CMD_MORPH_TARGET,
+    CMD_RESEED_ON_RESET, // arg: 0/1
+    CMD_RESTART_SEED,
+    CMD_NEW_SEED,
+    CMD_CHAIN_FOLLOW, // arg: 0/1
+    CMD_SCALE,        // arg: index in UZZ_SCALES
+    CMD_SCALE_ROOT,   // arg: 0..11, 0 = C
+    CMD_GROOVE,       // arg: index in UZZ_GROOVES
+    CMD_MICRO,        // arg: step << 8 | (percent + 50), edit track
+    CMD_MICRO_CLEAR,  // edit track
+    CMD_REC_MODE,     // arg: RecMode
+    CMD_CHORD,        // arg: step << 8 | index in UZZ_CHORDS, edit track
+    CMD_CHORD_CLEAR,  // edit track
+    CMD_LATENCY,      // arg: 0/1, attach the probe (cleared)
+    CMD_LATENCY_CLEAR,
+    CMD_COND,         // arg: step << 8 | condition index, edit track
+    CMD_COND_CLEAR    // edit track
+  };
+  struct Command {
+    uint8_t type = 0;
+    int16_t arg = 0;
+  };
+  CommandQueue<Command, 64> commands;
+
+  void post(int type, int arg = 0) {
+    Command c;
+    c.type = (uint8_t)type;
+    c.arg = (int16_t)arg;
+    commands.push(c);
+  }
+
+  // The engine reads only its compiled step tables (engine.snap);
+  // refreshSnapshot() compares the rows against the copy each table was built
+  // from at control rate (paramDivider) and recompiles the steps that changed.
+  // Edits made on the audio thread set snapDirty so the next tick sees them.
+  bool snapDirty = true;
+  int snapTracks = 0;
+  int snapM1Range = -1;
+  int snapM2Range = -1;
+  float snapMorph = -1.f;
+  int snapMorphSlot = -1;
+  dsp::ClockDivider paramDivider;
+
+  // Pattern snapshots. Store copies every track into a slot right away;
+  // recall compiles the slot into the engine's staged tables, which the engine
+  // swaps in on the next step, and the panel and bank follow once it has.
+  // MORPH blends PITCH, DUR, MOD1 and MOD2 toward morphSlot inside the
+  // compiled tables only.
+  UzzSnapshot snapshots[UZZ_NUM_SNAPSHOTS];
+  int snapshotSlot = 0; // slot RCL / STO use while SLOT has no cable
+  int morphSlot = 1;
+  float morphAmt = 0.f; // 0..1, read at control rate
+
+  // Random streams: rng feeds the randomize banks, the engine's tracks draw
+  // from the following streams of the same seed. The seed is picked per
+  // instance and saved with the patch; a patched SEED CV overrides it in
+  // 10 mV steps, and any change of the active seed restarts every stream.
+  UzzRng rng;
+  uint64_t seed = 0;
+  bool reseedOnReset = false;
+  bool seedFromCv = false;
+  int seedCvStep = 0;
+
+  // Panel knobs outside the step rows, read at control rate. Expander CV is
+  // still added per sample.
+  struct Knobs {
+    int steps = 16;
+    int start = 0; // 0-based
+    int ratioIdx = RATIO_DEFAULT_INDEX;
+    int modeDir = 0;
+    int gateMode = 0;
+    int accumAmt = 1;
+    int accumWrap = 0;
+    float swing = 0.f;
+    float slew = 0.f;
+    float pGlobal = 1.f;
+  } knobs;
 
   // Cached slew coefficients — recomputed only when slewSec / sampleTime change
   float cachedSlewSec = -1.f;
   float cachedSampleTime = -1.f;
   float cachedSlewAlpha = 1.f;
 
-  ClockProcessor clock;
-  StepNavigator navigator;
   dsp::SchmittTrigger rstTrig;
-  dsp::PulseGenerator gatePulse, eocPulse, stepGateTrig[16];
   dsp::ClockDivider lightDivider;
 
   dsp::BooleanTrigger rndBtnTrig[NUM_RND_BANKS];
@@ -121,70 +231,69 @@ struct UZZ : Module {
       shiftDownTrig[NUM_SHIFT_ROWS];
   bool skipNextRandom[NUM_RND_BANKS] = {};
 
-  bool playCurrentOnNextTick = false;
-  bool resetPending = false;
-  int resetTargetStep = 0;
-  bool eocOnReset = false;
-
-  int accumOffset[16] = {};
-
   // UZZ-X expander (left) state
-  bool xLinked = false;
-  uint32_t xLastAccumRst = 0;
-  uint32_t xLastRotFwd = 0;
-  uint32_t xLastRotBack = 0;
+  ExpanderEventReader xEvents;
+  UzzAddrScan addrScan;
   // Effective window (knob + expander CV), refreshed every frame in process()
   int effSteps = 16;
   int effStart = 0;
 
-  // Pulse mode
-  enum PulseMode { PM_PULSE = 0, PM_GATED = 1, PM_HOLD = 2 };
-  int pulseMode = PM_PULSE;
-
-  // Ratchet sub-pulse state (PM_RATCHET)
-  int pulsesRemaining = 0;
-  float pulseTimer = 0.f;
-  float pulseInterval = 0.f;
-  float pulseGLen = 0.f;
-  int pulseStepK = 0;
-
-  // Hold state (PM_HOLD)
-  int holdPulsesLeft = 0;
-  bool holdPlaying = false;
+  // Chaining with neighbouring UZZs (see UzzChain.hpp). chainFollow is the
+  // menu option; chainIndex is this module's place in a chain this sample
+  // (0: leads or plays alone) and chainModules how many modules it leads.
+  bool chainFollow = false;
+  int chainIndex = 0;
+  int chainModules = 1;
+  int chainSlots = 16;
+  UzzChainDown chainDown; // sent to the UZZ on the right every sample
+  // Snapshot recalls across the chain. recallSeq counts the recalls a leader
+  // has sent, or the last one a follower took; recallHold keeps the leader on
+  // its recalled follower slots until the followers echo it.
+  uint32_t recallSeq = 0;
+  bool recallHold = false;
+  UzzChainRecall chainRecall;
+
+  // Expander buffers (ExpanderLink.hpp): UZZ-X or a chain leader writes from
+  // the left, a chain follower from the right.
+  ExpanderInbox<UzzLeftMsg> leftInbox;
+  ExpanderInbox<UzzChainUp> rightInbox;
 
   int m1Range = UZZRanges::MR_0_10;
   int m2Range = UZZRanges::MR_0_10;
   int pitchRangeSemis = 11; // 11 = 1 octave, 23 = 2 octaves
-  int jumpN = 2;
+
+  // Timing: the groove template and each track's micro-timing lane, in
+  // percent of a step (-50..50). Handed to the engine by pushTiming().
+  int groove = 0;
+  int8_t micro[UZZ_MAX_TRACKS][16] = {};
+
+  // CV record: while REC is high, PITCH and MOD are written into the edit
+  // track's current step, once as the track lands on it (REC_ON_STEP) or at
+  // control rate for as long as it stays there (REC_CONTINUOUS).
+  enum RecMode { REC_ON_STEP, REC_CONTINUOUS };
+  int recMode = REC_ON_STEP;
+
+  // Chord of every step of every track (index in UZZ_CHORDS), compiled into
+  // the step tables. chordsOn: some step has one, so V/OCT and GATE carry
+  // chord voices.
+  int8_t chord[UZZ_MAX_TRACKS][16] = {};
+  bool chordsOn = false;
+
+  // Trig condition of every step of every track (index from UzzCond.hpp).
+  // Handed to the engine by pushConditions().
+  int8_t cond[UZZ_MAX_TRACKS][16] = {};
+
+  // Latency probe ("Latency probe" menu). Attached to the engine only while
+  // enabled; not saved with the patch.
+  UzzLatencyProbe latency;
 
   float capiFlash = 0.f;
   dsp::SchmittTrigger capiTrig;
 
-  float getGateLength(int gateMode, float duty, float period, float sampleTime,
-                      float maxWindow = 0.f) const {
-    if (gateMode != 0)
-      return TRIG_LEN;
-
-    float window = (maxWindow > 0.f) ? maxWindow : period;
-    if (window <= 0.f)
-      return TRIG_LEN;
-
-    float minOff = std::max(0.001f, 2.f * sampleTime);
-    float gLen = window * clamp(duty, 0.01f, 0.95f);
-    float maxLen = std::max(TRIG_LEN, window - minOff);
-    if (gLen > maxLen)
-      gLen = maxLen;
-    // Hard upper bound: a single step gate should never exceed 2 s, regardless
-    // of what the clock period reports. Guards against pathological state
-    // (stale period, paused upstream clock) producing a stuck gate.
-    if (gLen > 2.f)
-      gLen = 2.f;
-    return gLen;
-  }
-
   UZZ() {
     config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
     lightDivider.setDivision(512);
+    paramDivider.setDivision(32);
 
     for (int i = 0; i < 16; ++i) {
       configParam(PITCH_PARAMS + i, 0.f, 11.f, 0.f,
@@ -271,6 +380,9 @@ struct UZZ : Module {
     configInput(RND_M2_TRIG_INPUT, "Randomize mod2 (trig)");
     configInput(RND_PROB_TRIG_INPUT, "Randomize probability (trig)");
     configInput(XPOSE_INPUT, "Transpose (1V/oct)");
+    configInput(REC_INPUT, "Record (gate)");
+    configInput(REC_PITCH_INPUT, "Record pitch (1V/oct)");
+    configInput(REC_MOD_INPUT, "Record mod 1 (0-10V)");
 
     configOutput(PITCH_OUTPUT, "Pitch (1V/oct)");
     configOutput(GATE_OUTPUT, "Gate/Trig");
@@ -278,36 +390,193 @@ struct UZZ : Module {
     configOutput(EOC_OUTPUT, "End of cycle");
     configOutput(M1_OUTPUT, "Mod 1");
     configOutput(M2_OUTPUT, "Mod 2");
+
+    leftInbox.attach(leftExpander);
+    rightInbox.attach(rightExpander);
+
+    seed = random::u64();
+    reseed();
+  }
+
+  uint64_t activeSeed() const {
+    return seedFromCv ? 0x9E3779B97F4A7C15ULL * (uint64_t)(seedCvStep + 1001)
+                      : seed;
+  }
+
+  void reseed() {
+    const uint64_t s = activeSeed();
+    rng.seed(s, 0);
+    engine.reseed(s);
   }
 
   void onReset() override {
     int start =
         clamp((int)std::round(params[START_PARAM].getValue()) - 1, 0, 15);
-    step = start;
 
-    gatePulse.reset();
-    eocPulse.reset();
-    for (int i = 0; i < 16; ++i)
-      stepGateTrig[i].reset();
     for (int i = 0; i < 16; ++i)
       lights[STEP_LIGHTS + i].setBrightness(0.f);
 
-    clock.reset();
-    navigator.reset();
+    engine.reset(start);
+    bank.reset();
+    editTrack = 0;
+    snapDirty = true;
+
+    for (int s = 0; s < UZZ_NUM_SNAPSHOTS; ++s)
+      snapshots[s].used = false;
+    snapshotSlot = 0;
+    morphSlot = 1;
+    reseed();
+    groove = 0;
+    for (int t = 0; t < UZZ_MAX_TRACKS; ++t)
+      for (int i = 0; i < 16; ++i)
+        micro[t][i] = 0;
+    pushTiming();
+    for (int t = 0; t < UZZ_MAX_TRACKS; ++t)
+      for (int i = 0; i < 16; ++i)
+        chord[t][i] = 0;
+    chordsChanged();
+    for (int t = 0; t < UZZ_MAX_TRACKS; ++t)
+      for (int i = 0; i < 16; ++i)
+        cond[t][i] = 0;
+    pushConditions();
+  }
 
-    pitchOut = 0.f;
-    pitchInit = false;
+  void pushTiming() {
+    for (int i = 0; i < 16; ++i)
+      engine.grooveFrac[i] = UZZ_GROOVES[groove].offset[i];
+    for (int t = 0; t < UZZ_MAX_TRACKS; ++t)
+      for (int i = 0; i < 16; ++i)
+        engine.microFrac[t][i] = (float)micro[t][i] / 100.f;
+    engine.timingChanged();
+  }
 
-    playCurrentOnNextTick = false;
-    resetPending = false;
-    resetTargetStep = start;
+  void pushConditions() {
+    for (int t = 0; t < UZZ_MAX_TRACKS; ++t)
+      for (int i = 0; i < 16; ++i)
+        engine.cond[t][i] = cond[t][i];
+    engine.conditionsChanged();
+  }
 
-    for (int i = 0; i < 16; ++i)
-      accumOffset[i] = 0;
+  // Recompiles every track with the current chords.
+  void chordsChanged() {
+    chordsOn = false;
+    for (int t = 0; t < UZZ_MAX_TRACKS; ++t) {
+      for (int i = 0; i < 16; ++i)
+        chordsOn = chordsOn || chord[t][i] != 0;
+      engine.snap[t].valid = false;
+    }
+    snapDirty = true;
+  }
+
+  // Param base of each StepRow on the panel.
+  static int rowParam(int row) {
+    static const int bases[NUM_STEP_ROWS] = {
+        PITCH_PARAMS, OCT_PARAMS, STEP_MODE_PARAMS, DUR_PARAMS,
+        M1_PARAMS,    M2_PARAMS,  PROB_PARAMS};
+    return bases[row];
+  }
+
+  // Step data of any track: the panel params for the edit track, the bank for
+  // the others.
+  float stepValue(int t, int row, int i) {
+    return (t == editTrack) ? params[rowParam(row) + i].getValue()
+                            : bank.value[row][t][i];
+  }
+  // Slots 16 and up, while leading a chain, come from the followers; with
+  // the follower gone, or a recall not yet on their panels, they keep what
+  // was last compiled.
+  float slotValue(int t, int row, int i) {
+    if (i < 16)
+      return stepValue(t, row, i);
+    const UzzChainUp *up =
+        ExpanderInbox<UzzChainUp>::read(rightExpander, modelUZZ);
+    return up && !recallHold ? up->rows[(i >> 4) - 1][t][row][i & 15]
+                             : engine.snap[t].raw[row][i];
+  }
+  void setStepValue(int t, int row, int i, float v) {
+    if (t == editTrack)
+      params[rowParam(row) + i].setValue(v);
+    else
+      bank.value[row][t][i] = v;
+  }
 
-    pulsesRemaining = 0;
-    holdPulsesLeft = 0;
-    holdPlaying = false;
+  void selectEditTrack(int t) {
+    t = clamp(t, 0, UZZ_MAX_TRACKS - 1);
+    if (t == editTrack)
+      return;
+    for (int r = 0; r < NUM_STEP_ROWS; ++r)
+      for (int i = 0; i < 16; ++i)
+        bank.value[r][editTrack][i] = params[rowParam(r) + i].getValue();
+    editTrack = t;
+    for (int r = 0; r < NUM_STEP_ROWS; ++r)
+      for (int i = 0; i < 16; ++i)
+        params[rowParam(r) + i].setValue(bank.value[r][t][i]);
+    snapDirty = true;
+  }
+
+  void readKnobs() {
+    knobs.steps = clamp((int)std::round(params[STEPS_PARAM].getValue()), 1, 16);
+    knobs.start =
+        clamp((int)std::round(params[START_PARAM].getValue()) - 1, 0, 15);
+    knobs.ratioIdx = clamp((int)std::round(params[RATIO_IDX_PARAM].getValue()),
+                           0, NUM_RATIOS - 1);
+    knobs.modeDir = clamp((int)std::round(params[DIR_MODE_PARAM].getValue()),
+                          DIR_MODE_MIN, DIR_MODE_MAX);
+    knobs.gateMode = (int)std::round(params[GATE_MODE_PARAM].getValue());
+    knobs.accumAmt =
+        clamp((int)std::round(params[ACCUM_AMT_PARAM].getValue()), 0, 24);
+    knobs.accumWrap = (int)std::round(params[ACCUM_CLIP_PARAM].getValue());
+    knobs.swing = params[SWING_PARAM].getValue();
+    knobs.slew = params[SLEW_PARAM].getValue();
+    knobs.pGlobal =
+        clamp(params[PROB_GLOBAL_PARAM].getValue(), 0.f, 100.f) / 100.f;
+  }
+
+  // Compiles step i of track t from s.raw, blended toward the morph target
+  // over the slots it holds.
+  void compileStep(UzzTrackSnap &s, int t, int i) {
+    float b[NUM_STEP_ROWS];
+    const bool morph =
+        snapMorph > 0.f && snapshots[morphSlot].target(t, i, b);
+    compileStepSnap(s, i, morph ? b : nullptr, snapMorph, m1Range, m2Range,
+                    i < 16 ? chord[t][i] : 0);
+  }
+
+  // Brings the compiled table of every playing track up to date with the
+  // panel, the bank and, when leading a chain, the followers' rows. Tracks
+  // that are not playing are caught up when the track count grows, since that
+  // also triggers a refresh.
+  void refreshSnapshot() {
+    float morph = snapshots[morphSlot].used ? morphAmt : 0.f;
+    if (m1Range != snapM1Range || m2Range != snapM2Range ||
+        morph != snapMorph || (morph > 0.f && morphSlot != snapMorphSlot)) {
+      snapM1Range = m1Range;
+      snapM2Range = m2Range;
+      snapMorph = morph;
+      snapMorphSlot = morphSlot;
+      for (int t = 0; t < UZZ_MAX_TRACKS; ++t) {
+        engine.snap[t].valid = false;
+        engine.staged[t].valid = false;
+      }
+    }
+    for (int t = 0; t < engine.trackCount; ++t) {
+      UzzTrackSnap &s = engine.snap[t];
+      for (int i = 0; i < chainSlots; ++i) {
+        bool changed = !s.valid;
+        for (int r = 0; r < NUM_STEP_ROWS; ++r) {
+          float v = slotValue(t, r, i);
+          if (v != s.raw[r][i]) {
+            s.raw[r][i] = v;
+            changed = true;
+          }
+        }
+        if (changed)
+          compileStep(s, t, i);
+      }
+      s.valid = true;
+    }
+    snapTracks = engine.trackCount;
+    snapDirty = false;
   }
 
   void setPitchRange(int maxSemis, bool scaleValues = true) {
@@ -323,79 +592,174 @@ struct UZZ : Module {
         params[PITCH_PARAMS + i].setValue(scaled);
       }
     }
+    // Tracks off the panel keep their notes in the same place on the range.
+    if (scaleValues && newMax != oldMax && oldMax > 0) {
+      for (int t = 0; t < UZZ_MAX_TRACKS; ++t) {
+        if (t == editTrack)
+          continue;
+        for (int i = 0; i < 16; ++i) {
+          float &v = bank.value[ROW_PITCH][t][i];
+          v = clamp(std::round(v * (float)newMax / (float)oldMax), 0.f,
+                    (float)newMax);
+        }
+      }
+    }
   }
 
+  // Writes one step of the edit track and recompiles it if it changed, so an
+  // edit made on the audio thread reaches the engine without a
+  // refreshSnapshot() rescan of every track.
+  void writeEditStep(int row, int i, float v) {
+    params[rowParam(row) + i].setValue(v);
+    UzzTrackSnap &s = engine.snap[editTrack];
+    if (s.valid && s.raw[row][i] != v) {
+      s.raw[row][i] = v;
+      compileStep(s, editTrack, i);
+    }
+  }
+  // Randomizing, shifting or resetting a row compiles the edit track with the
+  // new row into engine.staged and swaps it in at once; the panel then takes
+  // the row in one pass, which refreshSnapshot() finds already compiled.
+  // Behind a pending recall the row goes into the recalled pattern instead.
+  void writeEditRow(int row, const float v[16]) {
+    const int t = editTrack;
+    const bool recall = engine.stagedPending;
+    if (recall || engine.snap[t].valid) {
+      if (!recall)
+        for (int u = 0; u < UZZ_MAX_TRACKS; ++u) {
+          // Tracks not playing are rebuilt when the track count grows.
+          if (u < engine.trackCount)
+            engine.staged[u] = engine.snap[u];
+          else
+            engine.staged[u].valid = false;
+        }
+      UzzTrackSnap &s = engine.staged[t];
+      for (int i = 0; s.valid && i < 16; ++i)
+        if (s.raw[row][i] != v[i]) {
+          s.raw[row][i] = v[i];
+          compileStep(s, t, i);
+        }
+      if (!recall)
+        engine.commitEdit();
+    }
+    for (int i = 0; i < 16; ++i)
+      params[rowParam(row) + i].setValue(v[i]);
+  }
+
+  // Writes REC PITCH and MOD into the edit track's current step while REC is
+  // high. `landed`: the track moved to that step this sample. Pitch is rounded
+  // to the semitone (and to the scale, when one is set) and split into PITCH
+  // and OCT within their ranges. Slots of chain followers are left alone.
+  void recordCv(bool landed, bool control) {
+    if (inputs[REC_INPUT].getVoltage() < 1.f)
+      return;
+    if (!(recMode == REC_CONTINUOUS ? control : landed))
+      return;
+    const int i = engine.tracks[editTrack].step;
+    if (i >= 16)
+      return;
+    if (inputs[REC_PITCH_INPUT].isConnected()) {
+      const float v = inputs[REC_PITCH_INPUT].getVoltage();
+      if (std::isfinite(v)) {
+        int oct, pitch;
+        uzzRecordNote(v, pitchRangeSemis, engine.scale, oct, pitch);
+        writeEditStep(ROW_OCT, i, (float)oct);
+        writeEditStep(ROW_PITCH, i, (float)pitch);
+      }
+    }
+    if (inputs[REC_MOD_INPUT].isConnected()) {
+      const float v = inputs[REC_MOD_INPUT].getVoltage();
+      if (std::isfinite(v))
+        writeEditStep(ROW_M1, i, clamp(v, 0.f, 10.f));
+    }
+  }
+
+  // The randomizers draw a whole row of uniforms from rng in one go and map
+  // them with straight-line loops the compiler can vectorize.
   void randomizePitch() {
+    float v[16];
+    rng.fill(v, 16);
+    const float span = (float)(pitchRangeSemis + 1);
     for (int i = 0; i < 16; ++i)
-      params[PITCH_PARAMS + i].setValue(
-          (int)std::floor(random::uniform() * (pitchRangeSemis + 1)));
+      v[i] = std::floor(v[i] * span);
+    writeEditRow(ROW_PITCH, v);
   }
   void randomizeOctaves() {
+    float v[16];
+    rng.fill(v, 16);
     for (int i = 0; i < 16; ++i)
-      params[OCT_PARAMS + i].setValue((int)std::floor(random::uniform() * 5.f) -
-                                      2);
+      v[i] = std::floor(v[i] * 5.f) - 2.f;
+    writeEditRow(ROW_OCT, v);
   }
   void randomizeStepMode() {
+    // Cumulative odds in StepMode order: PLAY 55%, MUTE 15%, SKIP 12%,
+    // ACCUM UP 6%, ACCUM DOWN 5%, PULSE 3%, GATED 2%, HOLD 2%. The mode is
+    // the number of thresholds the draw reaches.
+    static const float odds[SM_HOLD] = {0.55f, 0.70f, 0.82f, 0.88f,
+                                        0.93f, 0.96f, 0.98f};
+    float u[16], v[16];
+    rng.fill(u, 16);
     for (int i = 0; i < 16; ++i) {
-      float r = random::uniform();
-      int m;
-      if (r < 0.55f)
-        m = SM_PLAY;
-      else if (r < 0.70f)
-        m = SM_MUTE;
-      else if (r < 0.82f)
-        m = SM_SKIP;
-      else if (r < 0.88f)
-        m = SM_ACCUM_UP;
-      else if (r < 0.93f)
-        m = SM_ACCUM_DOWN;
-      else if (r < 0.96f)
-        m = SM_PULSE;
-      else if (r < 0.98f)
-        m = SM_GATED;
-      else
-        m = SM_HOLD;
-      params[STEP_MODE_PARAMS + i].setValue((float)m);
+      int m = 0;
+      for (int k = 0; k < SM_HOLD; ++k)
+        m += (u[i] >= odds[k]);
+      v[i] = (float)m;
     }
+    writeEditRow(ROW_MODE, v);
   }
 
-  void fillRow(int base, float value) {
+  // Row reset buttons (double-click) run on the UI thread: they only post the
+  // command, and resetRow() does the work in process().
+  void resetRow(int row) {
+    float v[16];
+    const float def = paramQuantities[rowParam(row)]->getDefaultValue();
     for (int i = 0; i < 16; ++i)
-      params[base + i].setValue(value);
+      v[i] = def;
+    writeEditRow(row, v);
   }
 
-  void resetPitchRow() { fillRow(PITCH_PARAMS, 0.f); }
-  void resetOctaveRow() { fillRow(OCT_PARAMS, 0.f); }
-  void resetStepModeRow() { fillRow(STEP_MODE_PARAMS, 0.f); }
-  void resetDurRow() { fillRow(DUR_PARAMS, 0.50f); }
-  void resetM1Row() { fillRow(M1_PARAMS, 0.f); }
-  void resetM2Row() { fillRow(M2_PARAMS, 0.f); }
-  void resetProbRow() { fillRow(PROB_PARAMS, 0.f); }
+  void resetPitchRow() { post(CMD_RESET_ROW, ROW_PITCH); }
+  void resetOctaveRow() { post(CMD_RESET_ROW, ROW_OCT); }
+  void resetStepModeRow() { post(CMD_RESET_ROW, ROW_MODE); }
+  void resetDurRow() { post(CMD_RESET_ROW, ROW_DUR); }
+  void resetM1Row() { post(CMD_RESET_ROW, ROW_M1); }
+  void resetM2Row() { post(CMD_RESET_ROW, ROW_M2); }
+  void resetProbRow() { post(CMD_RESET_ROW, ROW_PROB); }
 
   void randomizeDurations() {
+    float v[16];
+    rng.fill(v, 16);
     for (int i = 0; i < 16; ++i)
-      params[DUR_PARAMS + i].setValue(0.10f + random::uniform() * 0.80f);
+      v[i] = 0.10f + v[i] * 0.80f;
+    writeEditRow(ROW_DUR, v);
   }
   void randomizeM1() {
+    float v[16];
+    rng.fill(v, 16);
     for (int i = 0; i < 16; ++i)
-      params[M1_PARAMS + i].setValue(random::uniform() * 10.f);
+      v[i] *= 10.f;
+    writeEditRow(ROW_M1, v);
   }
   void randomizeM2() {
+    float v[16];
+    rng.fill(v, 16);
     for (int i = 0; i < 16; ++i)
-      params[M2_PARAMS + i].setValue(random::uniform() * 10.f);
+      v[i] *= 10.f;
+    writeEditRow(ROW_M2, v);
   }
   void randomizeProb() {
+    float u[16], w[16], v[16];
+    rng.fill(u, 16);
+    rng.fill(w, 16);
     for (int i = 0; i < 16; ++i) {
-      float r = random::uniform();
-      int v;
-      if (r < 0.65f)
-        v = -(int)std::floor(random::uniform() * 101.f); // prob 0–100%
-      else if (r < 0.75f)
-        v = 0; // default (100%/×1)
+      if (u[i] < 0.65f)
+        v[i] = (float)-(int)std::floor(w[i] * 101.f); // prob 0–100%
+      else if (u[i] < 0.75f)
+        v[i] = 0.f; // default (100%/×1)
       else
-        v = 1 + (int)std::floor(random::uniform() * 7.f); // pulse ×2–×8
-      params[PROB_PARAMS + i].setValue((float)v);
+        v[i] = 1.f + std::floor(w[i] * 7.f); // pulse ×2–×8
     }
+    writeEditRow(ROW_PROB, v);
   }
 
   static float quantize_to_step(float value, float min_val, float step) {
@@ -405,98 +769,161 @@ struct UZZ : Module {
     return min_val + steps_from_min * step;
   }
 
-  void get_active_window(int &start_idx, int &count) {
-    // Effective window including any UZZ-X expander CV offsets.
-    count = effSteps;
-    start_idx = effStart;
+  // This module's own steps inside the effective window (knob + expander CV
+  // offsets), in window order. A follower's window is its whole panel.
+  int get_active_window(int *slot) {
+    if (chainIndex > 0) {
+      for (int i = 0; i < 16; ++i)
+        slot[i] = i;
+      return 16;
+    }
+    int count = 0;
+    for (int k = 0; k < effSteps; ++k) {
+      int i = UzzEngine::wrapSlot(effStart + k, chainSlots);
+      if (i < 16)
+        slot[count++] = i;
+    }
+    return count;
   }
 
-  void shift_row_int(int base_param, int dir, int start_idx, int count,
+  void shift_row_int(int row, int dir, const int *slot, int count,
                      int min_val, int max_val) {
     if (count <= 0)
       return;
+    float v[16];
+    for (int i = 0; i < 16; ++i)
+      v[i] = params[rowParam(row) + i].getValue();
     int step_dir = (dir >= 0) ? 1 : -1;
     for (int i = 0; i < count; ++i) {
-      int idx = wrap16(start_idx + i);
-      int current = (int)std::round(params[base_param + idx].getValue());
-      int next = clamp(current + step_dir, min_val, max_val);
-      params[base_param + idx].setValue((float)next);
+      int idx = slot[i];
+      int current = (int)std::round(v[idx]);
+      v[idx] = (float)clamp(current + step_dir, min_val, max_val);
     }
+    writeEditRow(row, v);
   }
 
-  void shift_row_float(int base_param, int dir, int start_idx, int count,
+  void shift_row_float(int row, int dir, const int *slot, int count,
                        float step_amount, float min_val, float max_val,
                        bool quantize) {
     if (count <= 0)
       return;
+    float v[16];
+    for (int i = 0; i < 16; ++i)
+      v[i] = params[rowParam(row) + i].getValue();
     int step_dir = (dir >= 0) ? 1 : -1;
     for (int i = 0; i < count; ++i) {
-      int idx = wrap16(start_idx + i);
-      float current = params[base_param + idx].getValue();
+      int idx = slot[i];
+      float current = v[idx];
       if (quantize)
         current = quantize_to_step(current, min_val, step_amount);
       float next = current + (float)step_dir * step_amount;
       if (quantize)
         next = quantize_to_step(next, min_val, step_amount);
-      next = clamp(next, min_val, max_val);
-      params[base_param + idx].setValue(next);
+      v[idx] = clamp(next, min_val, max_val);
     }
+    writeEditRow(row, v);
   }
 
   void shift_pitch_row(int dir) {
-    int s, c;
-    get_active_window(s, c);
-    shift_row_int(PITCH_PARAMS, dir, s, c, 0, pitchRangeSemis);
+    int s[16];
+    int c = get_active_window(s);
+    shift_row_int(ROW_PITCH, dir, s, c, 0, pitchRangeSemis);
   }
   void shift_oct_row(int dir) {
-    int s, c;
-    get_active_window(s, c);
-    shift_row_int(OCT_PARAMS, dir, s, c, -2, 2);
+    int s[16];
+    int c = get_active_window(s);
+    shift_row_int(ROW_OCT, dir, s, c, -2, 2);
   }
   void shift_dur_row(int dir) {
-    int s, c;
-    get_active_window(s, c);
-    shift_row_float(DUR_PARAMS, dir, s, c, 0.05f, 0.01f, 0.95f, true);
+    int s[16];
+    int c = get_active_window(s);
+    shift_row_float(ROW_DUR, dir, s, c, 0.05f, 0.01f, 0.95f, true);
   }
   void shift_m1_row(int dir) {
-    int s, c;
-    get_active_window(s, c);
-    shift_row_float(M1_PARAMS, dir, s, c, 1.f, 0.f, 10.f, true);
+    int s[16];
+    int c = get_active_window(s);
+    shift_row_float(ROW_M1, dir, s, c, 1.f, 0.f, 10.f, true);
   }
   void shift_m2_row(int dir) {
-    int s, c;
-    get_active_window(s, c);
-    shift_row_float(M2_PARAMS, dir, s, c, 1.f, 0.f, 10.f, true);
+    int s[16];
+    int c = get_active_window(s);
+    shift_row_float(ROW_M2, dir, s, c, 1.f, 0.f, 10.f, true);
   }
   void shift_prob_row(int dir) {
-    int s, c;
-    get_active_window(s, c);
-    shift_row_float(PROB_PARAMS, dir, s, c, 1.f, -100.f, 7.f, true);
+    int s[16];
+    int c = get_active_window(s);
+    shift_row_float(ROW_PROB, dir, s, c, 1.f, -100.f, 7.f, true);
   }
 
   // Rotate every per-step lane (and the runtime accumulator offsets) one
   // position within the active window, wrapping. dir=+1 moves each step's
-  // content forward (to the right).
+  // content forward (to the right). All tracks rotate together so they stay
+  // aligned with each other. A chain leader rotates its own steps only.
   void rotateSequence(int dir) {
-    int s, c;
-    get_active_window(s, c);
+    int s[16];
+    int c = get_active_window(s);
     if (c <= 1)
       return;
-    static const int laneBases[] = {PITCH_PARAMS, OCT_PARAMS,
-                                    STEP_MODE_PARAMS, DUR_PARAMS,
-                                    M1_PARAMS, M2_PARAMS, PROB_PARAMS};
     float tmp[16];
-    for (int base : laneBases) {
-      for (int i = 0; i < c; ++i)
-        tmp[i] = params[base + wrap16(s + i)].getValue();
-      for (int i = 0; i < c; ++i)
-        params[base + wrap16(s + i)].setValue(tmp[(i - dir + c) % c]);
+    for (int t = 0; t < engine.trackCount; ++t) {
+      for (int r = 0; r < NUM_STEP_ROWS; ++r) {
+        for (int i = 0; i < c; ++i)
+          tmp[i] = stepValue(t, r, s[i]);
+        for (int i = 0; i < c; ++i)
+          setStepValue(t, r, s[i], tmp[(i - dir + c) % c]);
+      }
     }
-    int tmpA[16];
-    for (int i = 0; i < c; ++i)
-      tmpA[i] = accumOffset[wrap16(s + i)];
-    for (int i = 0; i < c; ++i)
-      accumOffset[wrap16(s + i)] = tmpA[(i - dir + c) % c];
+    engine.rotateAccumulators(s, c, dir);
+    snapDirty = true;
+  }
+
+  // A leader stores every slot of its chain, a follower its own 16.
+  void storeSnapshot(int slot) {
+    const int n = chainIndex > 0 ? 16 : chainSlots;
+    snapshots[slot].store(engine, n, [this](int t, int r, int i) {
+      return slotValue(t, r, i);
+    });
+    snapshotSlot = slot;
+    if (slot == morphSlot) {
+      snapMorph = -1.f; // recompile against the new target
+      snapDirty = true;
+    }
+  }
+
+  void clearSnapshot(int slot) {
+    snapshots[slot].used = false;
+    if (slot == morphSlot) {
+      snapMorph = -1.f;
+      snapDirty = true;
+    }
+  }
+
+  // Compiles every track of the slot into engine.staged for the engine to
+  // swap in on the next step, over the whole chain.
+  void stageRecall(int slot) {
+    const UzzSnapshot &sn = snapshots[slot];
+    if (!sn.used)
+      return;
+    sn.stage(engine, chainSlots, pitchRangeSemis,
+             [this](UzzTrackSnap &s, int t, int i) { compileStep(s, t, i); });
+    snapshotSlot = slot;
+  }
+
+  // The engine has swapped a recalled pattern in: write it to the panel and
+  // the bank, so the next refresh finds nothing changed. Returns true when
+  // it reaches into the followers, whose rows then go out in chainRecall.
+  bool applyRecalled() {
+    engine.stagedSwapped = false;
+    for (int t = 0; t < UZZ_MAX_TRACKS; ++t)
+      for (int r = 0; r < NUM_STEP_ROWS; ++r)
+        for (int i = 0; i < 16; ++i)
+          setStepValue(t, r, i, engine.snap[t].raw[r][i]);
+    if (engine.stagedAccumSlots <= 16)
+      return false;
+    chainRecall.fill(engine.snap, engine.stagedAccumSlots);
+    chainRecall.seq = ++recallSeq;
+    recallHold = true;
+    return true;
   }
 
   json_t *dataToJson() override {
@@ -506,27 +933,106 @@ struct UZZ : Module {
     json_object_set_new(rootJ, "m2Range", json_integer(m2Range));
     json_object_set_new(rootJ, "pitchRangeSemis",
                         json_integer(pitchRangeSemis));
-    json_object_set_new(rootJ, "eocOnReset", json_boolean(eocOnReset));
-    json_object_set_new(rootJ, "currentStep", json_integer(step));
-    json_object_set_new(rootJ, "pingDir", json_integer(navigator.pingDir));
-    json_object_set_new(rootJ, "drunkDir", json_integer(navigator.drunkDir));
-    json_object_set_new(rootJ, "seqPos", json_integer(navigator.seqPos));
-    json_object_set_new(rootJ, "jumpN", json_integer(jumpN));
+    json_object_set_new(rootJ, "eocOnReset", json_boolean(engine.eocOnReset));
+    json_object_set_new(rootJ, "clockPll", json_boolean(engine.clock.pllMode));
+    // Stored as a string: a 64-bit seed does not survive JSON's double.
+    json_object_set_new(rootJ, "seed",
+                        json_string(string::f("%" PRIu64, seed).c_str()));
+    json_object_set_new(rootJ, "reseedOnReset", json_boolean(reseedOnReset));
+    json_object_set_new(rootJ, "chainFollow", json_boolean(chainFollow));
+    json_object_set_new(rootJ, "scale", json_integer(engine.scale.scale));
+    json_object_set_new(rootJ, "scaleRoot", json_integer(engine.scale.root));
+    json_object_set_new(rootJ, "groove", json_integer(groove));
+    json_object_set_new(rootJ, "recMode", json_integer(recMode));
+    json_object_set_new(rootJ, "jumpN", json_integer(engine.jumpN));
+
+    // Track 1 runtime state keeps its pre-multitrack keys.
+    const UzzTrack &t0 = engine.tracks[0];
+    json_object_set_new(rootJ, "currentStep", json_integer(t0.step));
+    json_object_set_new(rootJ, "pingDir", json_integer(t0.navigator.pingDir));
+    json_object_set_new(rootJ, "drunkDir",
+                        json_integer(t0.navigator.drunkDir));
+    json_object_set_new(rootJ, "seqPos", json_integer(t0.navigator.seqPos));
 
     json_t *accArr = json_array();
     for (int i = 0; i < 16; ++i)
-      json_array_append_new(accArr, json_integer(accumOffset[i]));
+      json_array_append_new(accArr, json_integer(t0.accumOffset[i]));
     json_object_set_new(rootJ, "accumOffset", accArr);
 
+    // Every track's step data, including the one on the panel (whose params
+    // are also saved by Rack). All eight are kept even when fewer play, so
+    // lowering the track count does not lose anything.
+    json_object_set_new(rootJ, "trackCount", json_integer(engine.trackCount));
+    json_object_set_new(rootJ, "editTrack", json_integer(editTrack));
+    json_t *tracksJ = json_array();
+    for (int t = 0; t < UZZ_MAX_TRACKS; ++t) {
+      json_t *trackJ = json_object();
+      for (int r = 0; r < NUM_STEP_ROWS; ++r) {
+        json_t *rowJ = json_array();
+        for (int i = 0; i < 16; ++i)
+          json_array_append_new(rowJ, json_real(stepValue(t, r, i)));
+        json_object_set_new(trackJ, STEP_ROW_KEYS[r], rowJ);
+      }
+      const UzzTrack &tr = engine.tracks[t];
+      json_object_set_new(trackJ, "currentStep", json_integer(tr.step));
+      json_t *trackAccJ = json_array();
+      for (int i = 0; i < 16; ++i)
+        json_array_append_new(trackAccJ, json_integer(tr.accumOffset[i]));
+      json_object_set_new(trackJ, "accumOffset", trackAccJ);
+      json_t *microJ = json_array();
+      for (int i = 0; i < 16; ++i)
+        json_array_append_new(microJ, json_integer(micro[t][i]));
+      json_object_set_new(trackJ, "micro", microJ);
+      json_t *chordJ = json_array();
+      for (int i = 0; i < 16; ++i)
+        json_array_append_new(chordJ, json_integer(chord[t][i]));
+      json_object_set_new(trackJ, "chord", chordJ);
+      json_t *condJ = json_array();
+      for (int i = 0; i < 16; ++i)
+        json_array_append_new(condJ, json_integer(cond[t][i]));
+      json_object_set_new(trackJ, "cond", condJ);
+      json_array_append_new(tracksJ, trackJ);
+    }
+    json_object_set_new(rootJ, "tracks", tracksJ);
+
+    // Used snapshot slots only, 20 hex characters per step of every track.
+    json_object_set_new(rootJ, "snapshotSlot", json_integer(snapshotSlot));
+    json_object_set_new(rootJ, "morphSlot", json_integer(morphSlot));
+    json_t *snapsJ = json_array();
+    for (int s = 0; s < UZZ_NUM_SNAPSHOTS; ++s) {
+      if (!snapshots[s].used)
+        continue;
+      json_t *snapJ = json_object();
+      json_object_set_new(snapJ, "slot", json_integer(s));
+      json_object_set_new(snapJ, "data",
+                          json_string(snapshots[s].toHex().c_str()));
+      json_array_append_new(snapsJ, snapJ);
+    }
+    json_object_set_new(rootJ, "snapshots", snapsJ);
+
     return rootJ;
   }
 
+  static void accumFromJson(json_t *accArr, int *accumOffset) {
+    if (!json_is_array(accArr))
+      return;
+    size_t n = json_array_size(accArr);
+    for (int i = 0; i < 16 && (size_t)i < n; ++i) {
+      int v = (int)json_integer_value(json_array_get(accArr, i));
+      accumOffset[i] = clamp(v, -12, 12);
+    }
+  }
+
   void dataFromJson(json_t *rootJ) override {
     onReset();
 
     for (int r = 0; r < NUM_RND_BANKS; ++r)
       skipNextRandom[r] = false;
-    eocOnReset = false;
+    engine.eocOnReset = false;
+    engine.clock.pllMode = false;
+    reseedOnReset = false;
+    chainFollow = false;
+    engine.setScale(0, 0);
 
     if (!rootJ)
       return;
@@ -542,7 +1048,30 @@ struct UZZ : Module {
       m2Range = UZZRanges::MR_0_10;
 
     if (json_t *j = json_object_get(rootJ, "eocOnReset"))
-      eocOnReset = json_is_true(j);
+      engine.eocOnReset = json_is_true(j);
+    if (json_t *j = json_object_get(rootJ, "clockPll"))
+      engine.clock.pllMode = json_is_true(j);
+    if (json_t *j = json_object_get(rootJ, "reseedOnReset"))
+      reseedOnReset = json_is_true(j);
+    if (json_t *j = json_object_get(rootJ, "chainFollow"))
+      chainFollow = json_is_true(j);
+    if (json_t *j = json_object_get(rootJ, "groove"))
+      groove = clamp((int)json_integer_value(j), 0, UZZ_NUM_GROOVES - 1);
+    if (json_t *j = json_object_get(rootJ, "recMode"))
+      recMode = (json_integer_value(j) == REC_CONTINUOUS) ? REC_CONTINUOUS
+                                                          : REC_ON_STEP;
+    {
+      json_t *sj = json_object_get(rootJ, "scale");
+      json_t *rj = json_object_get(rootJ, "scaleRoot");
+      engine.setScale(rj ? (int)json_integer_value(rj) : 0,
+                      sj ? (int)json_integer_value(sj) : 0);
+    }
+    // Patches from before the seed keep the one this instance picked.
+    if (json_t *j = json_object_get(rootJ, "seed")) {
+      if (json_is_string(j))
+        seed = strtoull(json_string_value(j), NULL, 10);
+      reseed();
+    }
 
     if (json_t *j = json_object_get(rootJ, "pitchRangeSemis"))
       setPitchRange((int)json_integer_value(j), false);
@@ -552,112 +1081,388 @@ struct UZZ : Module {
     int steps = clamp((int)std::round(params[STEPS_PARAM].getValue()), 1, 16);
     int start =
         clamp((int)std::round(params[START_PARAM].getValue()) - 1, 0, 15);
-
-    if (json_t *j = json_object_get(rootJ, "currentStep")) {
+    auto restoreStep = [&](json_t *j) {
+      if (!j)
+        return start;
       int savedStep = clamp((int)json_integer_value(j), 0, 15);
       int rel = (savedStep - start + 16) & 15;
-      step = (rel < steps) ? savedStep : start;
-    } else {
-      step = start;
+      return (rel < steps) ? savedStep : start;
+    };
+
+    // Patches from before multi-track have one track, on the panel. Rack has
+    // already restored the params, which hold the saved edit track's data.
+    if (json_t *j = json_object_get(rootJ, "trackCount"))
+      engine.trackCount = clamp((int)json_integer_value(j), 1, UZZ_MAX_TRACKS);
+    if (json_t *j = json_object_get(rootJ, "editTrack"))
+      editTrack = clamp((int)json_integer_value(j), 0, engine.trackCount - 1);
+    json_t *tracksJ = json_object_get(rootJ, "tracks");
+    for (int t = 0; json_is_array(tracksJ) && t < UZZ_MAX_TRACKS &&
+                    (size_t)t < json_array_size(tracksJ);
+         ++t) {
+      json_t *trackJ = json_array_get(tracksJ, t);
+      for (int r = 0; r < NUM_STEP_ROWS; ++r) {
+        json_t *rowJ = json_object_get(trackJ, STEP_ROW_KEYS[r]);
+        for (int i = 0; json_is_array(rowJ) && i < 16 &&
+                        (size_t)i < json_array_size(rowJ);
+             ++i)
+          bank.value[r][t][i] = (float)json_number_value(json_array_get(rowJ, i));
+      }
+      json_t *microJ = json_object_get(trackJ, "micro");
+      for (int i = 0; json_is_array(microJ) && i < 16 &&
+                      (size_t)i < json_array_size(microJ);
+           ++i)
+        micro[t][i] = (int8_t)clamp(
+            (int)json_integer_value(json_array_get(microJ, i)), -50, 50);
+      json_t *chordJ = json_object_get(trackJ, "chord");
+      for (int i = 0; json_is_array(chordJ) && i < 16 &&
+                      (size_t)i < json_array_size(chordJ);
+           ++i)
+        chord[t][i] = (int8_t)clamp(
+            (int)json_integer_value(json_array_get(chordJ, i)), 0,
+            UZZ_NUM_CHORDS - 1);
+      json_t *condJ = json_object_get(trackJ, "cond");
+      for (int i = 0; json_is_array(condJ) && i < 16 &&
+                      (size_t)i < json_array_size(condJ);
+           ++i)
+        cond[t][i] = (int8_t)clamp(
+            (int)json_integer_value(json_array_get(condJ, i)), 0,
+            UZZ_NUM_CONDS - 1);
+      if (t == 0)
+        continue;
+      engine.tracks[t].step =
+          restoreStep(json_object_get(trackJ, "currentStep"));
+      accumFromJson(json_object_get(trackJ, "accumOffset"),
+                    engine.tracks[t].accumOffset);
     }
 
+    UzzTrack &t0 = engine.tracks[0];
+    t0.step = restoreStep(json_object_get(rootJ, "currentStep"));
+
     if (json_t *j = json_object_get(rootJ, "pingDir"))
-      navigator.pingDir = clamp((int)json_integer_value(j), 0, 1);
+      t0.navigator.pingDir = clamp((int)json_integer_value(j), 0, 1);
 
     if (json_t *j = json_object_get(rootJ, "drunkDir")) {
       int dir = clamp((int)json_integer_value(j), -1, 1);
-      navigator.drunkDir = (dir == 0) ? 1 : dir;
+      t0.navigator.drunkDir = (dir == 0) ? 1 : dir;
     }
     if (json_t *j = json_object_get(rootJ, "seqPos"))
-      navigator.seqPos = clamp((int)json_integer_value(j), 0, 31);
+      t0.navigator.seqPos = clamp((int)json_integer_value(j), 0, 31);
     if (json_t *j = json_object_get(rootJ, "jumpN"))
-      jumpN = clamp((int)json_integer_value(j), 2, 7);
-
-    if (json_t *accArr = json_object_get(rootJ, "accumOffset")) {
-      if (json_is_array(accArr)) {
-        size_t n = json_array_size(accArr);
-        for (int i = 0; i < 16 && (size_t)i < n; ++i) {
-          int v = (int)json_integer_value(json_array_get(accArr, i));
-          accumOffset[i] = clamp(v, -12, 12);
-        }
-      }
+      engine.jumpN = clamp((int)json_integer_value(j), 2, 7);
+
+    accumFromJson(json_object_get(rootJ, "accumOffset"), t0.accumOffset);
+
+    if (json_t *j = json_object_get(rootJ, "snapshotSlot"))
+      snapshotSlot =
+          clamp((int)json_integer_value(j), 0, UZZ_NUM_SNAPSHOTS - 1);
+    if (json_t *j = json_object_get(rootJ, "morphSlot"))
+      morphSlot = clamp((int)json_integer_value(j), 0, UZZ_NUM_SNAPSHOTS - 1);
+    json_t *snapsJ = json_object_get(rootJ, "snapshots");
+    for (size_t k = 0; json_is_array(snapsJ) && k < json_array_size(snapsJ);
+         ++k) {
+      json_t *snapJ = json_array_get(snapsJ, k);
+      int s = (int)json_integer_value(json_object_get(snapJ, "slot"));
+      if (s >= 0 && s < UZZ_NUM_SNAPSHOTS)
+        snapshots[s].fromHex(
+            json_string_value(json_object_get(snapJ, "data")));
     }
+    pushTiming();
+    chordsChanged();
+    pushConditions();
   }
 
-  void applySlew(float target, float sampleTime) {
-    float slewSec = params[SLEW_PARAM].getValue();
-    if (slewSec <= 1e-6f) {
-      pitchOut = target;
-      pitchInit = true;
-    } else {
-      if (slewSec != cachedSlewSec || sampleTime != cachedSampleTime) {
-        cachedSlewSec = slewSec;
-        cachedSampleTime = sampleTime;
-        float tau = std::max(1e-5f, slewSec);
-        // sqrt() compresses the 1-pole alpha: snappier attack, shorter tail —
-        // intentionally more musical than a pure exponential glide.
-        cachedSlewAlpha =
-            std::sqrt(std::min(1.f - std::exp(-sampleTime / tau), 1.f));
-      }
-      if (!pitchInit) {
-        pitchOut = target;
-        pitchInit = true;
-      }
-      pitchOut += (target - pitchOut) * cachedSlewAlpha;
+  // Slew coefficient for this sample, shared by every track; 1 = no slew.
+  float slewAlpha(float sampleTime) {
+    float slewSec = knobs.slew;
+    if (slewSec <= 1e-6f)
+      return 1.f;
+    if (slewSec != cachedSlewSec || sampleTime != cachedSampleTime) {
+      cachedSlewSec = slewSec;
+      cachedSampleTime = sampleTime;
+      float tau = std::max(1e-5f, slewSec);
+      // sqrt() compresses the 1-pole alpha: snappier attack, shorter tail —
+      // intentionally more musical than a pure exponential glide.
+      cachedSlewAlpha =
+          std::sqrt(std::min(1.f - std::exp(-sampleTime / tau), 1.f));
     }
-    outputs[PITCH_OUTPUT].setVoltage(pitchOut);
+    return cachedSlewAlpha;
   }
 
-  void hardStop(int steps) {
-    pulsesRemaining = 0;
-    holdPulsesLeft = 0;
-    holdPlaying = false;
-    gatePulse.reset();
-    eocPulse.reset();
-    for (int ch = 0; ch < 16; ++ch)
-      stepGateTrig[ch].reset();
-    clock.reset();
-
-    outputs[GATE_OUTPUT].setVoltage(0.f);
-    outputs[STEP_GATES_OUTPUT].setChannels(steps);
-    for (int ch = 0; ch < steps; ++ch)
-      outputs[STEP_GATES_OUTPUT].setVoltage(0.f, ch);
-    outputs[EOC_OUTPUT].setVoltage(0.f);
+  void applyCommand(const Command &c) {
+    switch (c.type) {
+    case CMD_EDIT_TRACK:
+      selectEditTrack(c.arg);
+      break;
+    case CMD_TRACK_COUNT:
+      engine.trackCount = clamp((int)c.arg, 1, UZZ_MAX_TRACKS);
+      break;
+    case CMD_RESET_ROW:
+      resetRow(clamp((int)c.arg, 0, NUM_STEP_ROWS - 1));
+      break;
+    case CMD_DIRECTION:
+      params[DIR_MODE_PARAM].setValue((float)c.arg);
+      for (int t = 0; t < UZZ_MAX_TRACKS; ++t)
+        engine.tracks[t].navigator.reset();
+      snapDirty = true; // re-read the knob now
+      break;
+    case CMD_JUMP_STRIDE:
+      engine.jumpN = c.arg;
+      for (int t = 0; t < UZZ_MAX_TRACKS; ++t)
+        engine.tracks[t].navigator.seqPos = 0;
+      break;
+    case CMD_PITCH_RANGE:
+      setPitchRange(c.arg);
+      snapDirty = true;
+      break;
+    case CMD_EOC_ON_RESET:
+      engine.eocOnReset = c.arg != 0;
+      break;
+    case CMD_PHASE_LOCK:
+      engine.clock.pllMode = c.arg != 0;
+      break;
+    case CMD_M1_RANGE:
+      m1Range = c.arg;
+      break;
+    case CMD_M2_RANGE:
+      m2Range = c.arg;
+      break;
+    case CMD_SNAP_STORE:
+      storeSnapshot(c.arg);
+      break;
+    case CMD_SNAP_RECALL:
+      stageRecall(c.arg);
+      break;
+    case CMD_SNAP_CLEAR:
+      clearSnapshot(c.arg);
+      break;
+    case CMD_MORPH_TARGET:
+      morphSlot = c.arg;
+      break;
+    case CMD_RESEED_ON_RESET:
+      reseedOnReset = c.arg != 0;
+      break;
+    case CMD_RESTART_SEED:
+      reseed();
+      break;
+    case CMD_NEW_SEED:
+      seed = random::u64();
+      reseed();
+      break;
+    case CMD_CHAIN_FOLLOW:
+      chainFollow = c.arg != 0;
+      break;
+    case CMD_SCALE:
+      engine.setScale(engine.scale.root, c.arg);
+      break;
+    case CMD_SCALE_ROOT:
+      engine.setScale(c.arg, engine.scale.scale);
+      break;
+    case CMD_GROOVE:
+      groove = clamp((int)c.arg, 0, UZZ_NUM_GROOVES - 1);
+      pushTiming();
+      break;
+    case CMD_MICRO:
+      micro[editTrack][(c.arg >> 8) & 15] =
+          (int8_t)clamp((c.arg & 0xFF) - 50, -50, 50);
+      pushTiming();
+      break;
+    case CMD_MICRO_CLEAR:
+      for (int i = 0; i < 16; ++i)
+        micro[editTrack][i] = 0;
+      pushTiming();
+      break;
+    case CMD_REC_MODE:
+      recMode = (c.arg == REC_CONTINUOUS) ? REC_CONTINUOUS : REC_ON_STEP;
+      break;
+    case CMD_CHORD:
+      chord[editTrack][(c.arg >> 8) & 15] =
+          (int8_t)clamp(c.arg & 0xFF, 0, UZZ_NUM_CHORDS - 1);
+      chordsChanged();
+      break;
+    case CMD_CHORD_CLEAR:
+      for (int i = 0; i < 16; ++i)
+        chord[editTrack][i] = 0;
+      chordsChanged();
+      break;
+    case CMD_COND:
+      cond[editTrack][(c.arg >> 8) & 15] =
+          (int8_t)clamp(c.arg & 0xFF, 0, UZZ_NUM_CONDS - 1);
+      pushConditions();
+      break;
+    case CMD_COND_CLEAR:
+      for (int i = 0; i < 16; ++i)
+        cond[editTrack][i] = 0;
+      pushConditions();
+      break;
+    case CMD_LATENCY:
+      latency.clear();
+      engine.probe = c.arg ? &latency : nullptr;
+      break;
+    case CMD_LATENCY_CLEAR:
+      latency.clear();
+      break;
+    }
+  }
+
+  // Sends the UZZ on the left this module's rows plus those relayed from the
+  // followers on the right, or modules = 0 when this one does not chain.
+  // recallEcho: the last recall taken from here to the end of the chain.
+  void sendChainUp(int rightModules, uint32_t recallEcho = 0) {
+    ExpanderOutbox<UzzChainUp> m(this, false, modelUZZ);
+    if (!m)
+      return;
+    m->modules = 0;
+    m->recallSeq = recallEcho;
+    if (chainFollow) {
+      const int relayed = std::min(rightModules, UZZ_MAX_CHAIN - 2);
+      m->modules = 1 + relayed;
+      for (int t = 0; t < UZZ_MAX_TRACKS; ++t)
+        for (int r = 0; r < NUM_STEP_ROWS; ++r)
+          for (int i = 0; i < 16; ++i)
+            m->rows[0][t][r][i] = stepValue(t, r, i);
+      const UzzChainUp *up =
+          ExpanderInbox<UzzChainUp>::read(rightExpander, modelUZZ);
+      if (relayed > 0 && up)
+        std::memcpy(m->rows[1], up->rows, relayed * sizeof(m->rows[0]));
+    }
+    m.send();
+  }
+
+  // Hands chainDown to the UZZ on the right, if there is one, with the
+  // rows of a recall when there is one to pass on.
+  void sendChainDown(const UzzChainRecall *recall = nullptr) {
+    ExpanderOutbox<UzzLeftMsg> m(this, true, modelUZZ);
+    if (!m)
+      return;
+    m->chain = chainDown;
+    if (recall)
+      m->recall = *recall;
+    m.send();
+  }
+
+  // Follower side of a chain: mirror the leader's playhead on the LEDs and
+  // this module's share of the window on STEP GATES, take this module's rows
+  // of a recall onto the panel, and pass the message on. The other outputs
+  // rest at 0 V; the leader plays every track.
+  void processFollower(const UzzLeftMsg &msg, int rightModules,
+                       bool control, bool updateLights, float lightDt) {
+    const UzzChainDown &down = msg.chain;
+    chainIndex = down.index;
+    engine.trackCount = clamp(down.trackCount, 1, UZZ_MAX_TRACKS);
+    const int base = 16 * down.index;
+    const bool last = rightModules == 0 || base + 16 >= down.slots;
+
+    // A recall that came without its rows (this module joined after it went
+    // out) is only counted.
+    const bool relayRecall =
+        down.recallSeq != recallSeq && msg.recall.seq == down.recallSeq;
+    if (relayRecall && base < msg.recall.slots) {
+      for (int t = 0; t < UZZ_MAX_TRACKS; ++t)
+        for (int r = 0; r < NUM_STEP_ROWS; ++r)
+          for (int i = 0; i < 16; ++i)
+            setStepValue(t, r, i, msg.recall.rows[down.index - 1][t][r][i]);
+    }
+    recallSeq = down.recallSeq;
+
+    if (control) {
+      const UzzChainUp *up =
+          ExpanderInbox<UzzChainUp>::read(rightExpander, modelUZZ);
+      sendChainUp(rightModules, !last && up ? up->recallSeq : recallSeq);
+    }
+
+    const int outs[] = {PITCH_OUTPUT, GATE_OUTPUT, M1_OUTPUT, M2_OUTPUT,
+                        EOC_OUTPUT};
+    for (int o : outs) {
+      outputs[o].setChannels(1);
+      outputs[o].setVoltage(0.f);
+    }
+    if (down.running || down.stopped) {
+      const int n = clamp(down.steps - base, 0, 16);
+      outputs[STEP_GATES_OUTPUT].setChannels(std::max(n, 1));
+      outputs[STEP_GATES_OUTPUT].setVoltage(0.f);
+      writePolyGates(outputs[STEP_GATES_OUTPUT],
+                     (uint32_t)(down.stepGates >> base) & 0xFFFF, n);
+    }
+
+    chainDown = down;
+    chainDown.index = last ? 0 : down.index + 1;
+    sendChainDown(relayRecall ? &msg.recall : nullptr);
+
+    if (updateLights) {
+      const int ledStep = down.step[std::min(editTrack, UZZ_MAX_TRACKS - 1)] -
+                          base;
+      for (int i = 0; i < 16; ++i)
+        lights[STEP_LIGHTS + i].setSmoothBrightness(i == ledStep ? 1.f : 0.f,
+                                                    lightDt);
+    }
   }
 
   void process(const ProcessArgs &args) override {
+    Command cmd;
+    while (commands.pop(cmd))
+      applyCommand(cmd);
+    if (editTrack >= engine.trackCount)
+      selectEditTrack(engine.trackCount - 1);
+
     bool clkConnected = inputs[CLK_INPUT].isConnected();
     bool updateLights = lightDivider.process();
+    // Knobs and buttons are polled at control rate (and right away after a
+    // reset or patch load, which leave snapDirty set).
+    bool control = paramDivider.process() || snapDirty;
+    if (control)
+      readKnobs();
     float lightDt = args.sampleTime * lightDivider.getDivision();
 
-    // UZZ-X expander (left): CV offsets around knobs + trigger events.
-    UzzExpMsg *xmsg = nullptr;
-    if (leftExpander.module && leftExpander.module->model == modelUzzX)
-      xmsg = (UzzExpMsg *)leftExpander.consumerMessage;
-    if (xmsg && !xLinked) {
-      // First frame after linking: adopt counters without firing events.
-      xLastAccumRst = xmsg->accumRstCount;
-      xLastRotFwd = xmsg->rotFwdCount;
-      xLastRotBack = xmsg->rotBackCount;
+    // Chain: follow the UZZ on the left once it hands this module a message
+    // with a place in its chain; lead the followers found on the right.
+    const UzzLeftMsg *fromUzz =
+        ExpanderInbox<UzzLeftMsg>::read(leftExpander, modelUZZ);
+    const UzzLeftMsg *down = nullptr;
+    if (chainFollow && fromUzz && fromUzz->chain.index > 0)
+      down = fromUzz;
+    // The UZZ on the right follows when its message counts itself (modules >
+    // 0); its own members are never read.
+    const UzzChainUp *fromRight =
+        ExpanderInbox<UzzChainUp>::read(rightExpander, modelUZZ);
+    const int rightModules =
+        fromRight ? clamp(fromRight->modules, 0, UZZ_MAX_CHAIN - 1) : 0;
+    if (!down) {
+      chainIndex = 0;
+      if (1 + rightModules != chainModules) {
+        chainModules = 1 + rightModules;
+        chainSlots = 16 * chainModules;
+        recallHold = false;
+        for (int t = 0; t < UZZ_MAX_TRACKS; ++t)
+          engine.snap[t].valid = false;
+        snapDirty = true;
+      }
+      if (recallHold && fromRight && fromRight->recallSeq == recallSeq)
+        recallHold = false;
+      if (control)
+        sendChainUp(rightModules);
     }
-    xLinked = (xmsg != nullptr);
+
+    // UZZ-X expander (left): CV offsets around knobs + trigger events.
+    const UzzLeftMsg *fromX =
+        ExpanderInbox<UzzLeftMsg>::read(leftExpander, modelUzzX);
+    const UzzExpMsg *xmsg = fromX ? &fromX->uzzx : nullptr;
+    if (!xmsg)
+      xEvents.unlink();
     auto xcv = [&](int id) -> float {
       return (xmsg && xmsg->connected[id]) ? xmsg->cv[id] : 0.f;
     };
 
-    int ratioIdx = clamp((int)std::round(params[RATIO_IDX_PARAM].getValue()) +
-                             (int)std::round(xcv(UZZX_CV_RATIO)),
+    UzzEngine::Input in;
+    in.sampleTime = args.sampleTime;
+    in.clkConnected = clkConnected;
+    in.clkVoltage = inputs[CLK_INPUT].getVoltage();
+    int ratioIdx = clamp(knobs.ratioIdx + (int)std::round(xcv(UZZX_CV_RATIO)),
                          0, NUM_RATIOS - 1);
-    float ratio = RATIO_TABLE[ratioIdx];
-    float swing = clamp(params[SWING_PARAM].getValue() +
-                            xcv(UZZX_CV_SWING) * (0.6f / 5.f),
-                        0.f, 0.6f);
+    in.ratio = RATIO_TABLE[ratioIdx];
+    in.swing = clamp(knobs.swing + xcv(UZZX_CV_SWING) * (0.6f / 5.f), 0.f,
+                     0.6f);
 
-    bool wasClkConnected = clock.prevClkConnected;
-    bool clockNow =
-        clock.process(args, inputs[CLK_INPUT], ratio, swing, clkConnected);
-
-    if (capiTrig.process(inputs[CLK_INPUT].getVoltage())) {
+    if (capiTrig.process(in.clkVoltage)) {
       capiFlash = 1.0f;
     }
     // Decay flash over time
@@ -665,10 +1470,7 @@ struct UZZ : Module {
       capiFlash = std::max(0.f, capiFlash - 15.f * args.sampleTime);
     }
 
-    if (!clkConnected && wasClkConnected)
-      clock.onDisconnect();
-
-    // Random buttons + lights + CV triggers
+    // Random buttons + lights + CV triggers (they act on the edit track)
     typedef void (UZZ::*RndFn)();
     static const RndFn rndFns[] = {
         &UZZ::randomizePitch,    &UZZ::randomizeOctaves,
@@ -683,7 +1485,8 @@ struct UZZ : Module {
                                       RND_M1_TRIG_INPUT,    RND_M2_TRIG_INPUT,
                                       RND_PROB_TRIG_INPUT};
     for (int r = 0; r < NUM_RND_BANKS; ++r) {
-      if (rndBtnTrig[r].process(params[rndParamIds[r]].getValue() > .5f)) {
+      if (control &&
+          rndBtnTrig[r].process(params[rndParamIds[r]].getValue() > .5f)) {
         if (!skipNextRandom[r])
           (this->*rndFns[r])();
         skipNextRandom[r] = false;
@@ -706,366 +1509,185 @@ struct UZZ : Module {
     static const int shiftUpIds[] = {PITCH_SHIFT_UP_PARAM, OCT_SHIFT_UP_PARAM,
                                      DUR_SHIFT_UP_PARAM,   M1_SHIFT_UP_PARAM,
                                      M2_SHIFT_UP_PARAM,    PROB_SHIFT_UP_PARAM};
-    for (int r = 0; r < NUM_SHIFT_ROWS; ++r) {
+    for (int r = 0; control && r < NUM_SHIFT_ROWS; ++r) {
       if (shiftUpTrig[r].process(params[shiftUpIds[r]].getValue() > 0.5f))
         (this->*shiftFns[r])(+1);
       if (shiftDownTrig[r].process(params[shiftDownIds[r]].getValue() > 0.5f))
         (this->*shiftFns[r])(-1);
     }
 
-    // Window (knob + expander offsets)
-    int steps = clamp((int)std::round(params[STEPS_PARAM].getValue()) +
+    if (down) {
+      processFollower(*down, rightModules, control, updateLights, lightDt);
+      return;
+    }
+
+    // Window (knob + expander offsets). Leading a chain, STEPS counts the
+    // followers' steps on top of the knob and START may reach into them.
+    int steps = clamp(knobs.steps + 16 * (chainModules - 1) +
                           (int)std::round(xcv(UZZX_CV_STEPS)),
-                      1, 16);
-    int start = clamp((int)std::round(params[START_PARAM].getValue()) - 1 +
-                          (int)std::round(xcv(UZZX_CV_START)),
-                      0, 15);
+                      1, chainSlots);
+    int start = clamp(knobs.start + (int)std::round(xcv(UZZX_CV_START)), 0,
+                      chainSlots - 1);
     effSteps = steps;
     effStart = start;
 
-    // Expander trigger events (counter deltas; at most one per sample each)
-    if (xmsg) {
-      if (xmsg->accumRstCount != xLastAccumRst) {
-        xLastAccumRst = xmsg->accumRstCount;
-        for (int i = 0; i < 16; ++i)
-          accumOffset[i] = 0;
-      }
-      if (xmsg->rotFwdCount != xLastRotFwd) {
-        xLastRotFwd = xmsg->rotFwdCount;
-        rotateSequence(+1);
-      }
-      if (xmsg->rotBackCount != xLastRotBack) {
-        xLastRotBack = xmsg->rotBackCount;
-        rotateSequence(-1);
+    // Expander trigger events, every one in the order UZZ-X fired them.
+    // STO / RCL carry the SLOT they saw, 0 when SLOT has no cable.
+    if (xmsg)
+      xEvents.drain(xmsg->events, [&](const ExpanderEvent &e) {
+        const int slot =
+            e.arg ? clamp((int)e.arg - 1, 0, UZZ_NUM_SNAPSHOTS - 1)
+                  : snapshotSlot;
+        switch (e.type) {
+        case UZZX_EV_ACCUM_RST:
+          engine.clearAccumulators();
+          break;
+        case UZZX_EV_ROT_FWD:
+          rotateSequence(+1);
+          break;
+        case UZZX_EV_ROT_BACK:
+          rotateSequence(-1);
+          break;
+        case UZZX_EV_STORE:
+          storeSnapshot(slot);
+          break;
+        case UZZX_EV_RECALL:
+          stageRecall(slot);
+          break;
+        }
+      });
+    if (control) {
+      const bool cvSeed = xmsg && xmsg->seedConnected;
+      const int cvStep =
+          cvSeed ? (int)std::round(clamp(xmsg->seedCv, -10.f, 10.f) * 100.f)
+                 : 0;
+      if (cvSeed != seedFromCv || cvStep != seedCvStep) {
+        seedFromCv = cvSeed;
+        seedCvStep = cvStep;
+        reseed();
       }
     }
-
-    int rel = (step - start + 16) & 15;
-    if (rel >= steps) {
-      rel = rel % steps;
-      step = wrap16(start + rel);
+    if (control)
+      morphAmt = (xmsg && xmsg->morphConnected)
+                     ? std::round(clamp(xmsg->morphCv / 10.f, 0.f, 1.f) *
+                                  1000.f) /
+                           1000.f
+                     : 0.f;
+
+    if (control || snapDirty || engine.trackCount != snapTracks)
+      refreshSnapshot();
+
+    in.reset = rstTrig.process(inputs[RESET_INPUT].getVoltage());
+    if (in.reset && reseedOnReset)
+      reseed();
+    in.slots = chainSlots;
+    in.start = start;
+    in.steps = steps;
+    in.modeDir = clamp(knobs.modeDir + (int)std::round(xcv(UZZX_CV_DIR)),
+                       DIR_MODE_MIN, DIR_MODE_MAX);
+    // Momentary reverse gate from the expander: swap FWD/REV while high.
+    if (xmsg && xmsg->revGate) {
+      if (in.modeDir == DIR_FWD)
+        in.modeDir = DIR_REV;
+      else if (in.modeDir == DIR_REV)
+        in.modeDir = DIR_FWD;
     }
-
-    // Reset
-    if (rstTrig.process(inputs[RESET_INPUT].getVoltage())) {
-      resetPending = true;
-      resetTargetStep = start;
-      playCurrentOnNextTick = true;
-
-      for (int i = 0; i < 16; ++i)
-        accumOffset[i] = 0;
-
-      gatePulse.reset();
-      eocPulse.reset();
-      for (int i = 0; i < 16; ++i)
-        stepGateTrig[i].reset();
-
-      if (eocOnReset)
-        eocPulse.trigger(TRIG_LEN);
-
-      navigator.reset();
-      clock.swingPhase = 0;
-      clock.queuedBaseTicks = 0;
-      clock.tickPending = false;
-      clock.pendingDelay = 0.f;
-      clock.pendingTimer = 0.f;
-      clock.virtTimer = 0.f;
+    in.gateMode = knobs.gateMode;
+    in.pGlobal = clamp(knobs.pGlobal + xcv(UZZX_CV_PROB) / 10.f, 0.f, 1.f);
+    in.accumAmt =
+        clamp(knobs.accumAmt + (int)std::round(xcv(UZZX_CV_ACCUM)), 0, 24);
+    in.accumWrap = knobs.accumWrap;
+    in.addressed = xmsg && xmsg->connected[UZZX_CV_ADDR];
+    in.scan = in.addressed && xmsg->addrScan;
+    in.fill = xmsg && xmsg->fillGate;
+    in.relAddr = 0;
+    if (in.scan) {
+      in.relAddr = addrScan.process(clamp(xcv(UZZX_CV_ADDR), 0.f, 10.f), steps);
+    } else if (in.addressed) {
+      float av = clamp(xcv(UZZX_CV_ADDR), 0.f, 10.f);
+      in.relAddr = (steps > 1) ? clamp((int)std::round(av / 10.f *
+                                                       (float)(steps - 1)),
+                                       0, steps - 1)
+                               : 0;
     }
 
     // Transpose
-    int xposeSemis = 0;
+    in.xposeSemis = 0;
     if (inputs[XPOSE_INPUT].isConnected()) {
       float v = inputs[XPOSE_INPUT].getVoltage();
       if (std::isfinite(v))
-        xposeSemis = clamp((int)std::round(v * 12.f), -48, 48);
+        in.xposeSemis = clamp((int)std::round(v * 12.f), -48, 48);
     }
-
-    if (!clkConnected) {
-      float semis = params[PITCH_PARAMS + step].getValue();
-      int octIv = (int)std::round(params[OCT_PARAMS + step].getValue());
-      int accum = accumOffset[step];
-      float pitchV =
-          ((semis + (float)xposeSemis + (float)accum) / 12.f) + (float)octIv;
-
-      outputs[M1_OUTPUT].setVoltage(UZZRanges::mapMod0_10ToRange(
-          params[M1_PARAMS + step].getValue(), m1Range));
-      outputs[M2_OUTPUT].setVoltage(UZZRanges::mapMod0_10ToRange(
-          params[M2_PARAMS + step].getValue(), m2Range));
-
-      if (wasClkConnected) {
-        hardStop(steps);
+    in.slewAlpha = slewAlpha(args.sampleTime);
+
+    UzzEngine::Output out;
+    engine.process(in, out);
+    const bool recalled = engine.stagedSwapped && applyRecalled();
+    recordCv((out.moved >> editTrack) & 1, control);
+
+    const int tracks = engine.trackCount;
+    // With chords, each track takes `voices` channels of V/OCT and GATE: four
+    // for up to four tracks, as many as fit in 16 beyond that.
+    const int fit = 16 / tracks;
+    const int voices =
+        !chordsOn ? 1 : (fit < UZZ_CHORD_VOICES ? fit : UZZ_CHORD_VOICES);
+    outputs[PITCH_OUTPUT].setChannels(tracks * voices);
+    outputs[GATE_OUTPUT].setChannels(tracks * voices);
+    outputs[M1_OUTPUT].setChannels(tracks);
+    outputs[M2_OUTPUT].setChannels(tracks);
+    for (int t = 0; t < tracks; ++t) {
+      if (voices == 1) {
+        outputs[PITCH_OUTPUT].setVoltage(out.pitch[t], t);
+      } else if (voices == UZZ_CHORD_VOICES) {
+        outputs[PITCH_OUTPUT].setVoltageSimd(out.voices[t], t * voices);
+      } else {
+        for (int v = 0; v < voices; ++v)
+          outputs[PITCH_OUTPUT].setVoltage(out.voices[t][v], t * voices + v);
       }
-      applySlew(pitchV, args.sampleTime);
-      if (updateLights) {
-        for (int i = 0; i < 16; ++i)
-          lights[STEP_LIGHTS + i].setSmoothBrightness(i == step ? 1.f : 0.f,
-                                                      lightDt);
-      }
-      return;
+      outputs[M1_OUTPUT].setVoltage(out.m1[t], t);
+      outputs[M2_OUTPUT].setVoltage(out.m2[t], t);
     }
-
-    // Clock tick
-    if (clockNow) {
-      pulsesRemaining = 0; // cancel ratchet sub-pulses
-
-      // Determine effective pulse mode for the current step
-      // (per-step modes SM_PULSE/SM_GATED/SM_HOLD override the global
-      // pulseMode)
-      auto stepEffMode = [&](int smode) -> int {
-        if (smode == SM_PULSE)
-          return PM_PULSE;
-        if (smode == SM_GATED)
-          return PM_GATED;
-        if (smode == SM_HOLD)
-          return PM_HOLD;
-        return pulseMode;
-      };
-      int curStepMode =
-          (int)std::round(params[STEP_MODE_PARAMS + step].getValue());
-      int effMode = stepEffMode(curStepMode);
-
-      // PM_HOLD / PM_GATED: consume held ticks before advancing to the next
-      // step
-      bool holdFired = false;
-      if ((effMode == PM_HOLD || effMode == PM_GATED) && holdPulsesLeft > 0) {
-        if (resetPending) {
-          holdPulsesLeft = 0; // reset interrupts hold
-        } else {
-          --holdPulsesLeft;
-          if (effMode == PM_HOLD && holdPlaying) {
-            // PM_HOLD: re-fire a gate on each tick
-            int hk = (step - start + 16) & 15;
-            int gateMode = (int)std::round(params[GATE_MODE_PARAM].getValue());
-            float duty =
-                clamp(params[DUR_PARAMS + step].getValue(), 0.01f, 0.95f);
-            float period = clock.getVirtPeriod();
-            float gLen = getGateLength(gateMode, duty, period, args.sampleTime);
-            gatePulse.trigger(gLen);
-            stepGateTrig[hk].trigger(gLen);
-          }
-          // PM_GATED: gate is already running long — nothing to do here
-          holdFired = true;
-        }
-      }
-
-      if (!holdFired) {
-        int modeDir = clamp((int)std::round(params[DIR_MODE_PARAM].getValue()) +
-                                (int)std::round(xcv(UZZX_CV_DIR)),
-                            DIR_MODE_MIN, DIR_MODE_MAX);
-        // Momentary reverse gate from the expander: swap FWD/REV while high.
-        if (xmsg && xmsg->revGate) {
-          if (modeDir == DIR_FWD)
-            modeDir = DIR_REV;
-          else if (modeDir == DIR_REV)
-            modeDir = DIR_FWD;
-        }
-
-        bool allSkip = false;
-        bool wrapped = false;
-        int nextStep;
-        if (xmsg && xmsg->connected[UZZX_CV_ADDR]) {
-          // Absolute step addressing: 0-10 V spans the active window and
-          // bypasses the navigator (skip modes are not consulted). EOC fires
-          // when the address falls back below the previous position.
-          float av = clamp(xcv(UZZX_CV_ADDR), 0.f, 10.f);
-          int relAddr =
-              (steps > 1) ? clamp((int)std::round(av / 10.f * (float)(steps - 1)),
-                                  0, steps - 1)
-                          : 0;
-          int prevRel = (step - start + 16) & 15;
-          nextStep = wrap16(start + relAddr);
-          wrapped = relAddr < prevRel;
-        } else {
-          nextStep = navigator.getNextStep(
-              step, start, steps, modeDir,
-              [this](int idx) {
-                return params[STEP_MODE_PARAMS + idx].getValue();
-              },
-              playCurrentOnNextTick, wrapped, allSkip, jumpN);
-        }
-
-        playCurrentOnNextTick = false;
-        step = nextStep;
-        if (wrapped)
-          eocPulse.trigger(TRIG_LEN);
-
-        bool muteGlobal = false;
-        if (modeDir == DIR_FWD || modeDir == DIR_REV) {
-          muteGlobal = allSkip;
-        } else {
-          bool anyPlayable = false;
-          for (int ki = 0; ki < steps; ++ki) {
-            int sIdx = wrap16(start + ki);
-            if ((int)std::round(params[STEP_MODE_PARAMS + sIdx].getValue()) !=
-                SM_SKIP) {
-              anyPlayable = true;
-              break;
-            }
-          }
-          muteGlobal = !anyPlayable;
-        }
-
-        int mode = (int)std::round(params[STEP_MODE_PARAMS + step].getValue());
-        int k = (step - start + 16) & 15;
-
-        bool resetFiresAfterGate = resetPending;
-        bool playing =
-            !muteGlobal &&
-            (mode == SM_PLAY || mode == SM_ACCUM_UP || mode == SM_ACCUM_DOWN ||
-             mode == SM_PULSE || mode == SM_GATED || mode == SM_HOLD);
-        if (playing) {
-          // Bipolar prob/pulse knob: >=0 = probability, <0 = pulse count
-          float ppVal = params[PROB_PARAMS + step].getValue();
-          float pGlobal =
-              clamp(clamp(params[PROB_GLOBAL_PARAM].getValue(), 0.f, 100.f) /
-                        100.f +
-                        xcv(UZZX_CV_PROB) / 10.f,
-                    0.f, 1.f);
-          // Left side (<=0): probability 0–100%; right side (>0): 100% prob
-          // (right side = pulse count for SM_PULSE/GATED/HOLD).
-          float pStep =
-              (ppVal <= 0.f) ? clamp((100.f + ppVal) / 100.f, 0.f, 1.f) : 1.f;
-          if (pStep * pGlobal < 1.f && random::uniform() >= pStep * pGlobal)
-            playing = false;
-        }
-        if (playing) {
-          if (mode == SM_ACCUM_UP || mode == SM_ACCUM_DOWN) {
-            int amt = clamp((int)std::round(params[ACCUM_AMT_PARAM].getValue()) +
-                                (int)std::round(xcv(UZZX_CV_ACCUM)),
-                            0, 24);
-            int wrap = (int)std::round(params[ACCUM_CLIP_PARAM].getValue());
-            int signedAmt = (mode == SM_ACCUM_UP) ? amt : -amt;
-            int v = accumOffset[step] + signedAmt;
-            if (wrap > 0) {
-              // Módulo sobre el rango configurado alrededor de 0.
-              int span = wrap * 2 + 1;
-              v = ((v + wrap) % span + span) % span - wrap;
-            } else {
-              // Sin wrap configurado: rango completo ±12.
-              static constexpr int ACCUM_RANGE = 25; // -12..+12 inclusive
-              v = ((v + 12) % ACCUM_RANGE + ACCUM_RANGE) % ACCUM_RANGE - 12;
-            }
-            accumOffset[step] = v;
-          }
-
-          int gateMode = (int)std::round(params[GATE_MODE_PARAM].getValue());
-          float duty =
-              clamp(params[DUR_PARAMS + step].getValue(), 0.01f, 0.95f);
-          float period = clock.getVirtPeriod();
-          float gLen = getGateLength(gateMode, duty, period, args.sampleTime);
-
-          // Pulse count: right side (<0) of bipolar knob, only for pulse modes
-          // PLAY/ACCUM always use a single gate regardless of knob position
-          float ppVal = params[PROB_PARAMS + step].getValue();
-          int pulseCount = 1;
-          if (mode == SM_PULSE || mode == SM_GATED || mode == SM_HOLD) {
-            pulseCount =
-                (ppVal > 0.f) ? clamp(1 + (int)std::round(ppVal), 2, 8) : 1;
-          }
-          int newEffMode =
-              stepEffMode(mode); // effective mode for this new step
-
-          if (newEffMode == PM_HOLD) {
-            holdPulsesLeft = pulseCount - 1;
-            holdPlaying = true;
-            gatePulse.trigger(gLen);
-            stepGateTrig[k].trigger(gLen);
-          } else if (newEffMode == PM_GATED && period > 0.f && pulseCount > 1) {
-            // Gate sustained for N clock periods; ends TRIG_LEN before next
-            // tick so the gate goes LOW briefly, allowing retrigger on the next
-            // step
-            float sustainLen =
-                std::max(TRIG_LEN, (float)pulseCount * period - TRIG_LEN);
-            // Same hard upper bound as getGateLength: prevent stuck gates.
-            if (sustainLen > 8.f)
-              sustainLen = 8.f;
-            holdPulsesLeft = pulseCount - 1;
-            holdPlaying = false;
-            gatePulse.trigger(sustainLen);
-            stepGateTrig[k].trigger(sustainLen);
-          } else {
-            // PM_PULSE (or PM_GATED with pulseCount==1): sub-gates within one
-            // period
-            holdPulsesLeft = 0;
-            holdPlaying = false;
-            if (pulseCount > 1 && period > 0.f) {
-              float interval = period / (float)pulseCount;
-              float pGLen = getGateLength(gateMode, duty, period,
-                                          args.sampleTime, interval);
-              pulseInterval = interval;
-              pulseGLen = pGLen;
-              pulseStepK = k;
-              pulsesRemaining = pulseCount - 1;
-              pulseTimer = interval;
-              gatePulse.trigger(pGLen);
-              stepGateTrig[k].trigger(pGLen);
-            } else {
-              gatePulse.trigger(gLen);
-              stepGateTrig[k].trigger(gLen);
-            }
-          }
-        } else {
-          holdPulsesLeft = 0;
-          holdPlaying = false;
-          pulsesRemaining = 0;
-          gatePulse.reset();
-        }
-
-        if (resetFiresAfterGate) {
-          step = resetTargetStep;
-          playCurrentOnNextTick = true;
-          resetPending = false;
-        }
+    if (out.running || out.stopped) {
+      if (voices == 1) {
+        for (int t = 0; t < tracks; ++t)
+          outputs[GATE_OUTPUT].setVoltage(out.gate[t] ? 10.f : 0.f, t);
+      } else {
+        // A voice's gate follows its track's, for the voices the chord has.
+        uint32_t high = 0;
+        for (int t = 0; t < tracks; ++t)
+          if (out.gate[t])
+            high |= ((1u << std::min(out.chordVoices[t], voices)) - 1)
+                    << (t * voices);
+        writePolyGates(outputs[GATE_OUTPUT], high, tracks * voices);
       }
+      // The first 16 window positions; followers carry the rest.
+      const int ownGates = std::min(steps, 16);
+      outputs[STEP_GATES_OUTPUT].setChannels(ownGates);
+      writePolyGates(outputs[STEP_GATES_OUTPUT],
+                     (uint32_t)out.stepGates & 0xFFFF, ownGates);
+      outputs[EOC_OUTPUT].setVoltage(out.eoc ? 10.f : 0.f);
     }
 
-    if (!clockNow && resetPending) {
-      step = resetTargetStep;
-      playCurrentOnNextTick = true;
-      resetPending = false;
+    chainDown.index = (rightModules > 0) ? 1 : 0;
+    if (chainDown.index > 0) {
+      chainDown.slots = chainSlots;
+      chainDown.steps = steps;
+      chainDown.trackCount = tracks;
+      for (int t = 0; t < UZZ_MAX_TRACKS; ++t)
+        chainDown.step[t] = (int8_t)engine.tracks[t].step;
+      chainDown.running = out.running;
+      chainDown.stopped = out.stopped;
+      chainDown.recallSeq = recallSeq;
+      if (out.running || out.stopped)
+        chainDown.stepGates = out.stepGates;
     }
-
-    // Ratchet sub-pulses
-    if (pulsesRemaining > 0) {
-      pulseTimer -= args.sampleTime;
-      if (pulseTimer <= 0.f) {
-        gatePulse.trigger(pulseGLen);
-        stepGateTrig[pulseStepK].trigger(pulseGLen);
-        --pulsesRemaining;
-        pulseTimer += pulseInterval;
-      }
-    }
-
-    // Gate output
-    outputs[GATE_OUTPUT].setVoltage(gatePulse.process(args.sampleTime) ? 10.f
-                                                                       : 0.f);
-
-    // Poly step gates
-    outputs[STEP_GATES_OUTPUT].setChannels(steps);
-    for (int ch = 0; ch < steps; ++ch)
-      outputs[STEP_GATES_OUTPUT].setVoltage(
-          stepGateTrig[ch].process(args.sampleTime) ? 10.f : 0.f, ch);
-
-    // EOC
-    outputs[EOC_OUTPUT].setVoltage(eocPulse.process(args.sampleTime) ? 10.f
-                                                                     : 0.f);
-
-    float semis = params[PITCH_PARAMS + step].getValue();
-    int octIv = (int)std::round(params[OCT_PARAMS + step].getValue());
-    int accum = accumOffset[step];
-    float pitchV =
-        ((semis + (float)xposeSemis + (float)accum) / 12.f) + (float)octIv;
-
-    outputs[M1_OUTPUT].setVoltage(UZZRanges::mapMod0_10ToRange(
-        params[M1_PARAMS + step].getValue(), m1Range));
-    outputs[M2_OUTPUT].setVoltage(UZZRanges::mapMod0_10ToRange(
-        params[M2_PARAMS + step].getValue(), m2Range));
-
-    applySlew(pitchV, args.sampleTime);
+    // A recall's rows go out with the first message carrying its seq.
+    sendChainDown(recalled ? &chainRecall : nullptr);
 
     if (updateLights) {
+      const int ledStep = engine.tracks[editTrack].step;
       for (int i = 0; i < 16; ++i)
-        lights[STEP_LIGHTS + i].setSmoothBrightness(i == step ? 1.f : 0.f,
+        lights[STEP_LIGHTS + i].setSmoothBrightness(i == ledStep ? 1.f : 0.f,
                                                     lightDt);
     }
   }
@@ -1081,6 +1703,11 @@ struct UZZWidget : ModuleWidget {
     setModule(module);
     setPanel(createPanel(asset::plugin(pluginInstance, "res/UZZ.svg")));
 
+    // Connector and separator lines never change: one framebuffer for all.
+    auto *lines = new widget::FramebufferWidget;
+    lines->box.size = box.size;
+    addChild(lines);
+
     const int cols = UI::COLS;
     auto Xc = [&](int i) { return UI::colCenter(box.size.x, i); };
 
@@ -1223,7 +1850,7 @@ struct UZZWidget : ModuleWidget {
         const float dividerX = Xc(0) + 14.f; // port at step 1
         const float lineStart = dividerX + gap;
         if (textLeft > lineStart + 2.f)
-          addChild(new ConnectorLine(lineStart, cy, textLeft, cy));
+          lines->addChild(new ConnectorLine(lineStart, cy, textLeft, cy));
       };
       addInputLabel(yTop, "CLK");
       addInputLabel(yMid, "RESET");
@@ -1246,7 +1873,7 @@ struct UZZWidget : ModuleWidget {
         const float textRight = cx + lblHalfW + gap;
         const float lineEnd = knobX - portR - gap;
         if (lineEnd > textRight + 2.f)
-          addChild(new ConnectorLine(textRight, cy, lineEnd, cy));
+          lines->addChild(new ConnectorLine(textRight, cy, lineEnd, cy));
       };
 
       // RATIO / STEPS / START → aligned with step 3, connector to X_CTRL1
@@ -1292,7 +1919,7 @@ struct UZZWidget : ModuleWidget {
         // Connector helper: from x1 to x2 at height cy (with gap on each side)
         auto seg = [&](float x1, float x2, float cy) {
           if (x2 - gap > x1 + gap)
-            addChild(new ConnectorLine(x1 + gap, cy, x2 - gap, cy));
+            lines->addChild(new ConnectorLine(x1 + gap, cy, x2 - gap, cy));
         };
 
         // SLEW: label(step10) ─── Trimpot(step11) ─── PITCH label(step12)
@@ -1316,7 +1943,7 @@ struct UZZWidget : ModuleWidget {
           const float lineStart = xPitchLbl + (dW * .5f) + gap;
           const float lineEnd = UI::X_OUT1 - 10.f - gap;
           if (lineEnd > lineStart + 2.f)
-            addChild(new ConnectorLine(lineStart, yMid, lineEnd, yMid));
+            lines->addChild(new ConnectorLine(lineStart, yMid, lineEnd, yMid));
         }
 
         // POLY: label(step10) ─── UzzOutputPort(step11)
@@ -1358,6 +1985,24 @@ struct UZZWidget : ModuleWidget {
       addInput(createInputCentered<UzzInputPort>(Vec(Xc(0), yBot), module,
                                                  UZZ::XPOSE_INPUT));
 
+      // CV record: step 16's column, label left of each port.
+      {
+        const float xPort = Xc(15) + 10.f;
+        const float xLbl = Xc(15) - 13.f;
+        auto addRecInput = [&](float cy, const char *text, int inputId) {
+          const float w = 30.f, h = 12.f;
+          auto *lbl =
+              new TextLabel(text, Vec(xLbl - w * .5f, cy - h * .5f), Vec(w, h));
+          lbl->fontSize = 8.f;
+          addChild(lbl);
+          addInput(createInputCentered<UzzInputPort>(Vec(xPort, cy), module,
+                                                     inputId));
+        };
+        addRecInput(yTop, "REC", UZZ::REC_INPUT);
+        addRecInput(yMid, "PITCH", UZZ::REC_PITCH_INPUT);
+        addRecInput(yBot, "MOD", UZZ::REC_MOD_INPUT);
+      }
+
       addOutput(createOutputCentered<UzzOutputPort>(Vec(UI::X_OUT2, yTop),
                                                     module, UZZ::M1_OUTPUT));
       addOutput(createOutputCentered<UzzOutputPort>(Vec(UI::X_OUT2, yMid),
@@ -1376,19 +2021,20 @@ struct UZZWidget : ModuleWidget {
       {
         float x0 = UI::LEFT;
         float x8 = UI::LEFT + 8.f * UI::colW(box.size.x);
-        addChild(new ConnectorLine(0.f, ySep1, x8, ySep1, 80));
-        addChild(new ConnectorLine(x0, ySep2, x8, ySep2, 80));
+        lines->addChild(new ConnectorLine(0.f, ySep1, x8, ySep1, 80));
+        lines->addChild(new ConnectorLine(x0, ySep2, x8, ySep2, 80));
 
         float x10 = UI::LEFT + 9.f * UI::colW(box.size.x);
         float x15 = UI::LEFT + 15.f * UI::colW(box.size.x);
-        addChild(new ConnectorLine(x10, ySep1, x15, ySep1, 80));
-        addChild(new ConnectorLine(x10, ySep2, x15, ySep2, 80));
+        lines->addChild(new ConnectorLine(x10, ySep1, x15, ySep1, 80));
+        lines->addChild(new ConnectorLine(x10, ySep2, x15, ySep2, 80));
       }
 
       // Vertical separator between POLY output and EOC label
       {
         float xMid = (UI::X_SWITCH + Xc(11)) * .5f;
-        addChild(new ConnectorLine(xMid, yBot - 12.f, xMid, yBot + 12.f, 80));
+        lines->addChild(
+            new ConnectorLine(xMid, yBot - 12.f, xMid, yBot + 12.f, 80));
       }
     }
 
@@ -1410,23 +2056,182 @@ struct UZZWidget : ModuleWidget {
                                           UZZ::SLEW_PARAM));
   }
 
+  // UI-thread time spent building this panel's drawing, both layers, averaged
+  // over recent frames ("Panel draw time" in the menu). The GPU work comes
+  // later, when Rack ends the frame, and is not included.
+  double drawAccum = 0.0;
+  double drawTime = 0.0;
+
+  void step() override {
+    drawTime += 0.05 * (drawAccum - drawTime);
+    drawAccum = 0.0;
+    ModuleWidget::step();
+  }
+
+  void draw(const DrawArgs &args) override {
+    const double t0 = system::getTime();
+    ModuleWidget::draw(args);
+    drawAccum += system::getTime() - t0;
+  }
+
+  void drawLayer(const DrawArgs &args, int layer) override {
+    const double t0 = system::getTime();
+    ModuleWidget::drawLayer(args, layer);
+    drawAccum += system::getTime() - t0;
+  }
+
   void appendContextMenu(ui::Menu *menu) override {
     ModuleWidget::appendContextMenu(menu);
     auto *m = dynamic_cast<UZZ *>(module);
 
-
     menu->addChild(new ui::MenuSeparator());
+    menu->addChild(createSubmenuItem(
+        "Tracks (poly channels)", m ? string::f("%d", m->engine.trackCount) : "",
+        [m](ui::Menu *sub) {
+          for (int n = 1; n <= UZZ_MAX_TRACKS; ++n) {
+            sub->addChild(createCheckMenuItem(
+                string::f("%d", n).c_str(), "",
+                [m, n]() { return m && m->engine.trackCount == n; },
+                [m, n]() {
+                  if (m)
+                    m->post(UZZ::CMD_TRACK_COUNT, n);
+                }));
+          }
+        }));
+    menu->addChild(createSubmenuItem(
+        "Edit track (panel)", m ? string::f("%d", m->editTrack + 1) : "",
+        [m](ui::Menu *sub) {
+          for (int t = 0; m && t < m->engine.trackCount; ++t) {
+            sub->addChild(createCheckMenuItem(
+                string::f("Track %d", t + 1).c_str(), "",
+                [m, t]() { return m->editTrack == t; },
+                [m, t]() { m->post(UZZ::CMD_EDIT_TRACK, t); }));
+          }
+        }));
     menu->addChild(createCheckMenuItem(
-        "EOC on reset", "", [m]() { return m && m->eocOnReset; },
+        "EOC on reset", "", [m]() { return m && m->engine.eocOnReset; },
         [m]() {
           if (m)
-            m->eocOnReset = !m->eocOnReset;
+            m->post(UZZ::CMD_EOC_ON_RESET, !m->engine.eocOnReset);
+        }));
+    menu->addChild(createCheckMenuItem(
+        "Phase-locked RATIO", "",
+        [m]() { return m && m->engine.clock.pllMode; },
+        [m]() {
+          if (m)
+            m->post(UZZ::CMD_PHASE_LOCK, !m->engine.clock.pllMode);
+        }));
+    menu->addChild(createCheckMenuItem(
+        "Chain to UZZ on the left", "", [m]() { return m && m->chainFollow; },
+        [m]() {
+          if (m)
+            m->post(UZZ::CMD_CHAIN_FOLLOW, !m->chainFollow);
+        }));
+    menu->addChild(createSubmenuItem(
+        "CV record",
+        m ? (m->recMode == UZZ::REC_CONTINUOUS ? "Continuous" : "On step") : "",
+        [m](ui::Menu *sub) {
+          static const char *const names[] = {"On step", "Continuous"};
+          for (int r = UZZ::REC_ON_STEP; r <= UZZ::REC_CONTINUOUS; ++r) {
+            sub->addChild(createCheckMenuItem(
+                names[r], "", [m, r]() { return m && m->recMode == r; },
+                [m, r]() {
+                  if (m)
+                    m->post(UZZ::CMD_REC_MODE, r);
+                }));
+          }
+        }));
+    menu->addChild(createSubmenuItem(
+        "Groove", m ? UZZ_GROOVES[m->groove].name : "", [m](ui::Menu *sub) {
+          for (int g = 0; g < UZZ_NUM_GROOVES; ++g) {
+            sub->addChild(createCheckMenuItem(
+                UZZ_GROOVES[g].name, "",
+                [m, g]() { return m && m->groove == g; },
+                [m, g]() {
+                  if (m)
+                    m->post(UZZ::CMD_GROOVE, g);
+                }));
+          }
+        }));
+    menu->addChild(createSubmenuItem(
+        "Micro-timing (edit track)", "", [m](ui::Menu *sub) {
+          if (!m)
+            return;
+          for (int i = 0; i < 16; ++i)
+            sub->addChild(new MicroTimingSlider(m, i));
+          sub->addChild(createMenuItem(
+              "Clear", "", [m]() { m->post(UZZ::CMD_MICRO_CLEAR); }));
         }));
+    menu->addChild(createSubmenuItem(
+        "Random seed",
+        m ? (m->seedFromCv ? std::string("CV")
+                           : string::f("%08X", (unsigned)(m->seed & 0xFFFFFFFF)))
+          : "",
+        [m](ui::Menu *sub) {
+          if (!m)
+            return;
+          sub->addChild(createCheckMenuItem(
+              "Reseed on RESET", "", [m]() { return m->reseedOnReset; },
+              [m]() { m->post(UZZ::CMD_RESEED_ON_RESET, !m->reseedOnReset); }));
+          sub->addChild(createMenuItem(
+              "Restart from seed", "",
+              [m]() { m->post(UZZ::CMD_RESTART_SEED); }));
+          sub->addChild(createMenuItem("New seed", "",
+                                       [m]() { m->post(UZZ::CMD_NEW_SEED); }));
+        }));
+    menu->addChild(createSubmenuItem(
+        "Latency probe", m ? (m->engine.probe ? "On" : "Off") : "",
+        [m](ui::Menu *sub) {
+          if (!m)
+            return;
+          sub->addChild(createCheckMenuItem(
+              "Enabled", "", [m]() { return m->engine.probe != nullptr; },
+              [m]() { m->post(UZZ::CMD_LATENCY, !m->engine.probe); }));
+          if (!m->engine.probe)
+            return;
+          // A snapshot: the audio thread keeps writing the probe.
+          std::shared_ptr<UzzLatencyLog> p = std::make_shared<UzzLatencyLog>();
+          if (!m->latency.snapshot(*p)) {
+            sub->addChild(createMenuLabel("Busy, reopen to read"));
+            return;
+          }
+          sub->addChild(createMenuLabel(
+              string::f("%u edges (%u without tick), %u ticks", p->edges,
+                        p->unclaimed, p->ticks)));
+          sub->addChild(createMenuLabel("CLK to tick: " +
+                                        p->describe(p->edgeToTick)));
+          sub->addChild(createMenuLabel("Tick to gate: " +
+                                        p->describe(p->tickToGate)));
+          sub->addChild(createMenuLabel("CLK to gate: " +
+                                        p->describe(p->edgeToGate)));
+          sub->addChild(createMenuItem("Save log as CSV...", "", [p]() {
+            char *path = osdialog_file(OSDIALOG_SAVE, asset::user("").c_str(),
+                                       "uzz-latency.csv", NULL);
+            if (!path)
+              return;
+            FILE *f = std::fopen(path, "w");
+            std::free(path);
+            if (!f) {
+              osdialog_message(OSDIALOG_WARNING, OSDIALOG_OK,
+                               "Could not write the latency log.");
+              return;
+            }
+            std::fputs(p->csv().c_str(), f);
+            std::fclose(f);
+          }));
+          sub->addChild(createMenuItem("Copy log as CSV", "", [p]() {
+            glfwSetClipboardString(APP->window->win, p->csv().c_str());
+          }));
+          sub->addChild(createMenuItem(
+              "Clear", "", [m]() { m->post(UZZ::CMD_LATENCY_CLEAR); }));
+        }));
+    menu->addChild(createMenuLabel(
+        string::f("Panel draw time: %.3f ms", drawTime * 1000.0)));
 
     menu->addChild(createSubmenuItem("Direction mode", "", [m](ui::Menu *sub) {
       for (int i = DIR_MODE_MIN; i <= DIR_MODE_MAX; ++i) {
         std::string lbl = (i == DIR_JUMP && m)
-                              ? string::f("Jump \xc3\xb7%d", m->jumpN)
+                              ? string::f("Jump \xc3\xb7%d", m->engine.jumpN)
                               : dirLabel(i);
         sub->addChild(createCheckMenuItem(
             lbl.c_str(), "",
@@ -1437,28 +2242,22 @@ struct UZZWidget : ModuleWidget {
                          m->params[UZZ::DIR_MODE_PARAM].getValue()) == i;
             },
             [m, i]() {
-              if (!m)
-                return;
-              m->params[UZZ::DIR_MODE_PARAM].setValue((float)i);
-              m->navigator.pingDir = 0;
-              m->navigator.drunkDir = 1;
-              m->navigator.seqPos = 0;
+              if (m)
+                m->post(UZZ::CMD_DIRECTION, i);
             }));
       }
     }));
 
     menu->addChild(createSubmenuItem(
-        "Jump stride", m ? string::f("\xc3\xb7%d", m->jumpN) : "",
+        "Jump stride", m ? string::f("\xc3\xb7%d", m->engine.jumpN) : "",
         [m](ui::Menu *sub) {
           for (int n = 2; n <= 7; ++n) {
             sub->addChild(createCheckMenuItem(
                 string::f("\xc3\xb7%d", n).c_str(), "",
-                [m, n]() { return m && m->jumpN == n; },
+                [m, n]() { return m && m->engine.jumpN == n; },
                 [m, n]() {
-                  if (m) {
-                    m->jumpN = n;
-                    m->navigator.seqPos = 0;
-                  }
+                  if (m)
+                    m->post(UZZ::CMD_JUMP_STRIDE, n);
                 }));
           }
         }));
@@ -1474,26 +2273,147 @@ struct UZZWidget : ModuleWidget {
             lbl, "", [m, s]() { return m && m->pitchRangeSemis == s; },
             [m, s]() {
               if (m)
-                m->setPitchRange(s);
+                m->post(UZZ::CMD_PITCH_RANGE, s);
             }));
       }
     }));
 
-    auto addRangeMenu = [&](const char *label, int *rangePtr) {
-      menu->addChild(createSubmenuItem(label, "", [m, rangePtr](ui::Menu *sub) {
-        for (int r = 0; r < UZZRanges::MR_COUNT; ++r) {
-          sub->addChild(createCheckMenuItem(
-              UZZRanges::RANGE_DEFS[r].label, "",
-              [m, rangePtr, r]() { return m && *rangePtr == r; },
-              [m, rangePtr, r]() {
-                if (m)
-                  *rangePtr = r;
-              }));
-        }
-      }));
+    menu->addChild(createSubmenuItem(
+        "Scale", m ? UZZ_SCALES[m->engine.scale.scale].name : "",
+        [m](ui::Menu *sub) {
+          for (int k = 0; k < UZZ_NUM_SCALES; ++k) {
+            sub->addChild(createCheckMenuItem(
+                UZZ_SCALES[k].name, "",
+                [m, k]() { return m && m->engine.scale.scale == k; },
+                [m, k]() {
+                  if (m)
+                    m->post(UZZ::CMD_SCALE, k);
+                }));
+          }
+        }));
+    menu->addChild(createSubmenuItem(
+        "Scale root", m ? UZZ_NOTE_NAMES[m->engine.scale.root] : "",
+        [m](ui::Menu *sub) {
+          for (int r = 0; r < 12; ++r) {
+            sub->addChild(createCheckMenuItem(
+                UZZ_NOTE_NAMES[r], "",
+                [m, r]() { return m && m->engine.scale.root == r; },
+                [m, r]() {
+                  if (m)
+                    m->post(UZZ::CMD_SCALE_ROOT, r);
+                }));
+          }
+        }));
+    menu->addChild(createSubmenuItem(
+        "Chords (edit track)", "", [m](ui::Menu *sub) {
+          if (!m)
+            return;
+          for (int i = 0; i < 16; ++i) {
+            sub->addChild(createSubmenuItem(
+                string::f("Step %d", i + 1),
+                UZZ_CHORDS[m->chord[m->editTrack][i]].name,
+                [m, i](ui::Menu *chords) {
+                  for (int c = 0; c < UZZ_NUM_CHORDS; ++c) {
+                    chords->addChild(createCheckMenuItem(
+                        UZZ_CHORDS[c].name, "",
+                        [m, i, c]() {
+                          return m->chord[m->editTrack][i] == c;
+                        },
+                        [m, i, c]() { m->post(UZZ::CMD_CHORD, (i << 8) | c); }));
+                  }
+                }));
+          }
+          sub->addChild(createMenuItem(
+              "Clear", "", [m]() { m->post(UZZ::CMD_CHORD_CLEAR); }));
+        }));
+    menu->addChild(createSubmenuItem(
+        "Trig conditions (edit track)", "", [m](ui::Menu *sub) {
+          if (!m)
+            return;
+          for (int i = 0; i < 16; ++i) {
+            sub->addChild(createSubmenuItem(
+                string::f("Step %d", i + 1),
+                uzzCondName(m->cond[m->editTrack][i]),
+                [m, i](ui::Menu *conds) {
+                  auto addCond = [m, i](ui::Menu *into, int c) {
+                    into->addChild(createCheckMenuItem(
+                        uzzCondName(c), "",
+                        [m, i, c]() { return m->cond[m->editTrack][i] == c; },
+                        [m, i, c]() { m->post(UZZ::CMD_COND, (i << 8) | c); }));
+                  };
+                  for (int c = 0; c < UZZ_COND_RATIO_BASE; ++c)
+                    addCond(conds, c);
+                  for (int b = 2; b <= UZZ_COND_MAX_B; ++b) {
+                    conds->addChild(createSubmenuItem(
+                        string::f("A:%d", b), "",
+                        [addCond, b](ui::Menu *ratios) {
+                          for (int a = 1; a <= b; ++a)
+                            addCond(ratios, uzzCondRatio(a, b));
+                        }));
+                  }
+                }));
+          }
+          sub->addChild(createMenuItem(
+              "Clear", "", [m]() { m->post(UZZ::CMD_COND_CLEAR); }));
+        }));
+
+    auto addRangeMenu = [&](const char *label, int *rangePtr, int cmd) {
+      menu->addChild(
+          createSubmenuItem(label, "", [m, rangePtr, cmd](ui::Menu *sub) {
+            for (int r = 0; r < UZZRanges::MR_COUNT; ++r) {
+              sub->addChild(createCheckMenuItem(
+                  UZZRanges::RANGE_DEFS[r].label, "",
+                  [m, rangePtr, r]() { return m && *rangePtr == r; },
+                  [m, cmd, r]() {
+                    if (m)
+                      m->post(cmd, r);
+                  }));
+            }
+          }));
     };
-    addRangeMenu("Range Mod 1", &m->m1Range);
-    addRangeMenu("Range Mod 2", &m->m2Range);
+    addRangeMenu("Range Mod 1", &m->m1Range, UZZ::CMD_M1_RANGE);
+    addRangeMenu("Range Mod 2", &m->m2Range, UZZ::CMD_M2_RANGE);
+
+    menu->addChild(new ui::MenuSeparator());
+    menu->addChild(createSubmenuItem(
+        "Snapshots", m ? string::f("%d", m->snapshotSlot + 1) : "",
+        [m](ui::Menu *sub) {
+          if (!m)
+            return;
+          auto slotLabel = [m](int s) {
+            return string::f("Slot %d%s", s + 1,
+                             m->snapshots[s].used ? "" : " (empty)");
+          };
+          sub->addChild(createSubmenuItem("Store to", "", [m, slotLabel](
+                                                              ui::Menu *sm) {
+            for (int s = 0; s < UZZ_NUM_SNAPSHOTS; ++s)
+              sm->addChild(createMenuItem(
+                  slotLabel(s), "", [m, s]() { m->post(UZZ::CMD_SNAP_STORE, s); }));
+          }));
+          sub->addChild(createSubmenuItem("Recall", "", [m](ui::Menu *sm) {
+            for (int s = 0; s < UZZ_NUM_SNAPSHOTS; ++s)
+              if (m->snapshots[s].used)
+                sm->addChild(createCheckMenuItem(
+                    string::f("Slot %d", s + 1), "",
+                    [m, s]() { return m->snapshotSlot == s; },
+                    [m, s]() { m->post(UZZ::CMD_SNAP_RECALL, s); }));
+          }));
+          sub->addChild(createSubmenuItem("Clear", "", [m](ui::Menu *sm) {
+            for (int s = 0; s < UZZ_NUM_SNAPSHOTS; ++s)
+              if (m->snapshots[s].used)
+                sm->addChild(
+                    createMenuItem(string::f("Slot %d", s + 1), "",
+                                   [m, s]() { m->post(UZZ::CMD_SNAP_CLEAR, s); }));
+          }));
+          sub->addChild(createSubmenuItem(
+              "Morph target", string::f("%d", m->morphSlot + 1),
+              [m, slotLabel](ui::Menu *sm) {
+                for (int s = 0; s < UZZ_NUM_SNAPSHOTS; ++s)
+                  sm->addChild(createCheckMenuItem(
+                      slotLabel(s), "", [m, s]() { return m->morphSlot == s; },
+                      [m, s]() { m->post(UZZ::CMD_MORPH_TARGET, s); }));
+              }));
+        }));
   }
 };
 
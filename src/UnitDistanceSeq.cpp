@@ -1,4 +1,5 @@
 #include "plugin.hpp"
+#include "PulseBank.hpp"
 #include "ui/CommonWidgets.hpp"
 
 #include <array>
@@ -87,7 +88,7 @@ struct UnitDistanceSeq : Module {
 
     dsp::SchmittTrigger clockTrigger;
     dsp::SchmittTrigger resetTrigger;
-    std::array<dsp::PulseGenerator, MAX_POLY_VOICES> gatePulses;
+    PulseBank<MAX_POLY_VOICES> gatePulses;
     dsp::PulseGenerator clockPulse;
     dsp::ClockDivider graphDivider;
 
@@ -699,7 +700,7 @@ struct UnitDistanceSeq : Module {
             fireGates[v] = shouldFireGate(voiceNodes[v], v);
             if (fireGates[v]) {
                 float gateLen = clamp(params[GATE_LENGTH_PARAM].getValue(), 0.05f, 0.95f) * clockPeriod;
-                gatePulses[v].trigger(clamp(gateLen, 0.001f, 2.f));
+                gatePulses.trigger(v, clamp(gateLen, 0.001f, 2.f));
             }
         }
         recordStep(fireGates);
@@ -724,7 +725,7 @@ struct UnitDistanceSeq : Module {
             for (int v = 0; v < polyVoices; ++v) {
                 if (step.gates[v % lockedVoices]) {
                     float gateLen = clamp(params[GATE_LENGTH_PARAM].getValue(), 0.05f, 0.95f) * clockPeriod;
-                    gatePulses[v].trigger(clamp(gateLen, 0.001f, 2.f));
+                    gatePulses.trigger(v, clamp(gateLen, 0.001f, 2.f));
                 }
             }
         }
@@ -742,7 +743,7 @@ struct UnitDistanceSeq : Module {
                 fireGates[v] = shouldFireGate(voiceNodes[v], v);
                 if (fireGates[v]) {
                     float gateLen = clamp(params[GATE_LENGTH_PARAM].getValue(), 0.05f, 0.95f) * clockPeriod;
-                    gatePulses[v].trigger(clamp(gateLen, 0.001f, 2.f));
+                    gatePulses.trigger(v, clamp(gateLen, 0.001f, 2.f));
                 }
             }
             recordStep(fireGates);
@@ -804,8 +805,7 @@ struct UnitDistanceSeq : Module {
                 resetPolyVoices();
             }
             updateAllVoiceOutputs();
-            for (int v = 0; v < MAX_POLY_VOICES; ++v)
-                gatePulses[v].reset();
+            gatePulses.reset();
         }
 
         if (clockTrigger.process(inputs[CLOCK_INPUT].getVoltage())) {
@@ -819,9 +819,7 @@ struct UnitDistanceSeq : Module {
             }
         }
 
-        std::array<bool, MAX_POLY_VOICES> gateHigh = {};
-        for (int v = 0; v < MAX_POLY_VOICES; ++v)
-            gateHigh[v] = gatePulses[v].process(args.sampleTime);
+        const uint32_t gateHigh = gatePulses.process(args.sampleTime);
         bool clockHigh = clockPulse.process(args.sampleTime);
         const GraphNode& node = graphNodes[currentNode];
 
@@ -832,14 +830,14 @@ struct UnitDistanceSeq : Module {
         outputs[Y_OUTPUT].setChannels(polyVoices);
         for (int v = 0; v < polyVoices; ++v) {
             outputs[VOCT_OUTPUT].setVoltage(voicePitchVolts[v], v);
-            outputs[GATE_OUTPUT].setVoltage(gateHigh[v] ? 10.f : 0.f, v);
             outputs[ACCENT_OUTPUT].setVoltage(voiceAccentVolts[v], v);
             outputs[X_OUTPUT].setVoltage(voiceXVolts[v], v);
             outputs[Y_OUTPUT].setVoltage(voiceYVolts[v], v);
         }
+        writePolyGates(outputs[GATE_OUTPUT], gateHigh, polyVoices);
 
         lights[CLOCK_LIGHT].setBrightnessSmooth(clockHigh ? 1.f : 0.f, args.sampleTime);
-        lights[GATE_LIGHT].setBrightnessSmooth(gateHigh[0] ? 1.f : 0.f, args.sampleTime);
+        lights[GATE_LIGHT].setBrightnessSmooth((gateHigh & 1) ? 1.f : 0.f, args.sampleTime);
         lights[ACTIVITY_LIGHTS + 0].setBrightnessSmooth(node.nx > 0.50f ? 1.f : 0.05f, args.sampleTime);
         lights[ACTIVITY_LIGHTS + 1].setBrightnessSmooth(node.ny > 0.50f ? 1.f : 0.05f, args.sampleTime);
         lights[ACTIVITY_LIGHTS + 2].setBrightnessSmooth(graphHasEdges ? 1.f : 0.05f, args.sampleTime);
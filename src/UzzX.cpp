@@ -1,5 +1,7 @@
 #include "plugin.hpp"
 #include "ui/CommonWidgets.hpp"
+#include "uzz/UzzChain.hpp"
+#include "uzz/UzzSnapshots.hpp"
 
 using AnimatekUI::TextLabel;
 
@@ -8,8 +10,12 @@ using AnimatekUI::TextLabel;
 // CV inputs are bipolar offsets around the corresponding UZZ knob; ROT +/-
 // triggers rotate the whole sequence one step (wrapping) within the active
 // window; RST clears accumulators; REV reverses direction while its gate is
-// high. Events travel to UZZ as monotonic counters so no trigger is lost or
-// double-fired regardless of engine ordering.
+// high; SLOT / RCL / STO / MORPH drive UZZ's pattern snapshots and SEED its
+// random seed; FILL is the fill state of UZZ's trig conditions. With "ADDR
+// scan" on, ADDR picks UZZ's step every sample instead of on clock ticks.
+// Triggers travel to UZZ as a log of timestamped events over the shared
+// expander transport (ExpanderLink.hpp), so a burst is replayed in full, one
+// sample later, whatever the engine ordering.
 // ============================================================================
 
 struct UzzX : Module {
@@ -20,14 +26,23 @@ struct UzzX : Module {
         ACCUM_RST_INPUT,
         ROT_FWD_INPUT,
         ROT_BACK_INPUT,
+        // Appended: snapshots
+        SLOT_INPUT,
+        RECALL_INPUT,
+        STORE_INPUT,
+        MORPH_INPUT,
+        SEED_INPUT,
+        FILL_INPUT,
         NUM_INPUTS
     };
     enum OutputIds { NUM_OUTPUTS };
     enum LightIds { LINK_LIGHT, NUM_LIGHTS };
 
-    UzzExpMsg msg;
+    ExpanderEvents<16> events;
+    bool addrScan = false; // menu option, passed on to UZZ
     dsp::SchmittTrigger rstTrig;
     dsp::SchmittTrigger rotFwdTrig, rotBackTrig;
+    dsp::SchmittTrigger recallTrig, storeTrig;
     dsp::ClockDivider lightDivider;
 
     UzzX() {
@@ -49,31 +64,77 @@ struct UzzX : Module {
         configInput(ACCUM_RST_INPUT, "Accumulator reset (trig)");
         configInput(ROT_FWD_INPUT, "Rotate sequence forward (trig)");
         configInput(ROT_BACK_INPUT, "Rotate sequence backward (trig)");
+        configInput(SLOT_INPUT, "Snapshot slot (0-10V over 32 slots)");
+        configInput(RECALL_INPUT, "Recall snapshot on next step (trig)");
+        configInput(STORE_INPUT, "Store snapshot (trig)");
+        configInput(MORPH_INPUT, "Morph toward target snapshot (0-10V)");
+        configInput(SEED_INPUT, "Random seed (10mV steps)");
+        configInput(FILL_INPUT, "Fill (gate)");
     }
 
     void process(const ProcessArgs& args) override {
-        for (int i = 0; i < UZZX_NUM_CVS; ++i) {
-            bool con = inputs[CV_INPUTS + i].isConnected();
-            float v = con ? inputs[CV_INPUTS + i].getVoltage() : 0.f;
-            msg.connected[i] = con;
-            msg.cv[i] = std::isfinite(v) ? v : 0.f;
-        }
-        msg.revGate = inputs[REV_INPUT].getVoltage() >= 1.f;
+        // Triggers are logged whether or not UZZ is there; UZZ adopts the log
+        // without replaying it when it links.
         if (rstTrig.process(inputs[ACCUM_RST_INPUT].getVoltage()))
-            ++msg.accumRstCount;
+            events.push(UZZX_EV_ACCUM_RST, args.frame);
         if (rotFwdTrig.process(inputs[ROT_FWD_INPUT].getVoltage()))
-            ++msg.rotFwdCount;
+            events.push(UZZX_EV_ROT_FWD, args.frame);
         if (rotBackTrig.process(inputs[ROT_BACK_INPUT].getVoltage()))
-            ++msg.rotBackCount;
-
-        bool linked =
-            rightExpander.module && rightExpander.module->model == modelUZZ;
-        if (linked)
-            rightExpander.module->leftExpander.consumerMessage = &msg;
+            events.push(UZZX_EV_ROT_BACK, args.frame);
+        // STO / RCL carry the slot SLOT points at right now, plus one; 0
+        // leaves the choice to UZZ.
+        const int slotArg =
+            inputs[SLOT_INPUT].isConnected()
+                ? 1 + clamp((int)std::round(inputs[SLOT_INPUT].getVoltage() /
+                                            10.f *
+                                            (float)(UZZ_NUM_SNAPSHOTS - 1)),
+                            0, UZZ_NUM_SNAPSHOTS - 1)
+                : 0;
+        if (recallTrig.process(inputs[RECALL_INPUT].getVoltage()))
+            events.push(UZZX_EV_RECALL, args.frame, slotArg);
+        if (storeTrig.process(inputs[STORE_INPUT].getVoltage()))
+            events.push(UZZX_EV_STORE, args.frame, slotArg);
+
+        ExpanderOutbox<UzzLeftMsg> out(this, true, modelUZZ);
+        if (out) {
+            UzzExpMsg& msg = out->uzzx;
+            for (int i = 0; i < UZZX_NUM_CVS; ++i) {
+                bool con = inputs[CV_INPUTS + i].isConnected();
+                float v = con ? inputs[CV_INPUTS + i].getVoltage() : 0.f;
+                msg.connected[i] = con;
+                msg.cv[i] = std::isfinite(v) ? v : 0.f;
+            }
+            msg.revGate = inputs[REV_INPUT].getVoltage() >= 1.f;
+            msg.fillGate = inputs[FILL_INPUT].getVoltage() >= 1.f;
+            auto readCv = [&](int id, float& v, bool& con) {
+                con = inputs[id].isConnected();
+                v = con ? inputs[id].getVoltage() : 0.f;
+                if (!std::isfinite(v))
+                    v = 0.f;
+            };
+            readCv(MORPH_INPUT, msg.morphCv, msg.morphConnected);
+            readCv(SEED_INPUT, msg.seedCv, msg.seedConnected);
+            msg.addrScan = addrScan;
+            msg.events = events;
+            out.send();
+        }
+        const bool linked = (bool)out;
         if (lightDivider.process())
             lights[LINK_LIGHT].setBrightness(linked ? 1.f : 0.f);
     }
 
+    void onReset() override { addrScan = false; }
+
+    json_t* dataToJson() override {
+        json_t* rootJ = json_object();
+        json_object_set_new(rootJ, "addrScan", json_boolean(addrScan));
+        return rootJ;
+    }
+
+    void dataFromJson(json_t* rootJ) override {
+        json_t* j = json_object_get(rootJ, "addrScan");
+        addrScan = j && json_boolean_value(j);
+    }
 };
 
 struct UzzXWidget : ModuleWidget {
@@ -101,9 +162,10 @@ struct UzzXWidget : ModuleWidget {
             label->fontSize = 7.f;
             addChild(label);
         };
+        // Nine rows at 11.3 mm keep the last one clear of the logo.
         auto addJack = [&](const char* text, float cx, int row, int inputId) {
-            float labelY = 14.0f + 17.2f * (float)row;
-            float portY = 21.0f + 17.2f * (float)row;
+            float labelY = 14.0f + 11.3f * (float)row;
+            float portY = 21.0f + 11.3f * (float)row;
             addLabel(text, cx, labelY);
             addInput(createInputCentered<AnimatekUI::TekInputPort>(
                 mm2px(Vec(cx, portY)), module, inputId));
@@ -121,10 +183,21 @@ struct UzzXWidget : ModuleWidget {
         addJack("ROT +", X2, 4, UzzX::ROT_FWD_INPUT);
         addJack("RST", X1, 5, UzzX::ACCUM_RST_INPUT);
         addJack("REV", X2, 5, UzzX::REV_INPUT);
+        addJack("SLOT", X1, 6, UzzX::SLOT_INPUT);
+        addJack("MORPH", X2, 6, UzzX::MORPH_INPUT);
+        addJack("RCL", X1, 7, UzzX::RECALL_INPUT);
+        addJack("STO", X2, 7, UzzX::STORE_INPUT);
+        addJack("SEED", X1, 8, UzzX::SEED_INPUT);
+        addJack("FILL", X2, 8, UzzX::FILL_INPUT);
     }
 
     void appendContextMenu(ui::Menu* menu) override {
         ModuleWidget::appendContextMenu(menu);
+        UzzX* m = dynamic_cast<UzzX*>(module);
+        if (!m)
+            return;
+        menu->addChild(new ui::MenuSeparator());
+        menu->addChild(createBoolPtrMenuItem("ADDR scan (audio rate)", "", &m->addrScan));
     }
 };
 
@@ -1,6 +1,6 @@
 #pragma once
 #include <rack.hpp>
-
+#include "ExpanderLink.hpp"
 
 using namespace rack;
 
@@ -35,13 +35,33 @@ enum UzzXCvIds {
     UZZX_NUM_CVS
 };
 
+// UZZ-X trigger events; UZZ runs every one of them, in order.
+enum UzzXEventType {
+    UZZX_EV_ACCUM_RST, // clear the accumulators
+    UZZX_EV_ROT_FWD,   // rotate whole sequence +1 step (wraps)
+    UZZX_EV_ROT_BACK,  // rotate whole sequence -1 step (wraps)
+    UZZX_EV_RECALL,    // recall the slot on the next step
+    UZZX_EV_STORE      // store the current pattern in the slot
+};
+
 struct UzzExpMsg {
     float cv[UZZX_NUM_CVS] = {};
     bool connected[UZZX_NUM_CVS] = {};
     bool revGate = false;          // momentary direction reverse while high
-    uint32_t accumRstCount = 0;    // event counters: UZZ acts on increments
-    uint32_t rotFwdCount = 0;      // rotate whole sequence +1 step (wraps)
-    uint32_t rotBackCount = 0;     // rotate whole sequence -1 step (wraps)
+    // UzzXEventType. RCL / STO carry 1 + the slot SLOT (0-10 V over the 32
+    // slots) pointed at when they fired, or 0 while SLOT has no cable.
+    ExpanderEvents<16> events;
+    // MORPH (0-10 V) crossfades toward the morph target snapshot.
+    float morphCv = 0.f;
+    bool morphConnected = false;
+    // Random seed in 10 mV steps (±10 V); replaces the stored seed while
+    // patched.
+    float seedCv = 0.f;
+    bool seedConnected = false;
+    // ADDR scan (UZZ-X menu): ADDR picks the step every sample, clock or not.
+    bool addrScan = false;
+    // FILL gate: steps with the FILL / NOT FILL trig conditions follow it.
+    bool fillGate = false;
 };
 
 // Declare the Plugin, defined in plugin.cpp
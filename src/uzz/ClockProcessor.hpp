@@ -1,6 +1,164 @@
 #pragma once
 
-#include "../plugin.hpp"
+#include "UzzRack.hpp"
+
+// Phase-locked clock multiplier/divider. Keeps a continuous estimate of the
+// input period and of the phase inside the current input cycle, timestamps
+// edges between samples, and corrects part of the phase error on each edge
+// instead of restarting at it. Output ticks fall where the locked phase
+// crosses multiples of 1/ratio, so ×N ticks are evenly spaced and tick 0 of
+// every group sits on an input edge.
+struct ClockPll {
+  static constexpr float THRESHOLD = 2.f; // ClockProcessor's Schmitt high level
+  static constexpr float MIN_PERIOD = 0.002f;
+  static constexpr float MAX_PERIOD = 5.f;
+  static constexpr float SMOOTHING = 0.25f;  // weight of a new interval
+  static constexpr float TOLERANCE = 1.35f;  // outside [1/x, x] = outlier
+  static constexpr float PHASE_GAIN = 0.5f;  // share of phase error fixed per edge
+  static constexpr float LOCK_WINDOW = 0.2f; // larger errors (cycles) re-sync hard
+  // Share of the phase error turned into a period correction, so a steady
+  // tempo ramp is followed without a standing phase lag.
+  static constexpr float FREQ_GAIN = 0.2f;
+
+  float period = 0.f; // input period, 0 until two edges were seen
+  float phase = 0.f;  // position inside the current input cycle, 0..1
+  bool locked = false;
+  bool haveEdge = false;
+  float sinceEdge = 0.f; // since the last edge's threshold crossing
+  float prevV = 0.f;
+  float outlierPeriod = 0.f;
+  bool haveOutlier = false;
+
+  // The ratio as num/den: a group of den input cycles holds num output ticks.
+  int num = 1;
+  int den = 1;
+  float ratio = 1.f;
+  int cycle = 0;   // input cycle inside the group, 0..den-1
+  int emitted = 0; // output ticks of this group already sent
+
+  void reset() {
+    period = 0.f;
+    phase = 0.f;
+    locked = false;
+    haveEdge = false;
+    sinceEdge = 0.f;
+    haveOutlier = false;
+    cycle = 0;
+    emitted = 0;
+  }
+
+  // Keeps the period; the next edge re-aligns phase and group (RESET).
+  void rearm() { locked = false; }
+
+  static bool near(float a, float b) {
+    return a < b * TOLERANCE && b < a * TOLERANCE;
+  }
+
+  // First output tick of input cycle c (ceil(c * num / den)).
+  int firstTick(int c) const { return (c * num + den - 1) / den; }
+
+  void setRatio(float r) {
+    if (r == ratio)
+      return;
+    ratio = r;
+    den = 1;
+    while (den < 64 && std::fabs(r * den - std::round(r * den)) > 1e-3f)
+      ++den;
+    num = std::max(1, (int)std::round(r * den));
+    // Carry on from the same point of the cycle under the new grid.
+    cycle %= den;
+    emitted = std::min(num, (int)std::floor((cycle + phase) * ratio) + 1);
+  }
+
+  void measure(float interval) {
+    // A stopped clock or a freshly patched cable is not a tempo.
+    if (interval < MIN_PERIOD || interval > MAX_PERIOD)
+      return;
+    if (period <= 0.f || near(interval, period)) {
+      period = (period > 0.f) ? period + SMOOTHING * (interval - period)
+                              : interval;
+      haveOutlier = false;
+    } else if (haveOutlier && near(interval, outlierPeriod)) {
+      // Two outliers that agree: the tempo really changed.
+      period = 0.5f * (interval + outlierPeriod);
+      haveOutlier = false;
+    } else {
+      outlierPeriod = interval;
+      haveOutlier = true;
+    }
+  }
+
+  // Moves to the next input cycle. flush sends the ticks of the finished
+  // cycle that are still due; otherwise they are dropped (hard re-sync).
+  void nextCycle(bool flush, int &ticks) {
+    int due = std::min(num, firstTick(cycle + 1));
+    if (flush && emitted < due)
+      ticks += due - emitted;
+    emitted = std::max(emitted, due);
+    if (++cycle >= den) {
+      cycle = 0;
+      emitted = 0;
+    }
+  }
+
+  // Call every sample. Returns the number of output ticks due now (usually 0
+  // or 1).
+  int process(float sampleTime, float v, bool edge, float r) {
+    setRatio(r);
+    int ticks = 0;
+    sinceEdge += sampleTime;
+    if (locked)
+      phase += sampleTime / period;
+
+    if (edge) {
+      const float span = v - prevV;
+      const float frac =
+          span > 1e-6f ? clamp((THRESHOLD - prevV) / span, 0.f, 1.f) : 1.f;
+      const float late = (1.f - frac) * sampleTime;
+      if (haveEdge)
+        measure(sinceEdge - late);
+      sinceEdge = late;
+      haveEdge = true;
+
+      if (period <= 0.f) {
+        // No tempo yet: multipliers still tick on the edge itself.
+        if (ratio >= 1.f)
+          ++ticks;
+      } else if (!locked) {
+        phase = late / period;
+        cycle = 0;
+        emitted = 0;
+        locked = true;
+      } else {
+        const float edgePhase = phase - late / period;
+        const bool early = edgePhase >= 0.5f;
+        const float err = early ? edgePhase - 1.f : edgePhase;
+        if (std::fabs(err) > LOCK_WINDOW) {
+          if (early)
+            nextCycle(false, ticks);
+          phase = late / period;
+        } else {
+          phase -= PHASE_GAIN * err;
+          period += FREQ_GAIN * err * period;
+        }
+      }
+    }
+    prevV = v;
+
+    if (locked) {
+      while (phase >= 1.f) {
+        phase -= 1.f;
+        nextCycle(true, ticks);
+      }
+      float outPos = ((float)cycle + phase) * ratio;
+      while (emitted < num && outPos >= (float)emitted) {
+        ++ticks;
+        ++emitted;
+      }
+    }
+    return ticks;
+  }
+};
 
 struct ClockProcessor {
   float timeSinceClk = 0.f;
@@ -14,12 +172,18 @@ struct ClockProcessor {
   bool havePhase = false;
   bool prevClkConnected = false;
   bool havePrevEdge = false;
+  bool edge = false; // CLK rose this sample
+
+  // Phase-locked multiplier/divider instead of restarting the virtual timer
+  // on every edge.
+  bool pllMode = false;
+  ClockPll pll;
 
   int swingPhase = 0;
   int queuedBaseTicks = 0;
-  bool tickPending = false;
-  float pendingDelay = 0.f;
-  float pendingTimer = 0.f;
+  // Virtual ticks queued since the last edge. An integer multiplier plays
+  // ratio - 1 of them per edge; the edge plays the last.
+  int virtSinceEdge = 0;
 
   dsp::SchmittTrigger clkTrig;
 
@@ -34,12 +198,12 @@ struct ClockProcessor {
     prevClkConnected = false;
     swingPhase = 0;
     queuedBaseTicks = 0;
-    tickPending = false;
-    pendingDelay = 0.f;
-    pendingTimer = 0.f;
+    virtSinceEdge = 0;
     sinceLastTick = 1e9f;
     havePrevEdge = false;
+    edge = false;
     clkTrig.reset();
+    pll.reset();
   }
 
   void onDisconnect() {
@@ -50,31 +214,47 @@ struct ClockProcessor {
     sinceLastEdge = 0.f;
     clockWasConnected = false;
     queuedBaseTicks = 0;
-    tickPending = false;
-    pendingDelay = 0.f;
-    pendingTimer = 0.f;
+    virtSinceEdge = 0;
     havePrevEdge = false;
+    pll.reset();
   }
 
   float getVirtPeriod() const { return virtPeriod; }
 
-  bool process(const rack::engine::Module::ProcessArgs &args, Input &clkInput,
-               float ratio, float swing, bool isConnected) {
+  // Called by the owner when a released tick actually plays.
+  void onTick() {
+    swingPhase++;
+    sinceLastTick = 0.f;
+  }
+
+  // Returns true when a tick is released this sample; `delay` is then how
+  // long (s) after this sample it should play, non-zero on swung ticks. The
+  // owner schedules it and calls onTick() when it plays. While tickInFlight
+  // (a released tick has not played yet) further ticks stay queued.
+  bool process(float sampleTime, float clkVoltage, float ratio, float swing,
+               bool isConnected, bool tickInFlight, float &delay) {
     if (isConnected) {
-      timeSinceClk += args.sampleTime;
-      sinceLastEdge += args.sampleTime;
+      timeSinceClk += sampleTime;
+      sinceLastEdge += sampleTime;
     } else {
       timeSinceClk = 0.f;
     }
-    sinceLastTick += args.sampleTime;
+    sinceLastTick += sampleTime;
 
     bool needsVirtualClock = std::fabs(ratio - 1.f) > 1e-6f;
     if (!needsVirtualClock)
       havePhase = false;
+    const bool usePll = pllMode && needsVirtualClock;
+    // A PLL left running from before would pick up with a stale phase.
+    if (!usePll && pll.locked)
+      pll.rearm();
 
     // Explicit Schmitt thresholds (matches Fundamental SEQ3): 0.1 V low,
     // 2 V high. More robust against signals that idle a bit above 0 V.
-    bool extPulse = clkTrig.process(clkInput.getVoltage(), 0.1f, 2.f);
+    bool extPulse = clkTrig.process(clkVoltage, 0.1f, 2.f);
+    edge = extPulse;
+    const bool isIntMultiplier =
+        (ratio >= 1.f) && (std::fabs(ratio - std::round(ratio)) < 1e-4f);
     if (extPulse) {
       // The first edge after connect/reset has a stale timeSinceClk (it has
       // been accumulating since the cable was connected, possibly seconds).
@@ -95,12 +275,11 @@ struct ClockProcessor {
       sinceLastEdge = 0.f;
       havePrevEdge = true;
 
-      bool isIntMultiplier =
-          (ratio >= 1.f) && (std::fabs(ratio - std::round(ratio)) < 1e-4f);
+      virtSinceEdge = 0;
 
       if (ratio >= 1.f) {
         virtTimer = 0.f;
-        if (isIntMultiplier)
+        if (isIntMultiplier && !usePll)
           queuedBaseTicks++;
       }
 
@@ -121,49 +300,44 @@ struct ClockProcessor {
       virtTimer = 0.f;
     }
 
-    if (needsVirtualClock && havePhase && virtPeriod > 0.f) {
-      virtTimer += args.sampleTime;
+    if (usePll) {
+      queuedBaseTicks += pll.process(sampleTime, clkVoltage, extPulse, ratio);
+      // Same stall timeout as the free-running phase below.
+      if (pll.locked && sinceLastEdge > timeout)
+        pll.rearm();
+      if (pll.locked)
+        virtPeriod = pll.period / std::max(ratio, 1e-6f);
+    } else if (needsVirtualClock && havePhase && virtPeriod > 0.f) {
+      // The timer accumulates in float, so the virtual tick that lines up
+      // with the next edge can come a sample before it; that tick is the
+      // edge's own and waits for it.
+      virtTimer += sampleTime;
       while (virtTimer >= virtPeriod) {
         virtTimer -= virtPeriod;
-        queuedBaseTicks++;
+        if (!isIntMultiplier || virtSinceEdge < (int)std::round(ratio) - 1) {
+          queuedBaseTicks++;
+          ++virtSinceEdge;
+        }
       }
     }
 
-    bool clockNow = false;
-
-    if (tickPending) {
-      pendingTimer += args.sampleTime;
-      if (pendingTimer >= pendingDelay) {
-        tickPending = false;
-        pendingTimer = 0.f;
-        clockNow = true;
-        swingPhase++;
-        sinceLastTick = 0.f;
-      }
-    }
+    bool release = false;
+    delay = 0.f;
 
-    if (!tickPending && !clockNow && queuedBaseTicks > 0) {
+    if (!tickInFlight && queuedBaseTicks > 0) {
       float s = (1.f / 3.f) * swing;
       bool isOdd = (swingPhase & 1) == 1;
-      pendingDelay = isOdd ? (s * virtPeriod) : 0.f;
-
-      if (pendingDelay <= 1e-9f) {
-        if (sinceLastTick < 0.0005f) {
-          queuedBaseTicks--;
-        } else {
-          queuedBaseTicks--;
-          clockNow = true;
-          swingPhase++;
-          sinceLastTick = 0.f;
-        }
-      } else {
-        tickPending = true;
-        pendingTimer = 0.f;
-        queuedBaseTicks--;
-      }
+      delay = isOdd ? (s * virtPeriod) : 0.f;
+      queuedBaseTicks--;
+      // An unswung tick right on top of the previous one (edge and virtual
+      // tick landing together) is dropped.
+      if (delay > 1e-9f || sinceLastTick >= 0.0005f)
+        release = true;
+      else
+        delay = 0.f;
     }
 
     prevClkConnected = isConnected;
-    return clockNow;
+    return release;
   }
 };
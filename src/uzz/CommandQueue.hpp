@@ -0,0 +1,38 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Bounded single-producer / single-consumer queue of small commands: the UI
+// thread pushes, the audio thread pops at the top of process(). Each side owns
+// one index and only reads the other's, so neither ever waits or allocates.
+// A push onto a full queue is dropped and reported, which for UI actions just
+// means a click that did nothing.
+template <typename T, int CAP> struct CommandQueue {
+  static_assert(CAP >= 2 && (CAP & (CAP - 1)) == 0,
+                "CommandQueue capacity must be a power of two");
+
+  T ring[CAP];
+  std::atomic<uint32_t> writeIdx{0}; // owned by the producer
+  std::atomic<uint32_t> readIdx{0};  // owned by the consumer
+
+  // Producer side.
+  bool push(const T &cmd) {
+    const uint32_t w = writeIdx.load(std::memory_order_relaxed);
+    if (w - readIdx.load(std::memory_order_acquire) >= (uint32_t)CAP)
+      return false;
+    ring[w & (CAP - 1)] = cmd;
+    writeIdx.store(w + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side. Returns false when nothing is waiting.
+  bool pop(T &cmd) {
+    const uint32_t r = readIdx.load(std::memory_order_relaxed);
+    if (r == writeIdx.load(std::memory_order_acquire))
+      return false;
+    cmd = ring[r & (CAP - 1)];
+    readIdx.store(r + 1, std::memory_order_release);
+    return true;
+  }
+};
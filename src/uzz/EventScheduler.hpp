@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+
+// One future event: what to do (type), to whom (target, e.g. a track or an
+// output lane) and a small argument, at an absolute sample time.
+struct SchedEvent {
+  uint32_t time = 0;
+  uint8_t type = 0;
+  uint8_t target = 0;
+  uint16_t arg = 0;
+};
+
+// Fixed-capacity queue of future events, kept sorted in a ring so the next
+// event is always at the head. Checking whether anything is due is one
+// compare, so idle samples cost nothing; push and cancel are a linear walk
+// over the few pending events. No allocation after construction.
+//
+// Events are ordered by time, then by type (lower type first), then by
+// insertion, so the owner picks the order in which same-sample events run by
+// numbering its event types. Times are a free-running sample counter and are
+// compared modulo 2^32, so the counter may wrap as long as nothing is
+// scheduled more than 2^31 samples ahead.
+template <int CAP> struct EventScheduler {
+  static_assert(CAP >= 2 && (CAP & (CAP - 1)) == 0,
+                "EventScheduler capacity must be a power of two");
+
+  SchedEvent ring[CAP];
+  int head = 0;
+  int count = 0;
+
+  static bool before(uint32_t a, uint32_t b) { return (int32_t)(a - b) < 0; }
+
+  void clear() {
+    head = 0;
+    count = 0;
+  }
+
+  bool empty() const { return count == 0; }
+  const SchedEvent &at(int i) const { return ring[(head + i) & (CAP - 1)]; }
+  SchedEvent &at(int i) { return ring[(head + i) & (CAP - 1)]; }
+
+  // Returns false and drops the event if the queue is full.
+  bool push(uint32_t time, int type, int target, int arg = 0) {
+    if (count >= CAP)
+      return false;
+    SchedEvent e;
+    e.time = time;
+    e.type = (uint8_t)type;
+    e.target = (uint8_t)target;
+    e.arg = (uint16_t)arg;
+    int i = count;
+    while (i > 0 && runsBefore(e, at(i - 1))) {
+      at(i) = at(i - 1);
+      --i;
+    }
+    at(i) = e;
+    ++count;
+    return true;
+  }
+
+  // True when the head event is due at or before sample `now`.
+  bool due(uint32_t now) const {
+    return count > 0 && !before(now, ring[head].time);
+  }
+
+  SchedEvent pop() {
+    SchedEvent e = ring[head];
+    head = (head + 1) & (CAP - 1);
+    --count;
+    return e;
+  }
+
+  bool pending(int type, int target) const {
+    for (int i = 0; i < count; ++i)
+      if (at(i).type == type && at(i).target == target)
+        return true;
+    return false;
+  }
+
+  // Drops every pending event of this type and target.
+  void cancel(int type, int target) { drop(type, target, false, 0); }
+
+  // Same, but only events scheduled later than sample `after`.
+  void cancelAfter(int type, int target, uint32_t after) {
+    drop(type, target, true, after);
+  }
+
+private:
+  void drop(int type, int target, bool onlyLater, uint32_t after) {
+    int kept = 0;
+    for (int i = 0; i < count; ++i) {
+      const SchedEvent e = at(i);
+      if (e.type == type && e.target == target &&
+          (!onlyLater || before(after, e.time)))
+        continue;
+      at(kept++) = e;
+    }
+    count = kept;
+  }
+
+  static bool runsBefore(const SchedEvent &a, const SchedEvent &b) {
+    if (a.time != b.time)
+      return before(a.time, b.time);
+    return a.type < b.type;
+  }
+};
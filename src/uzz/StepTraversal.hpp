@@ -0,0 +1,150 @@
+#pragma once
+
+#include "UzzTypes.hpp"
+
+// Precomputed traversal of a step window for every DirectionMode. Everything a
+// direction needs that does not depend on the running position — the next
+// playable step in each direction from every position, the visiting order of
+// the sequence modes, the RANDOM pool — is built once per (direction, start,
+// steps, play mask, jump N, slots) and looked up per tick. StepNavigator walks
+// it.
+//
+// N is the most step slots the tables have room for; slots, part of the key,
+// is how many the window wraps around right now (16 for one UZZ, up to 64 for
+// a chain). The play mask has bit i set when slot i is playable (not SKIP), so
+// any sequencer with up to 64 slots can use it without knowing UZZ's step
+// modes.
+template <int N> struct StepTraversal {
+  static_assert(N >= 1 && N <= 64, "StepTraversal supports 1..64 slots");
+  typedef uint64_t Mask;
+
+  // Key of the current tables. dirMode -1000 never matches, so the first
+  // update() always builds.
+  int dirMode = -1000;
+  int start = 0;
+  int steps = 0;
+  int jumpN = 0;
+  int slots = N;
+  Mask playMask = 0;
+
+  bool allSkip = true; // no playable slot inside the window
+  // next[0][rel] / next[1][rel]: slot reached moving forward / backward from
+  // window position rel, skipping SKIP slots. Filled for every rel < slots so
+  // a position left outside a shrunk window still resolves.
+  int8_t next[2][N];
+  // Window positions visited by PINGPONG, ODD/EVEN, JUMP, CONVERGE and
+  // DIVERGE, indexed by sequence position.
+  int8_t order[2 * N];
+  int cycleLen = 1;
+  // Playable slots of the window, in window order (RANDOM).
+  int8_t pool[N];
+  int poolSize = 0;
+
+  int wrap(int i) const {
+    return ((slots & (slots - 1)) == 0) ? (i & (slots - 1))
+                                        : ((i % slots) + slots) % slots;
+  }
+
+  Mask windowMask() const {
+    Mask m = 0;
+    for (int k = 0; k < steps; ++k)
+      m |= (Mask)1 << wrap(start + k);
+    return m;
+  }
+
+  bool playable(int slot) const { return (playMask >> slot) & 1; }
+
+  // Rebuilds the tables if any part of the key changed. Returns true when it
+  // did. jumpN only matters to DIR_JUMP and is ignored for the others.
+  bool update(int dir, int st, int len, Mask mask, int jn, int nSlots = N) {
+    nSlots = clamp(nSlots, 1, N);
+    len = clamp(len, 1, nSlots);
+    st = ((st % nSlots) + nSlots) % nSlots;
+    if (dir != DIR_JUMP)
+      jn = 0;
+    if (dir == dirMode && st == start && len == steps && mask == playMask &&
+        jn == jumpN && nSlots == slots)
+      return false;
+    slots = nSlots;
+    dirMode = dir;
+    start = st;
+    steps = len;
+    playMask = mask;
+    jumpN = jn;
+    build();
+    return true;
+  }
+
+private:
+  void build() {
+    allSkip = (playMask & windowMask()) == 0;
+
+    poolSize = 0;
+    for (int k = 0; k < steps; ++k) {
+      int slot = wrap(start + k);
+      if (playable(slot))
+        pool[poolSize++] = (int8_t)slot;
+    }
+
+    for (int d = 0; d < 2; ++d) {
+      for (int relFrom = 0; relFrom < slots; ++relFrom) {
+        int rel = relFrom;
+        int found = -1;
+        for (int tries = 0; tries < steps && found < 0; ++tries) {
+          rel = (d == 0) ? (rel + 1) % steps : (rel - 1 + steps) % steps;
+          if (playable(wrap(start + rel)))
+            found = wrap(start + rel);
+        }
+        if (found < 0) {
+          // Nothing playable: step on as if no slot were skipped.
+          int relTheo = (d == 0) ? (relFrom + 1) % steps
+                                 : (relFrom - 1 + steps) % steps;
+          found = wrap(start + relTheo);
+        }
+        next[d][relFrom] = (int8_t)found;
+      }
+    }
+
+    cycleLen = steps;
+    switch (dirMode) {
+    case DIR_PINGPONG:
+      cycleLen = 2 * steps;
+      for (int p = 0; p < cycleLen; ++p)
+        order[p] = (int8_t)((p < steps) ? p : (2 * steps - 1 - p));
+      break;
+    case DIR_ODD_EVEN: {
+      int half = (steps + 1) / 2;
+      for (int p = 0; p < steps; ++p)
+        order[p] = (int8_t)((p < half) ? p * 2 : (p - half) * 2 + 1);
+      break;
+    }
+    case DIR_JUMP: {
+      int jn = clamp(jumpN, 2, steps > 1 ? steps - 1 : 1);
+      int a = steps, b = jn;
+      while (b) {
+        int t = b;
+        b = a % b;
+        a = t;
+      }
+      cycleLen = steps / (a ? a : 1);
+      for (int p = 0; p < cycleLen; ++p)
+        order[p] = (int8_t)((p * jn) % steps);
+      break;
+    }
+    case DIR_CONVERGE:
+      for (int p = 0; p < steps; ++p)
+        order[p] = (int8_t)((p % 2 == 0) ? p / 2 : steps - 1 - p / 2);
+      break;
+    case DIR_DIVERGE: {
+      int center = (steps - 1) / 2;
+      for (int p = 0; p < steps; ++p)
+        order[p] =
+            (int8_t)((p % 2 == 0) ? center - p / 2 : center + (p + 1) / 2);
+      break;
+    }
+    default:
+      order[0] = 0;
+      break;
+    }
+  }
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "UzzTracks.hpp"
+
+// Chaining. A UZZ with "Chain to UZZ on the left" enabled, placed right of
+// another UZZ, stops sequencing on its own and lends its 16 steps to the
+// module on its left; a row of up to UZZ_MAX_CHAIN modules plays as one
+// 32 / 48 / 64-step sequence. Only the leftmost module (the leader) runs the
+// clock, the tracks and the scheduler, over the combined window; the others
+// (followers) just serve step data and mirror the playhead.
+//
+// Two messages travel along the row, both over ExpanderLink.hpp:
+//
+//  - UzzChainUp, right to left: each follower sends its own step rows plus
+//    everything it received from the followers on its right, at control
+//    rate.
+//  - UzzChainDown, left to right: the leader's playhead, window and step
+//    gates, every sample. Each follower relays it one place further with its
+//    index bumped, so module k of the chain lags the leader by k samples.
+//
+// A snapshot recalled on the leader spans the whole chain. Once the engine
+// swaps it in, the leader sends the followers' rows down with the playhead
+// (UzzChainRecall); each follower writes its share onto its panel and passes
+// the rest on. Until every follower echoes the recall back up, the leader
+// keeps playing what it recalled rather than the rows still coming up.
+struct UzzChainUp {
+  // Followers from the sender rightwards, including the sender. 0: the
+  // sender is a UZZ that is not chained.
+  int modules = 0;
+  // Last recall every follower from the sender to the end of the chain has
+  // taken.
+  uint32_t recallSeq = 0;
+  // rows[k]: step rows of the k-th follower from the sender, every track.
+  float rows[UZZ_MAX_CHAIN - 1][UZZ_MAX_TRACKS][NUM_STEP_ROWS][16];
+};
+
+struct UzzChainDown {
+  int index = 0;      // receiver's place in the chain; 0: not chained
+  int slots = 16;     // step slots of the whole chain
+  int steps = 16;     // window length
+  int trackCount = 1;
+  int8_t step[UZZ_MAX_TRACKS] = {}; // current slot of every track
+  uint64_t stepGates = 0;           // bit p: window position p's gate is high
+  bool running = false;
+  bool stopped = false;
+  uint32_t recallSeq = 0; // recalls the leader has swapped in
+};
+
+// The followers' rows of a recalled snapshot. Written only on the sample the
+// leader's recallSeq moves on, with seq set to match; on other samples the
+// buffer keeps an older payload, which its seq tells apart.
+struct UzzChainRecall {
+  uint32_t seq = 0;
+  int slots = 16; // slots recalled; followers past them keep their rows
+  // rows[k]: step rows of follower k + 1, every track.
+  float rows[UZZ_MAX_CHAIN - 1][UZZ_MAX_TRACKS][NUM_STEP_ROWS][16];
+
+  // Fills the rows of the followers within n slots from the leader's
+  // compiled pattern.
+  void fill(const UzzTrackSnap *snap, int n) {
+    slots = n;
+    for (int k = 0; k + 1 < n / 16 && k < UZZ_MAX_CHAIN - 1; ++k)
+      for (int t = 0; t < UZZ_MAX_TRACKS; ++t)
+        for (int r = 0; r < NUM_STEP_ROWS; ++r)
+          for (int i = 0; i < 16; ++i)
+            rows[k][t][r][i] = snap[t].raw[r][16 * (k + 1) + i];
+  }
+};
+
+// Everything that reaches a UZZ from its left: UZZ-X, or the previous module
+// of a chain. Only the part matching the neighbour's model is written.
+struct UzzLeftMsg {
+  UzzExpMsg uzzx;
+  UzzChainDown chain;
+  UzzChainRecall recall;
+};
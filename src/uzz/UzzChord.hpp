@@ -0,0 +1,62 @@
+#pragma once
+
+#include "UzzScale.hpp"
+
+// Chord steps. A step's chord adds up to three voices above its pitch; the
+// track then comes out as a stack of up to UZZ_CHORD_VOICES channels on
+// V/OCT and GATE. Chromatic, the voices are the semitone intervals below.
+// With a scale set they stack scale notes instead, so every chord stays in
+// the scale: degree d is d notes of the scale above the root, and each 7 adds
+// an octave (a triad is 0, 2, 4 and a seventh chord 0, 2, 4, 6, whatever the
+// scale's size).
+static constexpr int UZZ_CHORD_VOICES = 4;
+
+struct UzzChordDef {
+  const char *name;
+  int n; // voices, root included
+  int8_t semis[UZZ_CHORD_VOICES];
+  int8_t degrees[UZZ_CHORD_VOICES];
+};
+
+static const UzzChordDef UZZ_CHORDS[] = {
+    {"Off", 1, {0}, {0}},
+    {"Octave", 2, {0, 12}, {0, 7}},
+    {"Fifth", 2, {0, 7}, {0, 4}},
+    {"Fifth + octave", 3, {0, 7, 12}, {0, 4, 7}},
+    {"Major", 3, {0, 4, 7}, {0, 2, 4}},
+    {"Minor", 3, {0, 3, 7}, {0, 2, 4}},
+    {"Diminished", 3, {0, 3, 6}, {0, 2, 4}},
+    {"Sus2", 3, {0, 2, 7}, {0, 1, 4}},
+    {"Sus4", 3, {0, 5, 7}, {0, 3, 4}},
+    {"Major 7", 4, {0, 4, 7, 11}, {0, 2, 4, 6}},
+    {"Minor 7", 4, {0, 3, 7, 10}, {0, 2, 4, 6}},
+    {"Dominant 7", 4, {0, 4, 7, 10}, {0, 2, 4, 6}},
+};
+static constexpr int UZZ_NUM_CHORDS =
+    (int)(sizeof(UZZ_CHORDS) / sizeof(UZZ_CHORDS[0]));
+
+// Voice offsets in volts above the root, for every chord and root pitch
+// class. Rebuilt by build() when the scale changes; a sample then reads one
+// float_4. Voices a chord does not have repeat the root.
+struct UzzChordLut {
+  simd::float_4 off[UZZ_NUM_CHORDS][12];
+
+  UzzChordLut() { build(UzzScaleLut()); }
+
+  void build(const UzzScaleLut &scale) {
+    for (int c = 0; c < UZZ_NUM_CHORDS; ++c) {
+      const UzzChordDef &def = UZZ_CHORDS[c];
+      for (int pc = 0; pc < 12; ++pc) {
+        float v[UZZ_CHORD_VOICES] = {};
+        for (int k = 1; k < def.n; ++k) {
+          const int d = def.degrees[k];
+          const int semis = scale.active()
+                                ? scale.stepUp(pc, d % 7) - pc + 12 * (d / 7)
+                                : def.semis[k];
+          v[k] = (float)semis / 12.f;
+        }
+        off[c][pc] = simd::float_4::load(v);
+      }
+    }
+  }
+};
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "UzzRack.hpp"
+
+// Trig conditions, Elektron style. A step with a condition only sounds on
+// the cycles the condition allows; its probability is rolled after that.
+// A cycle is one pass of the track through the window: it starts at 0 on
+// RESET and counts up each time the track wraps (its EOC).
+//
+//   FIRST / NOT FIRST  the first cycle after RESET, or every other one
+//   A:B                cycle A of every B (1:2 plays cycles 0, 2, 4, ...)
+//   FILL / NOT FILL    while UZZ-X FILL is high, or while it is low
+//   PRE / NOT PRE      the last conditional step of the track sounded
+//                      (a step with a condition or a probability roll,
+//                      PRE steps excluded), or did not
+//
+// Index 0 is "Always"; 1..6 are the fixed conditions above; A:B follow for
+// B = 2..UZZ_COND_MAX_B and A = 1..B.
+enum UzzCondKind {
+  COND_ALWAYS,
+  COND_FILL,
+  COND_NOT_FILL,
+  COND_PRE,
+  COND_NOT_PRE,
+  COND_FIRST,
+  COND_NOT_FIRST,
+  COND_RATIO
+};
+
+static constexpr int UZZ_COND_MAX_B = 8;
+static constexpr int UZZ_COND_RATIO_BASE = COND_RATIO;
+// Always, the six fixed ones, then 2 + 3 + ... + 8 A:B entries.
+static constexpr int UZZ_NUM_CONDS =
+    UZZ_COND_RATIO_BASE + (UZZ_COND_MAX_B + 2) * (UZZ_COND_MAX_B - 1) / 2;
+
+struct UzzCondDef {
+  int kind = COND_ALWAYS;
+  int a = 1; // A:B only
+  int b = 1;
+};
+
+inline UzzCondDef uzzCond(int c) {
+  UzzCondDef d;
+  if (c < UZZ_COND_RATIO_BASE) {
+    d.kind = (c > 0) ? c : COND_ALWAYS;
+    return d;
+  }
+  d.kind = COND_RATIO;
+  int k = c - UZZ_COND_RATIO_BASE;
+  for (d.b = 2; k >= d.b && d.b < UZZ_COND_MAX_B; ++d.b)
+    k -= d.b;
+  d.a = 1 + k;
+  return d;
+}
+
+// Index of A:B.
+inline int uzzCondRatio(int a, int b) {
+  return UZZ_COND_RATIO_BASE + (b + 1) * (b - 2) / 2 + (a - 1);
+}
+
+inline std::string uzzCondName(int c) {
+  static const char *const fixed[UZZ_COND_RATIO_BASE] = {
+      "Always", "Fill", "Not fill", "Pre", "Not pre", "First", "Not first"};
+  if (c < UZZ_COND_RATIO_BASE)
+    return fixed[c > 0 ? c : 0];
+  const UzzCondDef d = uzzCond(c);
+  return string::f("%d:%d", d.a, d.b);
+}
+
+// The conditions of one track compiled for the current cycle. Rebuilt only
+// when the cycle, FILL or the conditions change; a tick then decides with a
+// bit test whether its step may sound.
+struct UzzCondMask {
+  uint64_t pass = ~0ULL; // condition holds this cycle (Always included)
+  uint64_t pre = 0;      // PRE steps
+  uint64_t notPre = 0;   // NOT PRE steps
+  uint64_t sets = 0;     // steps that update the track's PRE state
+  bool any = false;      // some step has a condition
+
+  void build(const int8_t *cond, int slots, uint32_t cycle, bool fill) {
+    pass = 0;
+    pre = 0;
+    notPre = 0;
+    sets = 0;
+    any = false;
+    for (int i = 0; i < slots; ++i) {
+      const uint64_t bit = (uint64_t)1 << i;
+      const UzzCondDef d = uzzCond(cond[i]);
+      bool ok = true;
+      switch (d.kind) {
+      case COND_FILL:
+        ok = fill;
+        break;
+      case COND_NOT_FILL:
+        ok = !fill;
+        break;
+      case COND_PRE:
+        pre |= bit;
+        ok = false;
+        break;
+      case COND_NOT_PRE:
+        notPre |= bit;
+        ok = false;
+        break;
+      case COND_FIRST:
+        ok = cycle == 0;
+        break;
+      case COND_NOT_FIRST:
+        ok = cycle != 0;
+        break;
+      case COND_RATIO:
+        ok = (int)(cycle % (uint32_t)d.b) == d.a - 1;
+        break;
+      default:
+        break;
+      }
+      if (ok)
+        pass |= bit;
+      if (d.kind != COND_ALWAYS && d.kind != COND_PRE &&
+          d.kind != COND_NOT_PRE)
+        sets |= bit;
+      any = any || d.kind != COND_ALWAYS;
+    }
+  }
+
+  // Whether slot i may sound, given the track's PRE state.
+  bool allows(int i, bool lastPassed) const {
+    return ((pass | (lastPassed ? pre : notPre)) >> i) & 1;
+  }
+};
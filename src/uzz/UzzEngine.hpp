@@ -0,0 +1,840 @@
+#pragma once
+
+#include "ClockProcessor.hpp"
+#include "EventScheduler.hpp"
+#include "UzzChord.hpp"
+#include "UzzGroove.hpp"
+#include "UzzLatency.hpp"
+#include "UzzScale.hpp"
+#include "UzzTracks.hpp"
+#include "UzzTypes.hpp"
+
+// The UZZ sequencing engine: clock, reset, step advance, ratchets, HOLD /
+// GATED pulse modes, accumulators, probability, gates, EOC and CV for every
+// track. It knows nothing about params, ports, lights or the expander: the
+// module resolves knobs and CV into a UzzEngine::Input each sample, keeps the
+// compiled step tables in snap[] up to date, and copies UzzEngine::Output to
+// its ports. The few Rack helpers it uses come through UzzRack.hpp, so it
+// also builds without the SDK: tools/uzz_run.cpp plays it headless against
+// golden traces. Every random draw comes from the tracks' own streams, so
+// reseed() with the same seed replays the same run.
+//
+// Everything that happens later than "now" — swung ticks, ratchet sub-pulses,
+// the end of every gate, step gate and EOC pulse, RESET, micro-timed steps —
+// is an event on one scheduler, at an exact sample. Samples with nothing due
+// only run the clock and the CV outputs.
+//
+// Micro-timing: with a groove or any per-step offset set, a track decides its
+// next step as soon as the current one has played (one step of lookahead) and
+// plays it at its tick plus the offset. A late step is an EV_PLAY after the
+// tick; an early one is an EV_PLAY at the predicted time of the tick minus the
+// offset, and the tick itself then has nothing left to do for that track. If
+// the tick comes first anyway (the tempo rose), the step plays on the tick.
+// With no offsets the tick decides and plays at once, as it always did.
+struct UzzEngine {
+  // Global pulse mode for PLAY / ACCUM steps; SM_PULSE / SM_GATED / SM_HOLD
+  // override it per step.
+  enum PulseMode { PM_PULSE = 0, PM_GATED = 1, PM_HOLD = 2 };
+
+  // Scheduled event types. Events due on the same sample run in this order:
+  // pulses end before a tick can start new ones, a tick plays before RESET
+  // moves the tracks to the window start, and a tick or a micro-timed step
+  // cancels the ratchet of the step it leaves.
+  enum EventType { EV_OFF = 0, EV_TICK, EV_RESET, EV_RATCHET, EV_PLAY };
+
+  // Output lanes: the gate of each track, one step gate per window position
+  // (16 for a lone UZZ, up to UZZ_MAX_STEPS for a chain) and EOC. A lane stays
+  // high until its EV_OFF event.
+  enum Lane {
+    LANE_GATE = 0,
+    LANE_STEP = LANE_GATE + UZZ_MAX_TRACKS,
+    LANE_EOC = LANE_STEP + UZZ_MAX_STEPS,
+    NUM_LANES
+  };
+
+  // Everything the engine reads in one sample.
+  struct Input {
+    float sampleTime = 1.f / 44100.f;
+    bool clkConnected = false;
+    float clkVoltage = 0.f;
+    float ratio = 1.f;
+    float swing = 0.f;
+    bool reset = false; // rising edge on RESET this sample
+    int slots = 16;     // step slots the window wraps around (chain length)
+    int start = 0;      // 0-based window start, < slots
+    int steps = 16;     // window length, <= slots
+    int modeDir = DIR_FWD;
+    int gateMode = 0; // 0 = gate, 1 = trig
+    float pGlobal = 1.f;
+    int accumAmt = 1;
+    int accumWrap = 0;
+    bool addressed = false; // absolute step addressing (UZZ-X ADDR)
+    int relAddr = 0;
+    bool scan = false; // ADDR scan: tracks follow relAddr every sample
+    bool fill = false; // UZZ-X FILL is high (FILL / NOT FILL conditions)
+    int xposeSemis = 0;
+    float slewAlpha = 1.f; // 1 = no slew
+  };
+
+  // Everything the engine writes in one sample. Gates, step gates and EOC
+  // are only meaningful while the clock is connected (running) or on the
+  // sample the clock is pulled (stopped, all low); otherwise the outputs keep
+  // their last value.
+  struct Output {
+    float pitch[UZZ_MAX_TRACKS];
+    float m1[UZZ_MAX_TRACKS];
+    float m2[UZZ_MAX_TRACKS];
+    bool gate[UZZ_MAX_TRACKS];
+    uint64_t stepGates; // bit p: window position p's gate is high
+    bool eoc;
+    bool running;
+    bool stopped;
+    uint32_t moved; // bit t: track t landed on a step this sample
+    // Every voice of each track's chord (lane 0 is pitch[t]) and how many the
+    // current step's chord has.
+    simd::float_4 voices[UZZ_MAX_TRACKS];
+    int chordVoices[UZZ_MAX_TRACKS];
+  };
+
+  UzzEngine() {}
+  // snap and staged point into snapBuf.
+  UzzEngine(const UzzEngine &) = delete;
+  UzzEngine &operator=(const UzzEngine &) = delete;
+
+  UzzTrack tracks[UZZ_MAX_TRACKS];
+  // Compiled step data of each track, written by the owner.
+  UzzTrackSnap snapBuf[2][UZZ_MAX_TRACKS];
+  UzzTrackSnap *snap = snapBuf[0];
+  // The other half of the double buffer. The owner may compile a whole
+  // replacement pattern here (plus the accumulator offsets of its first
+  // stagedAccumSlots slots) and call commitStaged(); it is swapped in right
+  // before the next tick, or at once while the clock is stopped, and
+  // stagedSwapped is raised for the owner.
+  UzzTrackSnap *staged = snapBuf[1];
+  int stagedAccum[UZZ_MAX_TRACKS][UZZ_MAX_STEPS] = {};
+  int stagedAccumSlots = 16;
+  bool stagedPending = false;
+  bool stagedSwapped = false;
+  int trackCount = 1;
+
+  // Pitch quantizer, set by the owner through setScale() when root or scale
+  // change. Off, the pitch outputs are the raw semitone sum. The chord table
+  // follows the scale.
+  UzzScaleLut scale;
+  UzzChordLut chords;
+  void setScale(int root, int newScale) {
+    scale.set(root, newScale);
+    chords.build(scale);
+  }
+
+  // Micro-timing, in fractions of a step, written by the owner followed by
+  // timingChanged(): the groove by the tick's place in the bar, and each
+  // track's own offset per slot. They add up, limited to +-UZZ_MAX_MICRO.
+  float grooveFrac[16] = {};
+  float microFrac[UZZ_MAX_TRACKS][UZZ_MAX_STEPS] = {};
+  void timingChanged() { timingDirty = true; }
+
+  // Trig condition of each track's slots (index from UzzCond.hpp), written by
+  // the owner followed by conditionsChanged().
+  int8_t cond[UZZ_MAX_TRACKS][UZZ_MAX_STEPS] = {};
+  void conditionsChanged() { condDirty = true; }
+
+  int pulseMode = PM_PULSE;
+  int jumpN = 2;
+  bool eocOnReset = false;
+
+  ClockProcessor clock;
+  // Latency instrumentation, attached by the owner; null when off.
+  UzzLatencyProbe *probe = nullptr;
+
+  // Sample counter the events are timed against; advances once per process().
+  uint32_t now = 0;
+  // One off event per lane, one ratchet per track, one tick and one reset.
+  EventScheduler<128> events;
+  // Lane state; EOC and the per-step poly gates follow track 1.
+  bool laneHigh[NUM_LANES] = {};
+  uint64_t stepHigh = 0; // the LANE_STEP part of laneHigh, one bit per lane
+  uint32_t laneOff[NUM_LANES] = {};
+  int resetTarget = 0;
+  float sampleTime = 1.f / 44100.f;
+  uint32_t movedMask = 0; // Output::moved, gathered during process()
+  // What the tracks' condition masks were built for; they are rebuilt when
+  // any of it changes and, per track, when it starts a new cycle.
+  bool condDirty = true;
+  bool condFill = false;
+  int condSlots = 0;
+
+  // Micro-timing in samples, rebuilt from the fractions only when they, the
+  // step period or the sample rate change; playing a step then costs one
+  // add and a clamp however busy the groove is.
+  bool timingDirty = true;
+  bool timingOn = false; // any offset set
+  float timingPeriod = -1.f;
+  float timingSampleTime = -1.f;
+  int periodSamples = 0;
+  int grooveOff[16] = {};
+  int microOff[UZZ_MAX_TRACKS][UZZ_MAX_STEPS] = {};
+  // Index of the last tick since RESET (the clock's swing phase, which
+  // also places it in the groove) and the sample it played on.
+  uint32_t lastTick = 0;
+  uint32_t lastTickAt = 0;
+
+  void reset(int start) {
+    events.clear();
+    clearLanes();
+    clock.reset();
+    for (int t = 0; t < UZZ_MAX_TRACKS; ++t) {
+      tracks[t].reset(start);
+      snapBuf[0][t].valid = false;
+      snapBuf[1][t].valid = false;
+    }
+    stagedPending = false;
+    stagedSwapped = false;
+    trackCount = 1;
+    condDirty = true;
+  }
+
+  void commitStaged() { stagedPending = true; }
+  // An edit of the playing pattern rather than a new one: the owner copied
+  // snap into staged and changed some steps of it. Swapped in at once, with
+  // the accumulators left running and stagedSwapped left down.
+  void commitEdit() { std::swap(snap, staged); }
+
+  // Track t draws from stream t + 1 of the seed; stream 0 is left to the
+  // owner.
+  void reseed(uint64_t seed) {
+    for (int t = 0; t < UZZ_MAX_TRACKS; ++t)
+      tracks[t].rng.seed(seed, t + 1);
+  }
+
+  void clearAccumulators() {
+    for (int t = 0; t < UZZ_MAX_TRACKS; ++t)
+      for (int i = 0; i < UZZ_MAX_STEPS; ++i)
+        tracks[t].accumOffset[i] = 0;
+  }
+
+  // Rotates the accumulator offsets of the playing tracks over the given
+  // slots (in window order), alongside the owner rotating the step data.
+  void rotateAccumulators(const int *slot, int count, int dir) {
+    int tmpA[UZZ_MAX_STEPS];
+    for (int t = 0; t < trackCount; ++t) {
+      int *accumOffset = tracks[t].accumOffset;
+      for (int i = 0; i < count; ++i)
+        tmpA[i] = accumOffset[slot[i]];
+      for (int i = 0; i < count; ++i)
+        accumOffset[slot[i]] = tmpA[(i - dir + count) % count];
+    }
+  }
+
+  // Slot i folded into 0..slots-1; a mask for 16, 32 and 64.
+  static int wrapSlot(int i, int slots) {
+    return ((slots & (slots - 1)) == 0) ? (i & (slots - 1))
+                                        : ((i % slots) + slots) % slots;
+  }
+
+  static float getGateLength(int gateMode, float duty, float period,
+                             float sampleTime, float maxWindow = 0.f) {
+    if (gateMode != 0)
+      return TRIG_LEN;
+
+    float window = (maxWindow > 0.f) ? maxWindow : period;
+    if (window <= 0.f)
+      return TRIG_LEN;
+
+    float minOff = std::max(0.001f, 2.f * sampleTime);
+    float gLen = window * clamp(duty, 0.01f, 0.95f);
+    float maxLen = std::max(TRIG_LEN, window - minOff);
+    if (gLen > maxLen)
+      gLen = maxLen;
+    // Hard upper bound: a single step gate should never exceed 2 s, regardless
+    // of what the clock period reports. Guards against pathological state
+    // (stale period, paused upstream clock) producing a stuck gate.
+    if (gLen > 2.f)
+      gLen = 2.f;
+    return gLen;
+  }
+
+  // Per-step modes SM_PULSE/SM_GATED/SM_HOLD override the global pulseMode.
+  int stepEffMode(int smode) const {
+    if (smode == SM_PULSE)
+      return PM_PULSE;
+    if (smode == SM_GATED)
+      return PM_GATED;
+    if (smode == SM_HOLD)
+      return PM_HOLD;
+    return pulseMode;
+  }
+
+  void process(const Input &in, Output &out) {
+    ++now;
+    sampleTime = in.sampleTime;
+    movedMask = 0;
+    bool wasClkConnected = clock.prevClkConnected;
+    float tickDelay = 0.f;
+    bool release =
+        clock.process(in.sampleTime, in.clkVoltage, in.ratio, in.swing,
+                      in.clkConnected, events.pending(EV_TICK, 0), tickDelay);
+    if (release && in.clkConnected)
+      events.push(now + toSamples(tickDelay), EV_TICK, 0);
+    if (probe && clock.edge)
+      probe->onEdge(now);
+    if (!in.clkConnected && wasClkConnected)
+      clock.onDisconnect();
+    if (timingDirty || (timingOn && (clock.getVirtPeriod() != timingPeriod ||
+                                     in.sampleTime != timingSampleTime)))
+      rebuildTiming();
+    if (condDirty || in.fill != condFill || in.slots != condSlots) {
+      condDirty = false;
+      condFill = in.fill;
+      condSlots = in.slots;
+      for (int t = 0; t < UZZ_MAX_TRACKS; ++t)
+        buildConditions(t);
+    }
+
+    for (int t = 0; t < trackCount; ++t) {
+      UzzTrack &tr = tracks[t];
+      int rel = wrapSlot(tr.step - in.start, in.slots);
+      if (rel >= in.steps) {
+        rel = rel % in.steps;
+        tr.step = wrapSlot(in.start + rel, in.slots);
+      }
+    }
+
+    out.running = in.clkConnected || in.scan;
+    out.stopped = false;
+
+    if (!in.clkConnected && wasClkConnected) {
+      hardStop();
+      out.stopped = true;
+    }
+
+    if (in.reset)
+      applyReset(in.start);
+
+    while (events.due(now))
+      dispatch(events.pop(), in);
+    if (in.scan) {
+      for (int t = 0; t < trackCount; ++t)
+        if (wrapSlot(tracks[t].step - in.start, in.slots) != in.relAddr)
+          scanTo(t, in);
+    }
+    if (!in.clkConnected && stagedPending)
+      swapStaged();
+
+    if (!out.running) {
+      if (out.stopped) {
+        for (int t = 0; t < trackCount; ++t)
+          out.gate[t] = false;
+        out.stepGates = 0;
+        out.eoc = false;
+      }
+      for (int t = 0; t < trackCount; ++t)
+        writeStepCV(t, in, out);
+      out.moved = movedMask;
+      return;
+    }
+
+    for (int t = 0; t < trackCount; ++t) {
+      out.gate[t] = laneHigh[LANE_GATE + t];
+      writeStepCV(t, in, out);
+    }
+    out.stepGates = (in.steps >= UZZ_MAX_STEPS)
+                        ? stepHigh
+                        : stepHigh & (((uint64_t)1 << in.steps) - 1);
+    out.eoc = laneHigh[LANE_EOC];
+    out.moved = movedMask;
+  }
+
+private:
+  int toSamples(float seconds) const {
+    return (int)std::lround(seconds / sampleTime);
+  }
+
+  // Raises a lane for `seconds` from this sample. A lane that is already high
+  // is only ever extended, never cut short.
+  void fire(int lane, float seconds) {
+    if (probe && lane == LANE_GATE)
+      probe->onGate(now);
+    uint32_t off = now + (uint32_t)std::max(1, toSamples(seconds));
+    if (laneHigh[lane]) {
+      if (!EventScheduler<128>::before(laneOff[lane], off))
+        return;
+      events.cancel(EV_OFF, lane);
+    }
+    setLane(lane, true);
+    laneOff[lane] = off;
+    events.push(off, EV_OFF, lane);
+  }
+
+  void clearLane(int lane) {
+    if (!laneHigh[lane])
+      return;
+    events.cancel(EV_OFF, lane);
+    setLane(lane, false);
+  }
+
+  void clearLanes() {
+    for (int l = 0; l < NUM_LANES; ++l)
+      laneHigh[l] = false;
+    stepHigh = 0;
+  }
+
+  void setLane(int lane, bool high) {
+    laneHigh[lane] = high;
+    if (lane >= LANE_STEP && lane < LANE_EOC) {
+      const uint64_t bit = (uint64_t)1 << (lane - LANE_STEP);
+      stepHigh = high ? (stepHigh | bit) : (stepHigh & ~bit);
+    }
+  }
+
+  void dispatch(const SchedEvent &e, const Input &in) {
+    switch (e.type) {
+    case EV_OFF:
+      setLane(e.target, false);
+      break;
+    case EV_TICK:
+      // A late step of the previous tick still waiting plays first.
+      for (int t = 0; t < trackCount; ++t) {
+        if (tracks[t].ahead && !tracks[t].aheadEarly &&
+            events.pending(EV_PLAY, t)) {
+          events.cancel(EV_PLAY, t);
+          playAhead(t, in);
+        }
+      }
+      if (stagedPending)
+        swapStaged();
+      lastTickAt = now;
+      lastTick = (uint32_t)clock.swingPhase;
+      clock.onTick();
+      if (probe)
+        probe->onTick(now, sampleTime);
+      for (int t = 0; t < trackCount; ++t)
+        onTrackTick(t, lastTick, in);
+      break;
+    case EV_PLAY:
+      if (tracks[e.target].ahead)
+        playAhead(e.target, in);
+      break;
+    case EV_RESET:
+      for (int t = 0; t < UZZ_MAX_TRACKS; ++t) {
+        tracks[t].step = resetTarget;
+        tracks[t].playCurrentOnNextTick = true;
+        tracks[t].dropPlan();
+        events.cancel(EV_PLAY, t);
+      }
+      break;
+    case EV_RATCHET:
+      ratchet(e.target, e.arg);
+      break;
+    }
+  }
+
+  void swapStaged() {
+    std::swap(snap, staged);
+    for (int t = 0; t < UZZ_MAX_TRACKS; ++t)
+      for (int i = 0; i < stagedAccumSlots; ++i)
+        tracks[t].accumOffset[i] = stagedAccum[t][i];
+    stagedPending = false;
+    stagedSwapped = true;
+  }
+
+  // Sub-pulse j of the ratchet on track t; queues the next one.
+  void ratchet(int t, int j) {
+    UzzTrack &tr = tracks[t];
+    fire(LANE_GATE + t, tr.pulseGLen);
+    if (t == 0)
+      fire(LANE_STEP + tr.pulseStepK, tr.pulseGLen);
+    if (j + 1 < tr.pulseCount)
+      events.push(tr.pulseStart +
+                      (uint32_t)std::lround((float)(j + 1) * tr.pulseSamples),
+                  EV_RATCHET, t, j + 1);
+  }
+
+  // RESET: every track restarts from the window start — after the tick if one
+  // plays this sample, otherwise right away — and accumulators clear. Held,
+  // sustained and ratcheted steps are let go.
+  void applyReset(int start) {
+    for (int t = 0; t < UZZ_MAX_TRACKS; ++t) {
+      UzzTrack &tr = tracks[t];
+      tr.playCurrentOnNextTick = true;
+      tr.holdPulsesLeft = 0;
+      tr.pulseCount = 0;
+      events.cancel(EV_RATCHET, t);
+      events.cancel(EV_PLAY, t);
+      tr.dropPlan();
+      for (int i = 0; i < UZZ_MAX_STEPS; ++i)
+        tr.accumOffset[i] = 0;
+      clearLane(LANE_GATE + t);
+      tr.navigator.reset();
+      tr.cycle = 0;
+      tr.condPassed = false;
+      buildConditions(t);
+    }
+    for (int i = 0; i < UZZ_MAX_STEPS; ++i)
+      clearLane(LANE_STEP + i);
+    clearLane(LANE_EOC);
+
+    if (eocOnReset)
+      fire(LANE_EOC, TRIG_LEN);
+
+    resetTarget = start;
+    events.cancel(EV_RESET, 0);
+    events.push(now, EV_RESET, 0);
+
+    clock.swingPhase = 0;
+    clock.queuedBaseTicks = 0;
+    // A swung tick still waiting is dropped; one playing this sample is not.
+    events.cancelAfter(EV_TICK, 0, now);
+    clock.virtTimer = 0.f;
+    clock.pll.rearm();
+  }
+
+  void hardStop() {
+    for (int t = 0; t < UZZ_MAX_TRACKS; ++t) {
+      UzzTrack &tr = tracks[t];
+      tr.pulseCount = 0;
+      tr.holdPulsesLeft = 0;
+      tr.holdPlaying = false;
+      tr.dropPlan();
+    }
+    events.clear();
+    clearLanes();
+    clock.reset();
+  }
+
+  // Pitch and mod outputs of the current step of track t.
+  void writeStepCV(int t, const Input &in, Output &out) {
+    UzzTrack &tr = tracks[t];
+    const int step = tr.step;
+    const UzzStepSnap &st = snap[t].step[step];
+    int accum = tr.accumOffset[step];
+    float pitchV;
+    int pc = 0; // root pitch class, for scale chords
+    if (scale.active()) {
+      // Quantize the whole sum, so accumulator and transpose stay in scale.
+      const int n = scale.quantize((int)std::lround(st.semis) + in.xposeSemis +
+                                   accum + st.oct * 12);
+      pitchV = (float)n / 12.f;
+      pc = ((n % 12) + 12) % 12;
+    } else {
+      pitchV = ((st.semis + (float)in.xposeSemis + (float)accum) / 12.f) +
+               (float)st.oct;
+    }
+    const simd::float_4 target = pitchV + chords.off[st.chord][pc];
+
+    out.m1[t] = st.m1V;
+    out.m2[t] = st.m2V;
+
+    // The slew runs on every voice at once.
+    if (in.slewAlpha >= 1.f || !tr.pitchInit) {
+      tr.voiceOut = target;
+      tr.pitchInit = true;
+    } else {
+      tr.voiceOut += (target - tr.voiceOut) * in.slewAlpha;
+    }
+    out.pitch[t] = tr.voiceOut[0];
+    out.voices[t] = tr.voiceOut;
+    out.chordVoices[t] = UZZ_CHORDS[st.chord].n;
+  }
+
+  // Tick k of track t.
+  void onTrackTick(int t, uint32_t k, const Input &c) {
+    UzzTrack &tr = tracks[t];
+    if (tr.playedEarly) {
+      tr.playedEarly = false;
+      return;
+    }
+    if (tr.ahead && tr.aheadEarly) {
+      // The tick beat the early step it predicted: play it now.
+      events.cancel(EV_PLAY, t);
+      tr.aheadEarly = false;
+      playAhead(t, c);
+      return;
+    }
+    if (!tr.ahead) {
+      if (!timingOn) {
+        playStep(t, c, decideStep(t, c));
+        return;
+      }
+      tr.plan = decideStep(t, c);
+      tr.plan.tick = k;
+      tr.ahead = true;
+    }
+    const int off = offsetSamples(t, tr.plan);
+    if (off > 0)
+      events.push(now + (uint32_t)off, EV_PLAY, t);
+    else
+      playAhead(t, c);
+  }
+
+  // Plays the decided step of track t. With micro-timing on, decides the one
+  // after it right away and, if that one is early, schedules it against the
+  // predicted time of its tick (swing included).
+  void playAhead(int t, const Input &c) {
+    UzzTrack &tr = tracks[t];
+    const UzzStepPlan played = tr.plan;
+    const bool early = tr.aheadEarly;
+    tr.ahead = false;
+    tr.aheadEarly = false;
+    playStep(t, c, played);
+    tr.playedEarly = early;
+    if (!timingOn)
+      return;
+
+    tr.plan = decideStep(t, c);
+    tr.plan.tick = played.tick + 1;
+    tr.ahead = true;
+    const int off = offsetSamples(t, tr.plan);
+    if (off >= 0)
+      return;
+    const float period = clock.getVirtPeriod() / sampleTime;
+    const float swing = (1.f / 3.f) * c.swing * period;
+    auto swingOf = [swing](uint32_t k) { return (k & 1) ? swing : 0.f; };
+    const float away = (float)(tr.plan.tick - lastTick) * period +
+                       swingOf(tr.plan.tick) - swingOf(lastTick);
+    const uint32_t when = lastTickAt + (uint32_t)(std::lround(away) + off);
+    if (EventScheduler<128>::before(now, when)) {
+      events.push(when, EV_PLAY, t);
+      tr.aheadEarly = true;
+    }
+  }
+
+  int offsetSamples(int t, const UzzStepPlan &p) const {
+    const int half = periodSamples / 2;
+    return clamp(grooveOff[p.tick & 15] + microOff[t][p.step], -half, half);
+  }
+
+  void rebuildTiming() {
+    timingDirty = false;
+    timingPeriod = clock.getVirtPeriod();
+    timingSampleTime = sampleTime;
+    const float period = timingPeriod / sampleTime;
+    periodSamples = (int)std::lround(period);
+    bool any = false;
+    for (int i = 0; i < 16; ++i) {
+      any = any || grooveFrac[i] != 0.f;
+      grooveOff[i] = (int)std::lround(grooveFrac[i] * period);
+    }
+    for (int t = 0; t < UZZ_MAX_TRACKS; ++t) {
+      for (int i = 0; i < UZZ_MAX_STEPS; ++i) {
+        any = any || microFrac[t][i] != 0.f;
+        microOff[t][i] = (int)std::lround(microFrac[t][i] * period);
+      }
+    }
+    timingOn = any;
+  }
+
+  // What the next tick does to track t: a held tick, or the step it moves to
+  // and whether that step sounds. Draws the track's random numbers.
+  UzzStepPlan decideStep(int t, const Input &c) {
+    UzzTrack &tr = tracks[t];
+    const UzzTrackSnap &s = snap[t];
+    UzzStepPlan plan;
+
+    // PM_HOLD / PM_GATED: consume held ticks before advancing to the next
+    // step. RESET clears holdPulsesLeft, so a reset interrupts the hold.
+    int effMode = stepEffMode(s.step[tr.step].mode);
+    if ((effMode == PM_HOLD || effMode == PM_GATED) && tr.holdPulsesLeft > 0) {
+      --tr.holdPulsesLeft;
+      plan.hold = true;
+      plan.step = tr.step;
+      return plan;
+    }
+
+    bool allSkip = false;
+    bool wrapped = false;
+    int nextStep;
+    // Rebuilt only when the window, direction, skip steps or jump N change.
+    tr.traversal.update(c.modeDir, c.start, c.steps, s.playMask, jumpN,
+                        c.slots);
+    if (c.addressed) {
+      // Absolute step addressing: 0-10 V spans the active window and
+      // bypasses the navigator (skip modes are not consulted). EOC fires
+      // when the address falls back below the previous position.
+      int prevRel = wrapSlot(tr.step - c.start, c.slots);
+      nextStep = wrapSlot(c.start + c.relAddr, c.slots);
+      wrapped = c.relAddr < prevRel;
+    } else {
+      nextStep = tr.navigator.getNextStep(tr.step, tr.traversal,
+                                          tr.playCurrentOnNextTick, wrapped,
+                                          allSkip, tr.rng);
+    }
+
+    tr.playCurrentOnNextTick = false;
+    if (wrapped)
+      nextCycle(t);
+
+    bool muteGlobal = false;
+    if (c.modeDir == DIR_FWD || c.modeDir == DIR_REV)
+      muteGlobal = allSkip;
+    else
+      muteGlobal = tr.traversal.allSkip;
+
+    const bool playing =
+        !muteGlobal && sounds(tr, nextStep, s.step[nextStep], c);
+    plan.step = nextStep;
+    plan.wrapped = wrapped;
+    plan.playing = playing;
+    return plan;
+  }
+
+  void buildConditions(int t) {
+    UzzTrack &tr = tracks[t];
+    tr.cond.build(cond[t], condSlots, tr.cycle, condFill);
+  }
+
+  // Track t wrapped: its next cycle starts with the step it moves to.
+  void nextCycle(int t) {
+    ++tracks[t].cycle;
+    if (tracks[t].cond.any)
+      buildConditions(t);
+  }
+
+  // A step that is not muted or skipped passes its trig condition (a bit
+  // test) and then its probability roll. Steps with a condition or a roll
+  // leave their outcome for PRE / NOT PRE.
+  bool sounds(UzzTrack &tr, int i, const UzzStepSnap &st, const Input &c) {
+    if (!st.sounding)
+      return false;
+    const float p = st.prob * c.pGlobal;
+    const bool ok = tr.cond.allows(i, tr.condPassed) &&
+                    (p >= 1.f || tr.rng.uniform() < p);
+    if (((tr.cond.sets >> i) & 1) || st.prob < 1.f)
+      tr.condPassed = ok;
+    return ok;
+  }
+
+  // ADDR scan moved the address off track t's step: plays the addressed step
+  // right away, like an addressed tick. EOC fires when the address jumps from
+  // the last window position to the first. With no clock to size a gate,
+  // GATE gives a trigger.
+  void scanTo(int t, const Input &c) {
+    UzzTrack &tr = tracks[t];
+    tr.holdPulsesLeft = 0;
+    tr.playCurrentOnNextTick = false;
+    events.cancel(EV_PLAY, t);
+    tr.dropPlan();
+    UzzStepPlan plan;
+    const int prevRel = wrapSlot(tr.step - c.start, c.slots);
+    plan.step = wrapSlot(c.start + c.relAddr, c.slots);
+    plan.wrapped = prevRel == c.steps - 1 && c.relAddr == 0;
+    if (plan.wrapped)
+      nextCycle(t);
+    plan.playing = sounds(tr, plan.step, snap[t].step[plan.step], c);
+    if (c.clkConnected) {
+      playStep(t, c, plan);
+    } else {
+      Input trig = c;
+      trig.gateMode = 1;
+      playStep(t, trig, plan);
+    }
+  }
+
+  // Plays a decided tick of track t. Track 1 also drives EOC and the poly
+  // step gates.
+  void playStep(int t, const Input &c, const UzzStepPlan &plan) {
+    UzzTrack &tr = tracks[t];
+    const UzzTrackSnap &s = snap[t];
+    const bool primary = (t == 0);
+    const float period = clock.getVirtPeriod();
+    // Cancel the ratchet sub-pulses of the step being left.
+    tr.pulseCount = 0;
+    events.cancel(EV_RATCHET, t);
+
+    if (plan.hold) {
+      if (stepEffMode(s.step[tr.step].mode) == PM_HOLD && tr.holdPlaying) {
+        // PM_HOLD: re-fire a gate on each tick
+        int hk = wrapSlot(tr.step - c.start, c.slots);
+        float gLen = getGateLength(c.gateMode, s.step[tr.step].duty, period,
+                                   c.sampleTime);
+        fire(LANE_GATE + t, gLen);
+        if (primary)
+          fire(LANE_STEP + hk, gLen);
+      }
+      // PM_GATED: gate is already running long — nothing to do here
+      return;
+    }
+
+    tr.step = plan.step;
+    movedMask |= 1u << t;
+    if (plan.wrapped && primary)
+      fire(LANE_EOC, TRIG_LEN);
+
+    const int step = tr.step;
+    const UzzStepSnap &st = s.step[step];
+    const int mode = st.mode;
+    int k = wrapSlot(step - c.start, c.slots);
+
+    if (plan.playing) {
+      if (mode == SM_ACCUM_UP || mode == SM_ACCUM_DOWN) {
+        int wrap = c.accumWrap;
+        int signedAmt = (mode == SM_ACCUM_UP) ? c.accumAmt : -c.accumAmt;
+        int v = tr.accumOffset[step] + signedAmt;
+        if (wrap > 0) {
+          // Módulo sobre el rango configurado alrededor de 0.
+          int span = wrap * 2 + 1;
+          v = ((v + wrap) % span + span) % span - wrap;
+        } else {
+          // Sin wrap configurado: rango completo ±12.
+          static constexpr int ACCUM_RANGE = 25; // -12..+12 inclusive
+          v = ((v + 12) % ACCUM_RANGE + ACCUM_RANGE) % ACCUM_RANGE - 12;
+        }
+        tr.accumOffset[step] = v;
+      }
+
+      float duty = st.duty;
+      float gLen = getGateLength(c.gateMode, duty, period, c.sampleTime);
+
+      // Pulse count: right side of bipolar knob, only for pulse modes
+      // PLAY/ACCUM always use a single gate regardless of knob position
+      int pulseCount = st.pulses;
+      int newEffMode = stepEffMode(mode); // effective mode for this new step
+
+      if (newEffMode == PM_HOLD) {
+        tr.holdPulsesLeft = pulseCount - 1;
+        tr.holdPlaying = true;
+        fire(LANE_GATE + t, gLen);
+        if (primary)
+          fire(LANE_STEP + k, gLen);
+      } else if (newEffMode == PM_GATED && period > 0.f && pulseCount > 1) {
+        // Gate sustained for N clock periods; ends TRIG_LEN before next
+        // tick so the gate goes LOW briefly, allowing retrigger on the next
+        // step
+        float sustainLen =
+            std::max(TRIG_LEN, (float)pulseCount * period - TRIG_LEN);
+        // Same hard upper bound as getGateLength: prevent stuck gates.
+        if (sustainLen > 8.f)
+          sustainLen = 8.f;
+        tr.holdPulsesLeft = pulseCount - 1;
+        tr.holdPlaying = false;
+        fire(LANE_GATE + t, sustainLen);
+        if (primary)
+          fire(LANE_STEP + k, sustainLen);
+      } else {
+        // PM_PULSE (or PM_GATED with pulseCount==1): sub-gates within one
+        // period
+        tr.holdPulsesLeft = 0;
+        tr.holdPlaying = false;
+        if (pulseCount > 1 && period > 0.f) {
+          float interval = period / (float)pulseCount;
+          float pGLen = getGateLength(c.gateMode, duty, period, c.sampleTime,
+                                      interval);
+          tr.pulseStart = now;
+          tr.pulseCount = pulseCount;
+          tr.pulseSamples = interval / c.sampleTime;
+          tr.pulseGLen = pGLen;
+          tr.pulseStepK = k;
+          ratchet(t, 0);
+        } else {
+          fire(LANE_GATE + t, gLen);
+          if (primary)
+            fire(LANE_STEP + k, gLen);
+        }
+      }
+    } else {
+      tr.holdPulsesLeft = 0;
+      tr.holdPlaying = false;
+      clearLane(LANE_GATE + t);
+    }
+  }
+};
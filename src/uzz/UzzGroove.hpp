@@ -0,0 +1,50 @@
+#pragma once
+
+// Groove templates: where each 16th of a bar sits relative to the straight
+// grid, in fractions of a step (+ late, - early). Indexed by the tick's place
+// in the bar since RESET, not by step slot, so a groove keeps its feel
+// whatever the direction or window. MPC swing X% puts every second 16th at X%
+// of its 8th: (X - 50) / 50 of a step late.
+struct UzzGrooveDef {
+  const char *name;
+  float offset[16];
+};
+
+static const UzzGrooveDef UZZ_GROOVES[] = {
+    {"Off", {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}},
+    {"MPC 54%",
+     {0, .08f, 0, .08f, 0, .08f, 0, .08f, 0, .08f, 0, .08f, 0, .08f, 0,
+      .08f}},
+    {"MPC 58%",
+     {0, .16f, 0, .16f, 0, .16f, 0, .16f, 0, .16f, 0, .16f, 0, .16f, 0,
+      .16f}},
+    {"MPC 62%",
+     {0, .24f, 0, .24f, 0, .24f, 0, .24f, 0, .24f, 0, .24f, 0, .24f, 0,
+      .24f}},
+    {"MPC 66%",
+     {0, .32f, 0, .32f, 0, .32f, 0, .32f, 0, .32f, 0, .32f, 0, .32f, 0,
+      .32f}},
+    {"MPC 71%",
+     {0, .42f, 0, .42f, 0, .42f, 0, .42f, 0, .42f, 0, .42f, 0, .42f, 0,
+      .42f}},
+    // 8th-note shuffle: the off-beat 8th late, the 16th after it half as much.
+    {"Shuffle 8ths",
+     {0, 0, .4f, .2f, 0, 0, .4f, .2f, 0, 0, .4f, .2f, 0, 0, .4f, .2f}},
+    // The last 16th of every beat anticipates it.
+    {"Push",
+     {0, 0, -.04f, -.12f, 0, 0, -.04f, -.12f, 0, 0, -.04f, -.12f, 0, 0,
+      -.04f, -.12f}},
+    // Backbeats (2 and 4) dragged, off-beats a little behind.
+    {"Laid back",
+     {0, .05f, .03f, .05f, .1f, .05f, .03f, .05f, 0, .05f, .03f, .05f, .1f,
+      .05f, .03f, .05f}},
+    // A fixed, small scatter: the same every bar, so it loops like a player.
+    {"Humanize",
+     {0, .03f, -.02f, .04f, .01f, -.03f, .02f, .05f, -.01f, .02f, -.04f, .03f,
+      .02f, -.02f, .04f, .01f}},
+};
+static constexpr int UZZ_NUM_GROOVES =
+    (int)(sizeof(UZZ_GROOVES) / sizeof(UZZ_GROOVES[0]));
+
+// Micro-timing and groove together never move a step more than half a step.
+static constexpr float UZZ_MAX_MICRO = 0.5f;
@@ -0,0 +1,206 @@
+#pragma once
+
+#include "UzzRack.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+
+// Tick latency probe: how late UZZ answers its clock. While attached to the
+// engine (UzzEngine::probe) it is told, as engine sample counts, of every CLK
+// edge, every tick that plays and track 1's gate onsets, and keeps the last
+// SIZE ticks plus running statistics. Detached, the engine only tests a null
+// pointer on those events.
+//
+// Each tick is paired with the latest CLK edge no tick has claimed yet, so
+// with RATIO x2 the first tick of each pair has an edge and the second does
+// not, and with /2 every other edge goes unclaimed. A tick's gate is the
+// first onset on track 1 after it and before the next tick; a muted or
+// skipped step, or one micro-timed early, has none. Swing and micro-timing
+// are part of what is measured.
+//
+// UzzLatencyLog is the record itself; UzzLatencyProbe below is what the
+// engine writes and the menu copies from.
+struct UzzLatencyLog {
+  static constexpr int SIZE = 256;
+
+  struct Record {
+    uint32_t edge = 0; // engine sample counts
+    uint32_t tick = 0;
+    uint32_t gate = 0;
+    bool hasEdge = false;
+    bool hasGate = false;
+  };
+
+  // Running min / mean / max and standard deviation (the jitter), in samples.
+  struct Stat {
+    uint32_t n = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+    int min = 0;
+    int max = 0;
+
+    void add(int x) {
+      if (n == 0 || x < min)
+        min = x;
+      if (n == 0 || x > max)
+        max = x;
+      ++n;
+      const double d = x - mean;
+      mean += d / n;
+      m2 += d * (x - mean);
+    }
+    double jitter() const { return n > 1 ? std::sqrt(m2 / n) : 0.0; }
+  };
+
+  Record log[SIZE];
+  int head = 0; // next record to write
+  int count = 0;
+  uint32_t edge = 0;
+  bool edgePending = false; // an edge no tick has claimed yet
+  bool gatePending = false; // log[head - 1] waits for its gate
+  float sampleTime = 1.f / 44100.f;
+
+  uint32_t edges = 0;
+  uint32_t unclaimed = 0; // edges followed by another edge before a tick
+  uint32_t ticks = 0;
+  Stat edgeToTick;
+  Stat tickToGate;
+  Stat edgeToGate;
+
+  void clear() { *this = UzzLatencyLog(); }
+
+  void onEdge(uint32_t now) {
+    if (edgePending)
+      ++unclaimed;
+    edge = now;
+    edgePending = true;
+    ++edges;
+  }
+
+  void onTick(uint32_t now, float dt) {
+    sampleTime = dt;
+    Record &r = log[head];
+    r.tick = now;
+    r.edge = edge;
+    r.hasEdge = edgePending;
+    r.hasGate = false;
+    if (r.hasEdge)
+      edgeToTick.add((int)(now - edge));
+    edgePending = false;
+    gatePending = true;
+    head = (head + 1) % SIZE;
+    if (count < SIZE)
+      ++count;
+    ++ticks;
+  }
+
+  void onGate(uint32_t now) {
+    if (!gatePending)
+      return;
+    gatePending = false;
+    Record &r = log[(head + SIZE - 1) % SIZE];
+    r.gate = now;
+    r.hasGate = true;
+    tickToGate.add((int)(now - r.tick));
+    if (r.hasEdge)
+      edgeToGate.add((int)(now - r.edge));
+  }
+
+  double ms(double samples) const { return samples * sampleTime * 1000.0; }
+
+  // "min / mean / max ms, jitter ms" for the menu.
+  std::string describe(const Stat &s) const {
+    if (s.n == 0)
+      return "-";
+    return string::f("%.3f / %.3f / %.3f ms, jitter %.3f ms", ms(s.min),
+                     ms(s.mean), ms(s.max), ms(s.jitter()));
+  }
+
+  // The log, oldest first, one tick per line. Times are in samples from the
+  // first logged event; latencies in ms, empty where there is no edge or gate.
+  std::string csv() const {
+    std::string out = "edge_sample,tick_sample,gate_sample,edge_to_tick_ms,"
+                      "tick_to_gate_ms,edge_to_gate_ms\n";
+    if (count == 0)
+      return out;
+    const int first = (head + SIZE - count) % SIZE;
+    uint32_t t0 = log[first].hasEdge ? log[first].edge : log[first].tick;
+    char line[160];
+    for (int k = 0; k < count; ++k) {
+      const Record &r = log[(first + k) % SIZE];
+      std::string edgeCol, gateCol, eT, tG, eG;
+      if (r.hasEdge) {
+        edgeCol = string::f("%u", (unsigned)(r.edge - t0));
+        eT = string::f("%.4f", ms((double)(int)(r.tick - r.edge)));
+      }
+      if (r.hasGate) {
+        gateCol = string::f("%u", (unsigned)(r.gate - t0));
+        tG = string::f("%.4f", ms((double)(int)(r.gate - r.tick)));
+        if (r.hasEdge)
+          eG = string::f("%.4f", ms((double)(int)(r.gate - r.edge)));
+      }
+      std::snprintf(line, sizeof(line), "%s,%u,%s,%s,%s,%s\n", edgeCol.c_str(),
+                    (unsigned)(r.tick - t0), gateCol.c_str(), eT.c_str(),
+                    tG.c_str(), eG.c_str());
+      out += line;
+    }
+    return out;
+  }
+};
+
+// The log behind a sequence lock. The audio thread makes the count odd while
+// it writes and even again after; snapshot() copies the log on any thread
+// and tries again if the count was odd or moved meanwhile, so the menu never
+// shows a half-written record and the audio thread never waits.
+struct UzzLatencyProbe {
+  void clear() {
+    begin();
+    log.clear();
+    end();
+  }
+  void onEdge(uint32_t now) {
+    begin();
+    log.onEdge(now);
+    end();
+  }
+  void onTick(uint32_t now, float dt) {
+    begin();
+    log.onTick(now, dt);
+    end();
+  }
+  void onGate(uint32_t now) {
+    begin();
+    log.onGate(now);
+    end();
+  }
+
+  // Copies the log into `out`; false if the audio thread kept writing through
+  // every try.
+  bool snapshot(UzzLatencyLog &out, int tries = 100) const {
+    while (tries-- > 0) {
+      const uint32_t g = gen.load(std::memory_order_acquire);
+      if (g & 1)
+        continue;
+      out = log;
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (gen.load(std::memory_order_relaxed) == g)
+        return true;
+    }
+    return false;
+  }
+
+private:
+  UzzLatencyLog log;
+  std::atomic<uint32_t> gen{0};
+
+  void begin() {
+    gen.store(gen.load(std::memory_order_relaxed) + 1,
+              std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+  void end() {
+    gen.store(gen.load(std::memory_order_relaxed) + 1,
+              std::memory_order_release);
+  }
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "../plugin.hpp"
+#include "UzzTypes.hpp"
+
+// Knob display formats of the UZZ params. They are the only part of the
+// shared UZZ types that needs Rack's ParamQuantity, so they live apart from
+// the engine headers.
+struct RatioQuantity : ParamQuantity {
+  std::string getDisplayValueString() override {
+    int idx = clamp((int)std::round(getValue()), 0, NUM_RATIOS - 1);
+    return RATIO_LABELS[idx];
+  }
+  std::string getUnit() override { return ""; }
+};
+
+struct DirModeQuantity : ParamQuantity {
+  std::string getDisplayValueString() override {
+    return dirLabel(clamp((int)std::round(getValue()), DIR_MODE_MIN, DIR_MODE_MAX));
+  }
+  std::string getUnit() override { return ""; }
+};
+
+struct ProbPulseQuantity : ParamQuantity {
+  std::string getDisplayValueString() override {
+    float v = getValue();
+    if (v > 0.f)
+      return string::f("×%d", clamp(1 + (int)std::round(v), 2, 8));
+    return string::f("%d", clamp(100 + (int)std::round(v), 0, 100));
+  }
+  std::string getUnit() override {
+    return (getValue() > 0.f) ? "" : "%";
+  }
+};
+
+struct DurationQuantity : ParamQuantity {
+  std::string getDisplayValueString() override {
+    int pct = clamp((int)std::round(getValue() * 100.f), 1, 95);
+    return string::f("%d", pct);
+  }
+  std::string getUnit() override { return "%"; }
+};
@@ -0,0 +1,155 @@
+#pragma once
+
+// The few Rack helpers the UZZ engine headers use: clamp, string::f,
+// dsp::SchmittTrigger, random::Xoroshiro128Plus and simd::float_4.
+// The plugin gets Rack's own. A headless build (UZZ_HEADLESS, see tools/)
+// gets plain C++ copies with the same arithmetic, so the engine runs without
+// the SDK and replays the same seeds bit for bit.
+#ifndef UZZ_HEADLESS
+
+#include <rack.hpp>
+
+using namespace rack;
+
+#else
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace rack {
+
+inline int clamp(int x, int a = INT_MIN, int b = INT_MAX) {
+  return std::max(std::min(x, b), a);
+}
+inline float clamp(float x, float a = -INFINITY, float b = INFINITY) {
+  return std::fmax(std::fmin(x, b), a);
+}
+
+namespace string {
+inline std::string f(const char *format, ...) {
+  char buf[256];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  return buf;
+}
+} // namespace string
+
+namespace dsp {
+struct SchmittTrigger {
+  bool state = true;
+  void reset() { state = true; }
+  bool process(float in, float offThreshold = 0.f, float onThreshold = 1.f) {
+    if (state) {
+      if (in <= offThreshold)
+        state = false;
+    } else if (in >= onThreshold) {
+      state = true;
+      return true;
+    }
+    return false;
+  }
+  bool isHigh() { return state; }
+};
+} // namespace dsp
+
+namespace random {
+struct Xoroshiro128Plus {
+  uint64_t state[2] = {};
+  void seed(uint64_t s0, uint64_t s1) {
+    state[0] = s0;
+    state[1] = s1;
+    // Rack discards the first value too.
+    operator()();
+  }
+  static uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+  }
+  uint64_t operator()() {
+    const uint64_t s0 = state[0];
+    uint64_t s1 = state[1];
+    const uint64_t result = s0 + s1;
+    s1 ^= s0;
+    state[0] = rotl(s0, 55) ^ s1 ^ (s1 << 14);
+    state[1] = rotl(s1, 36);
+    return result;
+  }
+};
+} // namespace random
+
+namespace simd {
+// Lane-wise, like Rack's SSE float_4 for the operations the engine uses.
+struct float_4 {
+  float s[4];
+  float_4() {}
+  float_4(float x) { s[0] = s[1] = s[2] = s[3] = x; }
+  static float_4 load(const float *p) {
+    float_4 v;
+    for (int i = 0; i < 4; ++i)
+      v.s[i] = p[i];
+    return v;
+  }
+  void store(float *p) const {
+    for (int i = 0; i < 4; ++i)
+      p[i] = s[i];
+  }
+  float &operator[](int i) { return s[i]; }
+  const float &operator[](int i) const { return s[i]; }
+};
+inline float_4 operator+(const float_4 &a, const float_4 &b) {
+  float_4 r;
+  for (int i = 0; i < 4; ++i)
+    r.s[i] = a.s[i] + b.s[i];
+  return r;
+}
+inline float_4 operator-(const float_4 &a, const float_4 &b) {
+  float_4 r;
+  for (int i = 0; i < 4; ++i)
+    r.s[i] = a.s[i] - b.s[i];
+  return r;
+}
+inline float_4 operator*(const float_4 &a, const float_4 &b) {
+  float_4 r;
+  for (int i = 0; i < 4; ++i)
+    r.s[i] = a.s[i] * b.s[i];
+  return r;
+}
+inline float_4 &operator+=(float_4 &a, const float_4 &b) { return a = a + b; }
+inline float_4 fmax(const float_4 &a, const float_4 &b) {
+  float_4 r;
+  for (int i = 0; i < 4; ++i)
+    r.s[i] = std::fmax(a.s[i], b.s[i]);
+  return r;
+}
+// Comparisons give all-ones lanes where true, as SSE does; movemask() packs
+// their sign bits.
+inline float_4 operator>(const float_4 &a, const float_4 &b) {
+  const uint32_t ones = 0xFFFFFFFFu;
+  float_4 r;
+  for (int i = 0; i < 4; ++i)
+    if (a.s[i] > b.s[i])
+      std::memcpy(&r.s[i], &ones, sizeof(float));
+    else
+      r.s[i] = 0.f;
+  return r;
+}
+inline int movemask(const float_4 &a) {
+  int m = 0;
+  for (int i = 0; i < 4; ++i)
+    m |= (int)std::signbit(a.s[i]) << i;
+  return m;
+}
+} // namespace simd
+
+} // namespace rack
+
+using namespace rack;
+
+#endif
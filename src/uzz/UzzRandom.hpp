@@ -0,0 +1,34 @@
+#pragma once
+
+#include "UzzRack.hpp"
+
+// Seedable random stream for UZZ: the randomize banks, the per-step
+// probability rolls and the Random / Drunk directions each draw from their
+// own UzzRng instead of Rack's shared generator, so one seed replays the same
+// run and adding a track or pressing a randomize button never shifts the
+// rolls of another track.
+struct UzzRng {
+  random::Xoroshiro128Plus gen;
+
+  // Stream k of a seed. Same scattering as SideChain's per-voice streams.
+  void seed(uint64_t seed, int stream) {
+    const uint64_t k = (uint64_t)(stream + 1);
+    gen.seed(seed + 0x9E3779B97F4A7C15ULL * k, (seed ^ k) + 1);
+  }
+
+  // [0, 1) from the top 24 bits; Xoroshiro128Plus has weak low bits.
+  float uniform() { return (float)(gen() >> 40) * (1.f / 16777216.f); }
+
+  // n values in [0, 1), two per 64-bit draw (bits 40..63 and 16..39), for
+  // filling a whole row at once.
+  void fill(float *out, int n) {
+    int i = 0;
+    for (; i + 1 < n; i += 2) {
+      const uint64_t r = gen();
+      out[i] = (float)(r >> 40) * (1.f / 16777216.f);
+      out[i + 1] = (float)((r >> 16) & 0xFFFFFF) * (1.f / 16777216.f);
+    }
+    if (i < n)
+      out[i] = uniform();
+  }
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "UzzRack.hpp"
+
+// Built-in pitch quantizer. Scales are listed without the octave, the same
+// way as ACID_SCALES in AcidGen.hpp; entry 0 is "Off" and leaves the pitch
+// outputs exactly as they were.
+struct UzzScaleDef {
+  const char *name;
+  int n;
+  int8_t s[12];
+};
+
+static const UzzScaleDef UZZ_SCALES[] = {
+    {"Off (chromatic)", 12, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}},
+    {"Major", 7, {0, 2, 4, 5, 7, 9, 11}},
+    {"Natural minor", 7, {0, 2, 3, 5, 7, 8, 10}},
+    {"Harmonic minor", 7, {0, 2, 3, 5, 7, 8, 11}},
+    {"Dorian", 7, {0, 2, 3, 5, 7, 9, 10}},
+    {"Phrygian", 7, {0, 1, 3, 5, 7, 8, 10}},
+    {"Lydian", 7, {0, 2, 4, 6, 7, 9, 11}},
+    {"Mixolydian", 7, {0, 2, 4, 5, 7, 9, 10}},
+    {"Major pentatonic", 5, {0, 2, 4, 7, 9}},
+    {"Minor pentatonic", 5, {0, 3, 5, 7, 10}},
+    {"Blues", 6, {0, 3, 5, 6, 7, 10}},
+};
+static constexpr int UZZ_NUM_SCALES =
+    (int)(sizeof(UZZ_SCALES) / sizeof(UZZ_SCALES[0]));
+
+static const char *const UZZ_NOTE_NAMES[12] = {
+    "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+
+// Semitone -> in-scale semitone, for one root and scale. Rebuilt by set()
+// only when either changes; the engine then pays one table read per track
+// and sample. Inputs are whole semitones relative to 0 V; a note between two
+// scale notes goes to the nearer one, the lower on a tie.
+struct UzzScaleLut {
+  static constexpr int SIZE = 128;
+  static constexpr int CENTER = 64; // entry CENTER is 0 V
+
+  int root = 0;  // 0 = C
+  int scale = 0; // index in UZZ_SCALES; 0 = off
+  int8_t note[SIZE];
+  bool in[12]; // pitch class is in the scale
+
+  UzzScaleLut() { set(0, 0); }
+
+  bool active() const { return scale != 0; }
+
+  void set(int newRoot, int newScale) {
+    root = ((newRoot % 12) + 12) % 12;
+    scale = clamp(newScale, 0, UZZ_NUM_SCALES - 1);
+    const UzzScaleDef &def = UZZ_SCALES[scale];
+    for (int pc = 0; pc < 12; ++pc)
+      in[pc] = false;
+    for (int k = 0; k < def.n; ++k)
+      in[(def.s[k] + root) % 12] = true;
+    for (int i = 0; i < SIZE; ++i) {
+      const int n = i - CENTER;
+      int q = n;
+      for (int d = 0; d < 12; ++d) {
+        if (in[((n - d) % 12 + 12) % 12]) {
+          q = n - d;
+          break;
+        }
+        if (in[((n + d) % 12 + 12) % 12]) {
+          q = n + d;
+          break;
+        }
+      }
+      note[i] = (int8_t)q;
+    }
+  }
+
+  // Quantized semitone of n. The table covers -64..63; further out, n is
+  // folded by octaves, which gives the same result.
+  int quantize(int n) const {
+    int shift = 0;
+    while (n < -CENTER) {
+      n += 12;
+      shift -= 12;
+    }
+    while (n >= SIZE - CENTER) {
+      n -= 12;
+      shift += 12;
+    }
+    return note[n + CENTER] + shift;
+  }
+
+  // The note `steps` scale notes above n.
+  int stepUp(int n, int steps) const {
+    for (int k = 0; k < steps; ++k) {
+      do
+        ++n;
+      while (!in[((n % 12) + 12) % 12]);
+    }
+    return n;
+  }
+};
+
+// CV record: the note a REC PITCH voltage v writes into a step, as the OCT
+// (-2..2) and PITCH (0..pitchRange) rows hold it. Rounded to the semitone and
+// to the scale, when one is set. Notes out of range become the nearest
+// in-scale note inside it: quantizing the range's end can land past it.
+inline void uzzRecordNote(float v, int pitchRange, const UzzScaleLut &scale,
+                          int &oct, int &pitch) {
+  const int lo = -24, hi = 24 + pitchRange;
+  int n = clamp((int)std::lround(clamp(v, -10.f, 10.f) * 12.f), lo, hi);
+  if (scale.active()) {
+    n = scale.quantize(n);
+    if (n < lo)
+      n = scale.stepUp(n, 1);
+    while (n > hi || !scale.in[((n % 12) + 12) % 12])
+      --n;
+  }
+  oct = clamp((n + 24) / 12 - 2, -2, 2);
+  pitch = n - 12 * oct;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "UzzTracks.hpp"
+
+// ADDR scan: UZZ-X ADDR (0-10 V over the active window) picks the step every
+// sample instead of on clock ticks. The band of CV each window position
+// answers to is worked out once per window length; a sample then costs one
+// compare against the current position's band, and a multiply only when the
+// CV leaves it. Bands reach HYST of a step into their neighbours, so a CV
+// resting on a boundary, or a noisy one, does not chatter between two steps.
+struct UzzAddrScan {
+  static constexpr float HYST = 0.2f; // of a step, each side
+
+  int steps = 0;
+  int rel = 0;         // current window position
+  float perVolt = 0.f; // window positions per volt
+  float lo[UZZ_MAX_STEPS];
+  float hi[UZZ_MAX_STEPS];
+
+  void setSteps(int n) {
+    steps = n;
+    perVolt = (n > 1) ? (float)(n - 1) / 10.f : 0.f;
+    for (int k = 0; k < n && n > 1; ++k) {
+      lo[k] = ((float)k - 0.5f - HYST) / perVolt;
+      hi[k] = ((float)k + 0.5f + HYST) / perVolt;
+    }
+    rel = (n > 1) ? clamp(rel, 0, n - 1) : 0;
+  }
+
+  // Window position for v volts in a window of n steps. Without the
+  // hysteresis this is the same rounding clocked ADDR uses.
+  int process(float v, int n) {
+    if (n != steps)
+      setSteps(n);
+    if (steps <= 1)
+      return 0;
+    if (v < lo[rel] || v >= hi[rel])
+      rel = clamp((int)std::lround(v * perVolt), 0, steps - 1);
+    return rel;
+  }
+};
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "UzzEngine.hpp"
+
+// Pattern snapshots: 32 slots, each a packed copy of every step row and
+// accumulator offset of all eight tracks, over every slot of the chain it was
+// stored on. Stored on demand, recalled on the next step boundary, and saved
+// in the patch as one hex string per used slot.
+static constexpr int UZZ_NUM_SNAPSHOTS = 32;
+
+// One step of one track in 12 bytes. The integer rows are kept as they are;
+// DUR, MOD1 and MOD2 are 16-bit fractions of their knob range.
+struct UzzPackedStep {
+  uint16_t dur = 32767;
+  uint16_t m1 = 0;
+  uint16_t m2 = 0;
+  int8_t pitch = 0;
+  int8_t oct = 0;
+  int8_t mode = SM_PLAY;
+  int8_t prob = 0;
+  int8_t accum = 0;
+
+  static uint16_t toU16(float v, float lo, float hi) {
+    return (uint16_t)std::round(clamp((v - lo) / (hi - lo), 0.f, 1.f) *
+                                65535.f);
+  }
+  static float fromU16(uint16_t v, float lo, float hi) {
+    return lo + (hi - lo) * (float)v / 65535.f;
+  }
+
+  void pack(const float raw[NUM_STEP_ROWS], int accumOffset) {
+    pitch = (int8_t)clamp((int)std::round(raw[ROW_PITCH]), 0, 23);
+    oct = (int8_t)clamp((int)std::round(raw[ROW_OCT]), -2, 2);
+    mode = (int8_t)clamp((int)std::round(raw[ROW_MODE]), 0, 7);
+    dur = toU16(raw[ROW_DUR], 0.f, 1.f);
+    m1 = toU16(raw[ROW_M1], 0.f, 10.f);
+    m2 = toU16(raw[ROW_M2], 0.f, 10.f);
+    prob = (int8_t)clamp((int)std::round(raw[ROW_PROB]), -100, 7);
+    accum = (int8_t)clamp(accumOffset, -12, 12);
+  }
+
+  void unpack(float raw[NUM_STEP_ROWS]) const {
+    raw[ROW_PITCH] = (float)pitch;
+    raw[ROW_OCT] = (float)oct;
+    raw[ROW_MODE] = (float)mode;
+    raw[ROW_DUR] = fromU16(dur, 0.f, 1.f);
+    raw[ROW_M1] = fromU16(m1, 0.f, 10.f);
+    raw[ROW_M2] = fromU16(m2, 0.f, 10.f);
+    raw[ROW_PROB] = (float)prob;
+  }
+};
+
+struct UzzSnapshot {
+  bool used = false;
+  int slots = 16; // 16 per module of the chain it was stored on
+  UzzPackedStep step[UZZ_MAX_TRACKS][UZZ_MAX_STEPS];
+
+  // Packs the first n slots of every track: value(t, row, i) reads a step
+  // row, the accumulator offsets come from the engine's tracks.
+  template <typename Value>
+  void store(const UzzEngine &engine, int n, Value value) {
+    float raw[NUM_STEP_ROWS];
+    for (int t = 0; t < UZZ_MAX_TRACKS; ++t)
+      for (int i = 0; i < n; ++i) {
+        for (int r = 0; r < NUM_STEP_ROWS; ++r)
+          raw[r] = value(t, r, i);
+        step[t][i].pack(raw, engine.tracks[t].accumOffset[i]);
+      }
+    slots = n;
+    used = true;
+  }
+
+  // Blend target of step i of track t for MORPH; false past the slots held.
+  bool target(int t, int i, float raw[NUM_STEP_ROWS]) const {
+    if (i >= slots)
+      return false;
+    step[t][i].unpack(raw);
+    return true;
+  }
+
+  // Compiles the snapshot into engine.staged over a chain of chainSlots and
+  // commits it. Slots the snapshot holds are recalled, PITCH capped at
+  // pitchMax; slots it does not (a chain longer than the one it was stored
+  // on) carry over. compile(s, t, i) compiles step i of track t from s.raw.
+  template <typename Compile>
+  void stage(UzzEngine &engine, int chainSlots, int pitchMax,
+             Compile compile) const {
+    const int n = std::min(slots, chainSlots);
+    float raw[NUM_STEP_ROWS];
+    for (int t = 0; t < UZZ_MAX_TRACKS; ++t) {
+      UzzTrackSnap &s = engine.staged[t];
+      const UzzTrackSnap &cur = engine.snap[t];
+      s.playMask = cur.playMask;
+      for (int i = n; i < UZZ_MAX_STEPS; ++i) {
+        for (int r = 0; r < NUM_STEP_ROWS; ++r)
+          s.raw[r][i] = cur.raw[r][i];
+        s.step[i] = cur.step[i];
+      }
+      for (int i = 0; i < n; ++i) {
+        step[t][i].unpack(raw);
+        raw[ROW_PITCH] = std::min(raw[ROW_PITCH], (float)pitchMax);
+        for (int r = 0; r < NUM_STEP_ROWS; ++r)
+          s.raw[r][i] = raw[r];
+        compile(s, t, i);
+        engine.stagedAccum[t][i] = step[t][i].accum;
+      }
+      s.valid = true;
+    }
+    engine.stagedAccumSlots = n;
+    engine.commitStaged();
+  }
+
+  // 20 hex characters per step (pitch, oct, mode, prob, dur, m1, m2,
+  // accumulator), tracks in order, each over all its slots.
+  static constexpr int HEX_PER_STEP = 20;
+
+  std::string toHex() const {
+    std::string hex;
+    hex.reserve(UZZ_MAX_TRACKS * slots * HEX_PER_STEP);
+    for (int t = 0; t < UZZ_MAX_TRACKS; ++t)
+      for (int i = 0; i < slots; ++i) {
+        const UzzPackedStep &s = step[t][i];
+        hex += string::f("%02x%x%x%02x%04x%04x%04x%02x", s.pitch, s.oct + 2,
+                         s.mode, s.prob + 100, s.dur, s.m1, s.m2,
+                         s.accum + 12);
+      }
+    return hex;
+  }
+
+  // The slot count follows from the length: 16, 32, 48 or 64 per track.
+  bool fromHex(const char *hex) {
+    if (!hex)
+      return false;
+    const size_t perModule = UZZ_MAX_TRACKS * 16 * HEX_PER_STEP;
+    const size_t len = std::strlen(hex);
+    if (len == 0 || len % perModule != 0 ||
+        len / perModule > (size_t)(UZZ_MAX_STEPS / 16))
+      return false;
+    const int n = (int)(len / perModule) * 16;
+    auto hexValue = [](const char *s, int n) {
+      unsigned v = 0;
+      for (int i = 0; i < n; ++i) {
+        const char c = s[i];
+        v = v * 16 + (c >= '0' && c <= '9'   ? c - '0'
+                      : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                      : c >= 'A' && c <= 'F' ? c - 'A' + 10
+                                             : 0);
+      }
+      return v;
+    };
+    for (int t = 0; t < UZZ_MAX_TRACKS; ++t)
+      for (int i = 0; i < n; ++i) {
+        const char *h = hex + (t * n + i) * HEX_PER_STEP;
+        UzzPackedStep &s = step[t][i];
+        s.pitch = (int8_t)clamp((int)hexValue(h, 2), 0, 23);
+        s.oct = (int8_t)clamp((int)hexValue(h + 2, 1) - 2, -2, 2);
+        s.mode = (int8_t)clamp((int)hexValue(h + 3, 1), 0, 7);
+        s.prob = (int8_t)clamp((int)hexValue(h + 4, 2) - 100, -100, 7);
+        s.dur = (uint16_t)hexValue(h + 6, 4);
+        s.m1 = (uint16_t)hexValue(h + 10, 4);
+        s.m2 = (uint16_t)hexValue(h + 14, 4);
+        s.accum = (int8_t)clamp((int)hexValue(h + 18, 2) - 12, -12, 12);
+      }
+    slots = n;
+    used = true;
+    return true;
+  }
+};
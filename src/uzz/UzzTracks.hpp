@@ -0,0 +1,198 @@
+#pragma once
+
+#include "StepNavigator.hpp"
+#include "UzzCond.hpp"
+#include "UzzTypes.hpp"
+
+// Multi-track support. One UZZ runs up to UZZ_MAX_TRACKS sequencer tracks off
+// the same clock, reset and window; each track has its own 16 steps of pitch,
+// octave, mode, duration, mod and probability data, and comes out on its own
+// channel of the PITCH / GATE / MOD1 / MOD2 poly cables.
+static constexpr int UZZ_MAX_TRACKS = 8;
+
+// Chaining: up to UZZ_MAX_CHAIN modules side by side play as one sequence of
+// up to UZZ_MAX_STEPS slots, driven by the leftmost one (see UzzChain.hpp).
+// The engine's per-slot tables are sized for the longest chain.
+static constexpr int UZZ_MAX_CHAIN = 4;
+static constexpr int UZZ_MAX_STEPS = 16 * UZZ_MAX_CHAIN;
+
+// The seven per-step rows, in the order the panel lists them.
+enum StepRow {
+  ROW_PITCH,
+  ROW_OCT,
+  ROW_MODE,
+  ROW_DUR,
+  ROW_M1,
+  ROW_M2,
+  ROW_PROB,
+  NUM_STEP_ROWS
+};
+
+static constexpr float STEP_ROW_DEFAULTS[NUM_STEP_ROWS] = {
+    0.f, 0.f, (float)SM_PLAY, 0.50f, 0.f, 0.f, 0.f};
+// JSON keys of the rows in each saved track.
+static constexpr const char *STEP_ROW_KEYS[NUM_STEP_ROWS] = {
+    "pitch", "oct", "mode", "dur", "m1", "m2", "prob"};
+
+// Step data of every track, stored as value[row][track][step]: one row of one
+// track is a contiguous run of 16 floats, the same shape as a panel row, so
+// swapping the edit track in and out is a straight copy per row. The track
+// being edited lives in the module params instead; its slot here is stale
+// until the edit track changes.
+struct UzzTrackBank {
+  float value[NUM_STEP_ROWS][UZZ_MAX_TRACKS][16];
+
+  UzzTrackBank() { reset(); }
+
+  void reset() {
+    for (int r = 0; r < NUM_STEP_ROWS; ++r)
+      resetRow(r);
+  }
+
+  void resetRow(int r) {
+    for (int t = 0; t < UZZ_MAX_TRACKS; ++t)
+      for (int i = 0; i < 16; ++i)
+        value[r][t][i] = STEP_ROW_DEFAULTS[r];
+  }
+};
+
+// What one clock tick does to a track, decided before it plays so that a
+// step with negative micro-timing can sound ahead of its tick.
+struct UzzStepPlan {
+  uint32_t tick = 0;    // tick index since RESET it belongs to
+  bool hold = false;    // a HOLD / GATED step using up one of its ticks
+  int step = 0;         // slot to move to
+  bool wrapped = false; // the move wrapped the window (EOC)
+  bool playing = false; // sounds: not muted, skipped or lost to probability
+};
+
+// Runtime state a track keeps between clock ticks. Everything that is not
+// per track (clock, window, direction, swing, EOC, the gate outputs and their
+// scheduled events) stays in the engine.
+struct UzzTrack {
+  int step = 0;
+  simd::float_4 voiceOut = 0.f; // pitch of every chord voice, slewed
+  bool pitchInit = false;
+
+  StepNavigator navigator;
+  StepTraversal<UZZ_MAX_STEPS> traversal;
+  UzzRng rng; // probability rolls and RANDOM / DRUNK moves
+
+  bool playCurrentOnNextTick = false;
+
+  int accumOffset[UZZ_MAX_STEPS] = {};
+
+  // Ratchet of the current step (PM_PULSE): sub-pulse j of pulseCount plays
+  // at sample pulseStart + round(j * pulseSamples).
+  uint32_t pulseStart = 0;
+  int pulseCount = 0;
+  float pulseSamples = 0.f;
+  float pulseGLen = 0.f;
+  int pulseStepK = 0;
+
+  // Hold state (PM_HOLD / PM_GATED)
+  int holdPulsesLeft = 0;
+  bool holdPlaying = false;
+
+  // Micro-timing lookahead. ahead: plan is decided and waits to play;
+  // aheadEarly: its EV_PLAY is scheduled before its tick; playedEarly: it
+  // already played and its tick is still to come.
+  UzzStepPlan plan;
+  bool ahead = false;
+  bool aheadEarly = false;
+  bool playedEarly = false;
+
+  // Trig conditions: cycles since RESET, this cycle's compiled masks and
+  // whether the last conditional step sounded (PRE).
+  uint32_t cycle = 0;
+  UzzCondMask cond;
+  bool condPassed = false;
+
+  void dropPlan() {
+    ahead = false;
+    aheadEarly = false;
+    playedEarly = false;
+  }
+
+  void reset(int start) {
+    step = start;
+    voiceOut = 0.f;
+    pitchInit = false;
+    navigator.reset();
+    playCurrentOnNextTick = false;
+    for (int i = 0; i < UZZ_MAX_STEPS; ++i)
+      accumOffset[i] = 0;
+    pulseCount = 0;
+    holdPulsesLeft = 0;
+    holdPlaying = false;
+    dropPlan();
+    cycle = 0;
+    condPassed = false;
+  }
+};
+
+// One step of one track, compiled from its raw row values: everything the
+// audio path needs, already rounded, clamped and mapped.
+struct UzzStepSnap {
+  int mode = SM_PLAY;
+  bool sounding = true; // PLAY, ACCUM, PULSE, GATED or HOLD
+  float semis = 0.f;
+  int oct = 0;
+  float m1V = 0.f;
+  float m2V = 0.f;
+  float duty = 0.50f; // clamped to 0.01..0.95
+  float prob = 1.f;   // step probability, 0..1
+  int pulses = 1;     // ratchet / hold count, 1 outside the pulse modes
+  int chord = 0;      // index in UZZ_CHORDS
+};
+
+// Compiled step table of a track plus the raw values it was built from, so
+// change detection is a compare against raw and only changed steps rebuild.
+// Slots 16 and up only hold data while the module leads a chain.
+struct UzzTrackSnap {
+  float raw[NUM_STEP_ROWS][UZZ_MAX_STEPS];
+  UzzStepSnap step[UZZ_MAX_STEPS];
+  uint64_t playMask = ~0ULL; // bit i set when step i is not SKIP
+  bool valid = false;         // false: rebuild every step on the next check
+};
+
+// Compiles step i of s from s.raw. With morph > 0, pitch, duration and the
+// two mods are blended toward `target` (a step's row values, pitch rounded
+// back onto the semitone grid); chord is the step's UZZ_CHORDS index.
+static inline void compileStepSnap(UzzTrackSnap &s, int i, const float *target,
+                                   float morph, int m1Range, int m2Range,
+                                   int chord) {
+  UzzStepSnap &st = s.step[i];
+  const int mode = (int)std::round(s.raw[ROW_MODE][i]);
+  const bool pulseMode = (mode == SM_PULSE || mode == SM_GATED ||
+                          mode == SM_HOLD);
+  st.mode = mode;
+  st.sounding = pulseMode || mode == SM_PLAY || mode == SM_ACCUM_UP ||
+                mode == SM_ACCUM_DOWN;
+  float pitch = s.raw[ROW_PITCH][i];
+  float dur = s.raw[ROW_DUR][i];
+  float m1 = s.raw[ROW_M1][i];
+  float m2 = s.raw[ROW_M2][i];
+  if (morph > 0.f && target) {
+    pitch = std::round(pitch + (target[ROW_PITCH] - pitch) * morph);
+    dur += (target[ROW_DUR] - dur) * morph;
+    m1 += (target[ROW_M1] - m1) * morph;
+    m2 += (target[ROW_M2] - m2) * morph;
+  }
+  st.semis = pitch;
+  st.oct = (int)std::round(s.raw[ROW_OCT][i]);
+  st.m1V = UZZRanges::mapMod0_10ToRange(m1, m1Range);
+  st.m2V = UZZRanges::mapMod0_10ToRange(m2, m2Range);
+  st.duty = clamp(dur, 0.01f, 0.95f);
+  // Bipolar prob/pulse knob: <=0 = probability 0–100%, >0 = pulse count
+  // (only for SM_PULSE/GATED/HOLD) at 100%.
+  float pp = s.raw[ROW_PROB][i];
+  st.prob = (pp <= 0.f) ? clamp((100.f + pp) / 100.f, 0.f, 1.f) : 1.f;
+  st.pulses =
+      (pulseMode && pp > 0.f) ? clamp(1 + (int)std::round(pp), 2, 8) : 1;
+  st.chord = chord;
+  if (mode != SM_SKIP)
+    s.playMask |= (uint64_t)1 << i;
+  else
+    s.playMask &= ~((uint64_t)1 << i);
+}
@@ -1,6 +1,6 @@
 #pragma once
 
-#include "../plugin.hpp"
+#include "UzzRack.hpp"
 
 static inline int wrap16(int x) { return x & 15; }
 
@@ -34,14 +34,6 @@ static constexpr const char *RATIO_LABELS[NUM_RATIOS] = {
     "÷3",  "÷2.5", "÷2",  "÷1.5", "×1",  "×1.5", "×2",  "×2.5", "×3", "×4",
     "×5",  "×6",   "×8",  "×10",  "×12", "×16",  "×24", "×32",  "×48"};
 
-struct RatioQuantity : ParamQuantity {
-  std::string getDisplayValueString() override {
-    int idx = clamp((int)std::round(getValue()), 0, NUM_RATIOS - 1);
-    return RATIO_LABELS[idx];
-  }
-  std::string getUnit() override { return ""; }
-};
-
 enum DirectionMode {
   DIR_PENDULUM = -2,
   DIR_REV = -1,
@@ -87,33 +79,6 @@ static inline const char *dirShort(int v) {
   }
 }
 
-struct DirModeQuantity : ParamQuantity {
-  std::string getDisplayValueString() override {
-    return dirLabel(clamp((int)std::round(getValue()), DIR_MODE_MIN, DIR_MODE_MAX));
-  }
-  std::string getUnit() override { return ""; }
-};
-
-struct ProbPulseQuantity : ParamQuantity {
-  std::string getDisplayValueString() override {
-    float v = getValue();
-    if (v > 0.f)
-      return string::f("×%d", clamp(1 + (int)std::round(v), 2, 8));
-    return string::f("%d", clamp(100 + (int)std::round(v), 0, 100));
-  }
-  std::string getUnit() override {
-    return (getValue() > 0.f) ? "" : "%";
-  }
-};
-
-struct DurationQuantity : ParamQuantity {
-  std::string getDisplayValueString() override {
-    int pct = clamp((int)std::round(getValue() * 100.f), 1, 95);
-    return string::f("%d", pct);
-  }
-  std::string getUnit() override { return "%"; }
-};
-
 namespace UZZRanges {
 enum ModRange {
   MR_PM10,
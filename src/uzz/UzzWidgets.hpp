@@ -4,6 +4,8 @@
 #include "UzzLayout.hpp"
 #include "UzzTypes.hpp"
 
+#include <climits>
+
 using AnimatekUI::displayBlue;
 using AnimatekUI::drawScaled;
 using AnimatekUI::loadPluginSvg;
@@ -83,64 +85,82 @@ struct RowShiftDownButton : RowShiftButton {
   }
 };
 
-// Arc knob — a RoundSmallBlackKnob with a value-indicator arc around it.
-// Matches the "ring of progress" look from the original UZZ.
-struct UzzArcKnob : RoundSmallBlackKnob {
+// Value-indicator arc around a knob ("ring of progress", as in the original
+// UZZ). It lives in the knob's framebuffer, under the knob body, so it is
+// rasterized together with the knob when the value changes and costs nothing
+// on an idle frame.
+struct UzzKnobArc : TransparentWidget {
+  static constexpr float PAD = 4.f; // room for the ring around the knob box
+  ParamWidget *knob = nullptr;
+
+  explicit UzzKnobArc(ParamWidget *k) : knob(k) {
+    box.pos = Vec(-PAD, -PAD);
+    box.size = k->box.size.plus(Vec(2.f * PAD, 2.f * PAD));
+  }
+
   void draw(const DrawArgs &args) override {
-    // 1) Draw the value arc BEHIND the knob body.
-    if (auto q = getParamQuantity()) {
-      float minV = q->getMinValue();
-      float maxV = q->getMaxValue();
-      if (maxV > minV) {
-        float val = q->getValue();
-        NVGcontext *vg = args.vg;
-        float cx = box.size.x * 0.5f;
-        float cy = box.size.y * 0.5f;
-        float r = box.size.x * 0.5f + 2.0f;
-
-        // Knob sweep in NanoVG coords (Y-down): bottom-left → bottom-right CW,
-        // 270°.
-        const float a0 = 0.75f * (float)M_PI;
-        const float sweep = 1.5f * (float)M_PI;
-
-        // Track (faint full arc).
-        nvgBeginPath(vg);
-        nvgArc(vg, cx, cy, r, a0, a0 + sweep, NVG_CW);
-        nvgStrokeColor(vg, nvgRGBA(0xFF, 0xFF, 0xFF, 40));
-        nvgStrokeWidth(vg, 1.4f);
-        nvgLineCap(vg, NVG_ROUND);
-        nvgStroke(vg);
-
-        // Value arc.
-        bool bipolar = (minV < 0.f && maxV > 0.f);
-        float t0, t1;
-        if (bipolar) {
-          float zeroT = (0.f - minV) / (maxV - minV);
-          float curT = (val - minV) / (maxV - minV);
-          t0 = std::min(zeroT, curT);
-          t1 = std::max(zeroT, curT);
-        } else {
-          t0 = 0.f;
-          t1 = (val - minV) / (maxV - minV);
-        }
-        if (t1 > t0 + 1e-4f) {
-          nvgBeginPath(vg);
-          nvgArc(vg, cx, cy, r, a0 + t0 * sweep, a0 + t1 * sweep, NVG_CW);
-          nvgStrokeColor(vg, nvgRGBA(0x2C, 0x7F, 0xFF, 230));
-          nvgStrokeWidth(vg, 1.8f);
-          nvgLineCap(vg, NVG_ROUND);
-          nvgStroke(vg);
-        }
-      }
+    auto q = knob->getParamQuantity();
+    if (!q)
+      return;
+    float minV = q->getMinValue();
+    float maxV = q->getMaxValue();
+    if (maxV <= minV)
+      return;
+    float val = q->getValue();
+    NVGcontext *vg = args.vg;
+    float cx = box.size.x * 0.5f;
+    float cy = box.size.y * 0.5f;
+    float r = knob->box.size.x * 0.5f + 2.0f;
+
+    // Knob sweep in NanoVG coords (Y-down): bottom-left → bottom-right CW,
+    // 270°.
+    const float a0 = 0.75f * (float)M_PI;
+    const float sweep = 1.5f * (float)M_PI;
+
+    // Track (faint full arc).
+    nvgBeginPath(vg);
+    nvgArc(vg, cx, cy, r, a0, a0 + sweep, NVG_CW);
+    nvgStrokeColor(vg, nvgRGBA(0xFF, 0xFF, 0xFF, 40));
+    nvgStrokeWidth(vg, 1.4f);
+    nvgLineCap(vg, NVG_ROUND);
+    nvgStroke(vg);
+
+    // Value arc.
+    bool bipolar = (minV < 0.f && maxV > 0.f);
+    float t0, t1;
+    if (bipolar) {
+      float zeroT = (0.f - minV) / (maxV - minV);
+      float curT = (val - minV) / (maxV - minV);
+      t0 = std::min(zeroT, curT);
+      t1 = std::max(zeroT, curT);
+    } else {
+      t0 = 0.f;
+      t1 = (val - minV) / (maxV - minV);
+    }
+    if (t1 > t0 + 1e-4f) {
+      nvgBeginPath(vg);
+      nvgArc(vg, cx, cy, r, a0 + t0 * sweep, a0 + t1 * sweep, NVG_CW);
+      nvgStrokeColor(vg, nvgRGBA(0x2C, 0x7F, 0xFF, 230));
+      nvgStrokeWidth(vg, 1.8f);
+      nvgLineCap(vg, NVG_ROUND);
+      nvgStroke(vg);
     }
-    // 2) Draw the knob on top.
-    RoundSmallBlackKnob::draw(args);
   }
 };
 
+// Arc knob — a RoundSmallBlackKnob with a value-indicator arc around it.
+// SvgKnob marks its framebuffer dirty on every value change, which now
+// redraws the arc as well.
+struct UzzArcKnob : RoundSmallBlackKnob {
+  UzzArcKnob() { fb->addChildBottom(new UzzKnobArc(this)); }
+};
+
 // Bipolar Trimpot: value 0 always at center regardless of range asymmetry.
 // Left side maps to [minV, 0], right side maps to [0, maxV], each filling half the sweep.
+// The framebuffer is only redrawn when the angle actually moves.
 struct ProbPulseKnob : Trimpot {
+  float syncedAngle = NAN;
+
   void syncAngle() {
     auto* pq = getParamQuantity();
     if (fb && tw && pq) {
@@ -151,6 +171,9 @@ struct ProbPulseKnob : Trimpot {
           ? math::rescale(v, vMin, 0.f, 0.f, 0.5f)
           : math::rescale(v, 0.f, vMax, 0.5f, 1.f);
       float angle = math::rescale(t, 0.f, 1.f, minAngle, maxAngle);
+      if (angle == syncedAngle)
+        return;
+      syncedAngle = angle;
       tw->identity();
       tw->rotate(angle, sw->box.size.div(2));
       fb->dirty = true;
@@ -191,7 +214,10 @@ struct StepModeButton : app::SvgSwitch {
 };
 
 // Dark rounded-rect background + blue text. Subclasses override drawContent
-// to render text on top with the font/color/alignment already set.
+// to render text on top with the font/color/alignment already set. The text
+// sits on the light layer, which a framebuffer would not keep lit, so it is
+// drawn every frame; update() rebuilds the strings only when what they show
+// changed.
 struct BasicDisplay : TransparentWidget {
   UZZ *module = nullptr;
 
@@ -218,11 +244,20 @@ struct BasicDisplay : TransparentWidget {
     drawContent(args.vg);
   }
 
+  void step() override {
+    update();
+    TransparentWidget::step();
+  }
+
+  virtual void update() = 0;
   virtual void drawContent(NVGcontext *vg) = 0;
 };
 
 struct ParamDisplay : BasicDisplay {
   int paramId = 0;
+  float shownValue = 0.f;
+  int shownJump = 0;
+  std::string text;
 
   ParamDisplay(Vec pos, Vec size, UZZ *m, int pid)
       : BasicDisplay(pos, size, m), paramId(pid) {}
@@ -243,7 +278,7 @@ struct ParamDisplay : BasicDisplay {
     case UZZ::DIR_MODE_PARAM: {
       int dv = (int)std::round(v);
       if (dv == DIR_JUMP)
-        return string::f("J\xc3\xb7%d", module->jumpN);
+        return string::f("J\xc3\xb7%d", module->engine.jumpN);
       return dirShort(dv);
     }
     case UZZ::SWING_PARAM: {
@@ -265,27 +300,46 @@ struct ParamDisplay : BasicDisplay {
     }
   }
 
+  void update() override {
+    float v = module ? module->params[paramId].getValue() : 0.f;
+    int jump = module ? module->engine.jumpN : 0;
+    if (!text.empty() && v == shownValue && jump == shownJump)
+      return;
+    shownValue = v;
+    shownJump = jump;
+    text = formatValue();
+  }
+
   void drawContent(NVGcontext *vg) override {
     nvgFontSize(vg, 9.5f);
-    std::string txt = formatValue();
-    nvgText(vg, box.size.x * 0.5f, box.size.y * 0.5f, txt.c_str(), nullptr);
+    nvgText(vg, box.size.x * 0.5f, box.size.y * 0.5f, text.c_str(), nullptr);
   }
 };
 
 // Muestra en dos líneas: semitones (arriba) y clip count (abajo).
 struct AccumDisplay : BasicDisplay {
+  int shownSt = INT_MIN;
+  int shownClip = INT_MIN;
+  std::string stTxt = "--";
+  std::string clipTxt = "OFF";
+
   AccumDisplay(Vec pos, Vec size, UZZ *m) : BasicDisplay(pos, size, m) {}
 
+  void update() override {
+    if (!module)
+      return;
+    int st = (int)std::round(module->params[UZZ::ACCUM_AMT_PARAM].getValue());
+    int clip =
+        (int)std::round(module->params[UZZ::ACCUM_CLIP_PARAM].getValue());
+    if (st == shownSt && clip == shownClip)
+      return;
+    shownSt = st;
+    shownClip = clip;
+    stTxt = std::to_string(st) + "st";
+    clipTxt = (clip > 0) ? std::to_string(clip) + "st" : "OFF";
+  }
+
   void drawContent(NVGcontext *vg) override {
-    std::string stTxt = "--";
-    std::string clipTxt = "OFF";
-    if (module) {
-      int st = (int)std::round(module->params[UZZ::ACCUM_AMT_PARAM].getValue());
-      int clip =
-          (int)std::round(module->params[UZZ::ACCUM_CLIP_PARAM].getValue());
-      stTxt = std::to_string(st) + "st";
-      clipTxt = (clip > 0) ? std::to_string(clip) + "st" : "OFF";
-    }
     nvgFontSize(vg, 8.5f);
     float cx = box.size.x * 0.5f;
     nvgText(vg, cx, box.size.y * 0.30f, stTxt.c_str(), nullptr);
@@ -293,22 +347,41 @@ struct AccumDisplay : BasicDisplay {
   }
 };
 
-// Note label
-struct NoteLabel : TransparentWidget {
+// Note label. The name is drawn into a framebuffer, redrawn only when the
+// step's PITCH or OCT changes.
+struct NoteLabel : widget::FramebufferWidget {
+  struct Text : TransparentWidget {
+    NoteLabel *label = nullptr;
+    std::shared_ptr<Font> font;
+
+    void draw(const DrawArgs &args) override {
+      if (!font)
+        font = APP->window->loadFont(asset::system("res/fonts/ShareTechMono-Regular.ttf"));
+      if (!font)
+        return;
+      nvgFontSize(args.vg, 10.f);
+      nvgFontFaceId(args.vg, font->handle);
+      nvgFillColor(args.vg, panelTextColor());
+      nvgTextAlign(args.vg, NVG_ALIGN_CENTER | NVG_ALIGN_MIDDLE);
+      nvgText(args.vg, box.size.x * .5f, box.size.y * .5f, label->text.c_str(),
+              nullptr);
+    }
+  };
+
   UZZ *module = nullptr;
   int stepIndex = 0;
-  std::shared_ptr<Font> font;
+  int shownNote = INT_MIN;
+  std::string text;
 
   NoteLabel(UZZ *m, int i) : module(m), stepIndex(i) {
     box.size = Vec(24.f, 12.f);
+    auto *t = new Text;
+    t->label = this;
+    t->box.size = box.size;
+    addChild(t);
   }
 
-  void draw(const DrawArgs &args) override {
-    if (!font)
-      font = APP->window->loadFont(asset::system("res/fonts/ShareTechMono-Regular.ttf"));
-    if (!font)
-      return;
-
+  void step() override {
     // Sin módulo (navegador y web de la librería) se pintan los valores por
     // defecto de configParam, que es lo mismo que muestra un UZZ recién puesto.
     auto paramOr = [&](int paramId, int fallback) {
@@ -317,25 +390,52 @@ struct NoteLabel : TransparentWidget {
     };
     int s = paramOr(UZZ::PITCH_PARAMS + stepIndex, 0);
     int oct = paramOr(UZZ::OCT_PARAMS + stepIndex, 0) + 4;
-    static const char *N[12] = {"C",  "C#", "D",  "D#", "E",  "F",
-                                "F#", "G",  "G#", "A",  "A#", "B"};
-    std::string txt = string::f("%s%d", N[(s % 12 + 12) % 12], oct);
-
-    nvgFontSize(args.vg, 10.f);
-    nvgFontFaceId(args.vg, font->handle);
-    nvgFillColor(args.vg, panelTextColor());
-    nvgTextAlign(args.vg, NVG_ALIGN_CENTER | NVG_ALIGN_MIDDLE);
-    nvgText(args.vg, box.size.x * .5f, box.size.y * .5f, txt.c_str(), nullptr);
+    int note = oct * 12 + (s % 12 + 12) % 12;
+    if (note != shownNote) {
+      static const char *N[12] = {"C",  "C#", "D",  "D#", "E",  "F",
+                                  "F#", "G",  "G#", "A",  "A#", "B"};
+      shownNote = note;
+      text = string::f("%s%d", N[(s % 12 + 12) % 12], oct);
+      dirty = true;
+    }
+    FramebufferWidget::step();
   }
 };
 
 struct CapybaraWidget : Widget {
+  // Base outline only. The flash moved to the light layer, so it survives
+  // the room dimming instead of fading out with the panel around it. No
+  // depende del módulo, así que la capibara también sale en el navegador.
+  // Static, so it is drawn once into a framebuffer.
+  struct Outline : TransparentWidget {
+    static constexpr float MARGIN = 2.f; // keeps the stroke inside the buffer
+    CapybaraWidget *capi = nullptr;
+
+    void draw(const DrawArgs &args) override {
+      if (!capi->svg)
+        return;
+      nvgSave(args.vg);
+      nvgTranslate(args.vg, MARGIN, MARGIN);
+      capi->applyTransform(args.vg);
+      capi->svg->draw(args.vg);
+      nvgRestore(args.vg);
+    }
+  };
+
   UZZ *module = nullptr;
   std::shared_ptr<window::Svg> svg;
 
   CapybaraWidget(UZZ *module) : module(module) {
     svg = loadPluginSvg("res/capybara.svg");
     box.size = Vec(48.4f, 53.2f);
+    auto *fb = new widget::FramebufferWidget;
+    fb->box.size = box.size;
+    auto *outline = new Outline;
+    outline->capi = this;
+    outline->box.pos = Vec(-Outline::MARGIN, -Outline::MARGIN);
+    outline->box.size = box.size.plus(Vec(2.f, 2.f).mult(Outline::MARGIN));
+    fb->addChild(outline);
+    addChild(fb);
   }
 
   /** Mirrors and scales the 200x200 artwork into the widget box. */
@@ -344,19 +444,6 @@ struct CapybaraWidget : Widget {
     nvgScale(vg, -box.size.x / 200.f, box.size.y / 200.f);
   }
 
-  void draw(const DrawArgs &args) override {
-    if (!svg)
-      return;
-
-    // Base outline only. The flash moved to the light layer, so it survives
-    // the room dimming instead of fading out with the panel around it. No
-    // depende del módulo, así que la capibara también sale en el navegador.
-    nvgSave(args.vg);
-    applyTransform(args.vg);
-    svg->draw(args.vg);
-    nvgRestore(args.vg);
-  }
-
   /** Layer 1 is composited after the room brightness is applied, which is why
   LEDs stay lit in a dark room. A faint constant pass keeps the capybara
   visible there, and the flash rides on top of it. */
@@ -384,3 +471,39 @@ struct CapybaraWidget : Widget {
     Widget::drawLayer(args, layer);
   }
 };
+
+// Context-menu slider for one step of the edit track's micro-timing lane.
+// The quantity keeps its own value while dragging and posts each whole
+// percent it passes through to the module's command queue.
+struct MicroTimingQuantity : Quantity {
+  UZZ *module = nullptr;
+  int step = 0;
+  float value = 0.f;
+
+  void setValue(float v) override {
+    v = clamp(v, -50.f, 50.f);
+    const int pct = (int)std::round(v);
+    if (pct != (int)std::round(value))
+      module->post(UZZ::CMD_MICRO, (step << 8) | (pct + 50));
+    value = v;
+  }
+  float getValue() override { return value; }
+  float getMinValue() override { return -50.f; }
+  float getMaxValue() override { return 50.f; }
+  float getDefaultValue() override { return 0.f; }
+  float getDisplayValue() override { return std::round(value); }
+  std::string getLabel() override { return string::f("Step %d", step + 1); }
+  std::string getUnit() override { return "%"; }
+};
+
+struct MicroTimingSlider : ui::Slider {
+  MicroTimingSlider(UZZ *module, int step) {
+    auto *q = new MicroTimingQuantity;
+    q->module = module;
+    q->step = step;
+    q->value = (float)module->micro[module->editTrack][step];
+    quantity = q;
+    box.size.x = 200.f;
+  }
+  ~MicroTimingSlider() { delete quantity; }
+};
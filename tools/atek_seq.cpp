@@ -0,0 +1,363 @@
+// Banco offline de ATEK303 SEQ sin Rack: el modelo dual v4 (`src/AcidPattern.hpp`), su
+// tabla de pasos y el reloj (`SeqStepTable` y `SeqTempoTracker` en `src/AcidSeq.hpp`).
+// Comprueba lo que el módulo da por hecho: patrones estables y deterministas, el historial
+// de undo, los slides de fin de slot y la duración de los gates con un reloj con jitter,
+// pulsos perdidos y cambios de tempo. Sale con 1 si algo falla. Con `--bench` mide además
+// lo que cuesta generar.
+//
+//   make -C tools atek_seq && tools/build/atek_seq
+
+#include "AcidPattern.hpp"
+#include "AcidSeq.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+	if (!ok) {
+		failures++;
+		std::printf("FALLO: %s\n", what);
+	}
+}
+
+static AcidGenParams paramsFor(uint32_t seed, int steps) {
+	AcidGenParams p;
+	p.steps = steps;
+	p.scale = seed % ACID_SCALES_LEN;
+	p.density = 0.2f + (seed % 7) * 0.1f;
+	p.slide = (seed % 5) * 0.2f;
+	p.range = (seed % 3) * 0.4f;
+	return p;
+}
+
+// Los patrones de 16 pasos de 2000 semillas, pasados por render(). El valor esperado sale
+// de la versión anterior a los patrones largos: una semilla guardada tiene que seguir
+// dando el mismo compás.
+static void firstBarIsStable() {
+	AcidDualGenerator gen;
+	uint64_t h = 1469598103934665603ull;
+	auto mix = [&](int v) { h = (h ^ (uint32_t) v) * 1099511628211ull; };
+	for (uint32_t seed = 1; seed <= 2000; seed++) {
+		AcidPatternV4 pattern;
+		gen.generate(pattern, paramsFor(seed, 16), seed);
+		AcidGen r;
+		pattern.render(r);
+		for (int i = 0; i < 16; i++) {
+			mix(r.gate[i]); mix(r.deg[i]); mix(r.oct[i]);
+			mix(r.tie[i]); mix(r.slide[i]); mix(r.accent[i]);
+		}
+	}
+	check(h == 0xc0c403c15f13da87ull, "16 pasos: las semillas ya no dan el mismo patrón");
+}
+
+// Misma semilla, mismo patrón, a cualquier longitud y con cualquier generador: el módulo
+// guarda los slots que no suenan solo con su semilla y los regenera al cargar con otro.
+static void generateIsDeterministic() {
+	AcidDualGenerator gen;
+	const int lengths[3] = {16, 32, 64};
+	for (uint32_t seed = 1; seed <= 500; seed++)
+		for (int steps : lengths) {
+			AcidPatternV4 a, b;
+			gen.generate(a, paramsFor(seed, steps), seed);
+			AcidDualGenerator other;
+			other.generate(b, paramsFor(seed + 1, 64), seed + 1);
+			other.generate(b, paramsFor(seed, steps), seed);
+			check(AcidPatternMutator::same(a, b), "generate() no es determinista");
+			check(a.timeLength == steps, "generate() no respeta la longitud");
+		}
+}
+
+// Un patrón sin generar mide 16 pasos. Alargado con extend() repite su bucle: renderiza
+// igual paso a paso, y sanitize() no le cambia nada.
+static void extendRepeatsTheLoop() {
+	check(AcidPatternV4().timeLength == ACID_BASE_STEPS,
+	      "un patrón vacío no mide ACID_BASE_STEPS");
+	AcidDualGenerator gen;
+	const int lengths[3] = {16, 32, 64};
+	for (uint32_t seed = 1; seed <= 500; seed++)
+		for (int from : lengths)
+			for (int to : lengths) {
+				AcidPatternV4 pattern;
+				const AcidGenParams p = paramsFor(seed, from);
+				gen.generate(pattern, p, seed);
+				AcidGen a, b;
+				pattern.render(a);
+				pattern.extend(to);
+				pattern.render(b);
+				const int len = std::max(from, to);
+				bool same = pattern.timeLength == len;
+				for (int i = 0; same && i < len; i++) {
+					const int j = i % from;
+					same = a.gate[j] == b.gate[i] && a.tie[j] == b.tie[i]
+					    && a.accent[j] == b.accent[i] && a.slide[j] == b.slide[i]
+					    && (!b.gate[i] || (a.deg[j] == b.deg[i] && a.oct[j] == b.oct[i]));
+				}
+				check(same, "extend() no repite el bucle");
+				AcidPatternV4 sane = pattern;
+				sane.sanitize(p.scale);
+				check(AcidPatternMutator::same(sane, pattern), "sanitize() cambia un patrón alargado");
+			}
+}
+
+// Undo devuelve el patrón anterior a cada mutación y redo el posterior, también después de
+// olvidar las entradas de otro patrón.
+static void historyRoundTrip() {
+	AcidDualGenerator gen;
+	AcidPatternHistory history;
+	AcidPatternV4 pattern[2];
+	uint32_t counter[2] = {0, 0};
+	for (int k = 0; k < 2; k++)
+		gen.generate(pattern[k], paramsFor(7 + k, 64), 7 + k);
+	AcidPatternV4 states[2][41];
+	int done[2] = {0, 0};
+	states[0][0] = pattern[0];
+	states[1][0] = pattern[1];
+	for (int i = 0; i < 80; i++) {
+		const int k = i & 1;
+		const AcidPatternV4 before = pattern[k];
+		const uint32_t beforeCounter = counter[k];
+		uint32_t last = beforeCounter;
+		const auto layer = (AcidPatternMutator::Layer) (1 + i % 3);
+		if (!AcidPatternMutator::mutateBurst(pattern[k], layer, beforeCounter + 1, 2, 0, last))
+			continue;
+		counter[k] = last;
+		history.record(before, pattern[k], beforeCounter, counter[k], k);
+		states[k][++done[k]] = pattern[k];
+	}
+	check(done[0] > 0 && done[1] > 0, "ninguna mutación que deshacer");
+	// El patrón 1 se regenera: sus entradas se van y las del 0 siguen deshaciéndose.
+	history.forget(1);
+	check(history.size == done[0], "forget() no deja las entradas de los demás");
+	for (int n = done[0]; n > 0; n--) {
+		check(history.undoTarget() == 0, "forget() deja entradas del patrón olvidado");
+		history.undo(pattern[0], counter[0]);
+		check(AcidPatternMutator::same(pattern[0], states[0][n - 1]), "undo no vuelve atrás");
+	}
+	for (int n = 1; n <= done[0]; n++) {
+		history.redo(pattern[0], counter[0]);
+		check(AcidPatternMutator::same(pattern[0], states[0][n]), "redo no vuelve adelante");
+	}
+}
+
+// En una cadena, el último paso de un slot liga (y sostiene el gate) según el primer paso del
+// slot que le sigue, no según el primero del mismo slot.
+static void chainedSlides() {
+	static SeqStepTable table;
+	AcidDualGenerator gen;
+	const int scale = 0;
+	int crossings = 0;
+	for (uint32_t base = 1; base <= 400; base += CHAIN_SLOTS) {
+		AcidGen gens[CHAIN_SLOTS];
+		const int len = (base & 8) ? 32 : 16;
+		for (int k = 0; k < CHAIN_SLOTS; k++) {
+			AcidGenParams p = paramsFor(base + k, len);
+			p.scale = scale;
+			p.slide = 0.9f;
+			AcidPatternV4 pattern;
+			gen.generate(pattern, p, base + k);
+			pattern.render(gens[k]);
+			table.compile(k, 0, gens[k], len, scale, 0, 0, true);
+		}
+		table.compileWrap(0, gens, len, scale, true);
+		const int s = len - 1;
+		for (int k = 0; k < CHAIN_SLOTS; k++) {
+			check(table.wrapSlide[k][k][0] == table.slide[k][s][0]
+			      && table.wrapHold[k][k][0] == table.holdKind[k][s][0],
+			      "un slot que se repite no sale igual que dentro de la tabla");
+			for (int j = 0; j < CHAIN_SLOTS; j++) {
+				const AcidGen& a = gens[k];
+				const AcidGen& b = gens[j];
+				const bool expect = a.gate[s] && a.slide[s] && !a.tie[s] && b.gate[0]
+				                 && !b.tie[0]
+				                 && AcidGen::semiOf(a.deg[s], a.oct[s], scale)
+				                    != AcidGen::semiOf(b.deg[0], b.oct[0], scale);
+				check(table.wrapSlide[k][j][0] == expect, "slide de fin de slot mal validado");
+				if (table.wrapSlide[k][j][0] != table.slide[k][s][0])
+					crossings++;
+			}
+		}
+	}
+	// Si ningún par difiere, la prueba no ha ejercitado el caso de la cadena.
+	check(crossings > 0, "ningún slide de fin de slot depende del slot siguiente");
+}
+
+static const float SAMPLE_RATE = 48000.f;
+static const float GATE_LEN = 0.85f;     // el valor por defecto de GATE LEN
+static const float PULSE = 0.005f;       // ancho del pulso de reloj
+
+// Ruido reproducible en [-1, 1].
+struct Lcg {
+	uint32_t s = 12345;
+	float next() {
+		s = s * 1664525u + 1013904223u;
+		return (s >> 8) * (2.f / 16777216.f) - 1.f;
+	}
+};
+
+// Instantes de los flancos: `steps` intervalos de `period` con jitter uniforme de ±`jitter`.
+static std::vector<double> jitteredEdges(int steps, double period, double jitter) {
+	Lcg rng;
+	std::vector<double> edges;
+	for (int k = 0; k < steps; k++)
+		edges.push_back(0.01 + k * period + jitter * rng.next());
+	return edges;
+}
+
+struct Stats {
+	double mean = 0.0, dev = 0.0;
+};
+
+static Stats stats(const std::vector<double>& v) {
+	Stats s;
+	for (double x : v)
+		s.mean += x;
+	s.mean /= v.size();
+	for (double x : v)
+		s.dev += (x - s.mean) * (x - s.mean);
+	s.dev = std::sqrt(s.dev / v.size());
+	return s;
+}
+
+// Duración de cada gate de nota normal, en segundos, saltando los `warmup` primeros pasos.
+// `tracked` elige el camino del módulo (tracker + paso desde el cruce) o el de antes.
+static std::vector<double> gateLengths(const std::vector<double>& edges, bool tracked, int warmup) {
+	const float dt = 1.f / SAMPLE_RATE;
+	SeqTempoTracker tempo;
+	SeqStepTable table;
+	float clockPeriod = 0.125f;
+	float stepTime = 0.f;
+	float prevV = 0.f;
+	bool started = false;
+	int step = -1;
+	int gateSamples = 0;
+	std::vector<double> lengths;
+	const long n = (long) ((edges.back() + 0.2) * SAMPLE_RATE);
+	size_t e = 0;
+	for (long i = 0; i < n; i++) {
+		const double t = i * (double) dt;
+		while (e + 1 < edges.size() && t >= edges[e + 1])
+			e++;
+		const float v = t >= edges[e] && t < edges[e] + PULSE ? 10.f : 0.f;
+		const bool edge = v >= 1.f && prevV < 1.f;
+		prevV = v;
+		bool tick = false;
+		if (tracked) {
+			const float late = tempo.process(v, edge, dt);
+			stepTime += dt;
+			if (edge) {
+				tick = true;
+				stepTime = late;
+				clockPeriod = tempo.period;
+			}
+		}
+		else {
+			if (edge) {
+				tick = true;
+				if (started && stepTime > 1e-4f)
+					clockPeriod = stepTime;
+				stepTime = 0.f;
+			}
+			stepTime += dt;
+		}
+		if (tick) {
+			if (step >= warmup)
+				lengths.push_back(gateSamples * (double) dt);
+			gateSamples = 0;
+			started = true;
+			step++;
+			table.retime(clockPeriod, GATE_LEN);
+		}
+		if (started && stepTime < table.holdTime[SeqStepTable::HOLD_NORMAL])
+			gateSamples++;
+	}
+	return lengths;
+}
+
+// Con ±3 ms de jitter a 125 ms por paso, el gate de antes copiaba el error de cada intervalo;
+// con el tracker queda el error de un solo flanco, que ya no se suma al periodo.
+static void gateVarianceUnderJitter() {
+	const std::vector<double> edges = jitteredEdges(2000, 0.125, 0.003);
+	const Stats before = stats(gateLengths(edges, false, 16));
+	const Stats after = stats(gateLengths(edges, true, 16));
+	std::printf("gate con ±3 ms de jitter: antes %.3f ± %.3f ms, ahora %.3f ± %.3f ms\n",
+	            before.mean * 1e3, before.dev * 1e3, after.mean * 1e3, after.dev * 1e3);
+	check(std::fabs(after.mean - GATE_LEN * 0.125) < 0.0005, "el gate medio no es GATE LEN");
+	check(after.dev < 0.0008, "la desviación del gate pasa de 0,8 ms");
+	check(after.dev < 0.5 * before.dev, "el tracker no reduce a la mitad la desviación");
+}
+
+static float trackedPeriodAfter(const std::vector<double>& edges) {
+	SeqTempoTracker tempo;
+	const float dt = 1.f / SAMPLE_RATE;
+	float prevV = 0.f;
+	size_t e = 0;
+	const long n = (long) ((edges.back() + 0.001) * SAMPLE_RATE);
+	for (long i = 0; i < n; i++) {
+		const double t = i * (double) dt;
+		while (e + 1 < edges.size() && t >= edges[e + 1])
+			e++;
+		const float v = t >= edges[e] && t < edges[e] + PULSE ? 10.f : 0.f;
+		tempo.process(v, v >= 1.f && prevV < 1.f, dt);
+		prevV = v;
+	}
+	return tempo.period;
+}
+
+// Un pulso perdido no mueve el periodo. Un salto fuera de la banda (doble tempo) se engancha
+// en dos intervalos; uno dentro de la banda se sigue con el filtro en una docena de pasos.
+static std::vector<double> tempoChange(double from, double to, int after) {
+	std::vector<double> edges = jitteredEdges(32, from, 0.0);
+	const double t0 = edges.back();
+	for (int k = 1; k <= after; k++)
+		edges.push_back(t0 + k * to);
+	return edges;
+}
+
+static void outliersAndTempoChanges() {
+	std::vector<double> edges = jitteredEdges(32, 0.125, 0.0);
+	edges.erase(edges.begin() + 20);
+	check(std::fabs(trackedPeriodAfter(edges) - 0.125f) < 0.001f, "un pulso perdido mueve el periodo");
+	check(std::fabs(trackedPeriodAfter(tempoChange(0.125, 0.0625, 2)) - 0.0625f) < 0.001f,
+	      "no engancha el doble tempo en dos intervalos");
+	check(std::fabs(trackedPeriodAfter(tempoChange(0.125, 0.1, 12)) - 0.1f) < 0.001f,
+	      "no sigue un cambio de tempo pequeño");
+}
+
+static void bench() {
+	AcidDualGenerator gen;
+	const int lengths[3] = {16, 32, 64};
+	for (int steps : lengths) {
+		const int runs = 20000;
+		AcidPatternV4 pattern;
+		uint32_t sink = 0;
+		const auto t0 = std::chrono::steady_clock::now();
+		for (int i = 0; i < runs; i++) {
+			gen.generate(pattern, paramsFor(i + 1, steps), i + 1);
+			sink += pattern.noteCount();
+		}
+		const double us = std::chrono::duration<double, std::micro>(
+			std::chrono::steady_clock::now() - t0).count() / runs;
+		std::printf("generate %2d pasos: %.2f us (%u)\n", steps, us, sink);
+	}
+}
+
+int main(int argc, char** argv) {
+	if (argc > 1 && !std::strcmp(argv[1], "--bench")) {
+		bench();
+		return 0;
+	}
+	firstBarIsStable();
+	generateIsDeterministic();
+	extendRepeatsTheLoop();
+	historyRoundTrip();
+	chainedSlides();
+	gateVarianceUnderJitter();
+	outliersAndTempoChanges();
+	std::printf(failures ? "%d fallos\n" : "ok\n", failures);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,226 @@
+// Checks for the expander trigger log (src/ExpanderEvents.hpp): the sender
+// pushes events and copies its log into the message every frame, Rack flips
+// the double buffer after the frame, and the receiver drains what it has not
+// seen. Every event must come out once, in order, unless more than CAP of
+// them piled up between two reads, in which case the oldest are counted as
+// lost and the newest CAP still arrive in order.
+//
+//   make -C tools expander_events && tools/build/expander_events
+
+#include "ExpanderEvents.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+static const int CAP = 16;
+
+static int failures = 0;
+
+static void check(bool ok, const char *what) {
+  if (!ok) {
+    printf("FAIL: %s\n", what);
+    ++failures;
+  }
+}
+
+// One expander side as Rack runs it: the sender writes the producer buffer,
+// the receiver reads the consumer buffer, and a requested flip swaps them
+// once both have processed the frame.
+struct Link {
+  struct Msg {
+    ExpanderEvents<CAP> events;
+  };
+  Msg buf[2];
+  int producer = 0;
+  bool flip = false;
+
+  Msg &producerMsg() { return buf[producer]; }
+  const Msg &consumerMsg() const { return buf[1 - producer]; }
+  void endFrame() {
+    if (flip)
+      producer = 1 - producer;
+    flip = false;
+  }
+};
+
+struct Sender {
+  ExpanderEvents<CAP> events;
+  uint32_t next = 0; // payload of the next event, counts up from 0
+
+  void fire(int n, int64_t frame) {
+    for (int i = 0; i < n; ++i, ++next)
+      events.push((int)(next & 0xff), frame, (int)((next >> 8) & 0xff));
+  }
+  void send(Link &link) {
+    link.producerMsg().events = events;
+    link.flip = true;
+  }
+};
+
+struct Receiver {
+  ExpanderEventReader reader;
+  std::vector<uint32_t> got; // payloads, low 16 bits
+  int64_t lastFrame = -1;
+  bool framesInOrder = true;
+
+  void read(const Link &link) {
+    reader.drain(link.consumerMsg().events, [&](const ExpanderEvent &e) {
+      got.push_back(e.type | (uint32_t)e.arg << 8);
+      framesInOrder = framesInOrder && e.frame >= lastFrame;
+      lastFrame = e.frame;
+    });
+  }
+};
+
+struct Lcg {
+  uint32_t state;
+  explicit Lcg(uint32_t seed) : state(seed) {}
+  uint32_t operator()(uint32_t n) {
+    state = state * 1664525u + 1013904223u;
+    return (state >> 8) % n;
+  }
+};
+
+// Payloads first .. first + n - 1, as the receiver keeps them.
+static bool isRun(const std::vector<uint32_t> &got, size_t from, uint32_t first,
+                  size_t n) {
+  if (got.size() - from != n)
+    return false;
+  for (size_t i = 0; i < n; ++i)
+    if (got[from + i] != ((first + i) & 0xffff))
+      return false;
+  return true;
+}
+
+// Bursts of 0..CAP events per frame, sender and receiver in a random order
+// every frame: the receiver sees all of them, once, in order, one frame late.
+static void burstsArriveInOrder() {
+  Link link;
+  Sender tx;
+  Receiver rx;
+  Lcg rng(1);
+  int maxBurst = 0;
+  for (int64_t frame = 0; frame < 100000; ++frame) {
+    const int burst = (int)(rng(4) ? rng(4) : rng(CAP + 1));
+    maxBurst = std::max(maxBurst, burst);
+    if (rng(2)) {
+      tx.fire(burst, frame);
+      tx.send(link);
+      rx.read(link);
+    } else {
+      rx.read(link);
+      tx.fire(burst, frame);
+      tx.send(link);
+    }
+    link.endFrame();
+  }
+  rx.read(link);
+  printf("bursts: %u events, up to %d per frame, %zu drained, %u lost\n",
+         tx.next, maxBurst, rx.got.size(), rx.reader.lost);
+  // The first message is adopted: its events count as seen.
+  const uint32_t adopted = tx.next - (uint32_t)rx.got.size();
+  check(adopted <= (uint32_t)CAP,
+        "bursts: more events skipped than the first message held");
+  check(isRun(rx.got, 0, adopted, rx.got.size()) && rx.framesInOrder,
+        "bursts: drained events missing, repeated or out of order");
+  check(rx.reader.lost == 0, "bursts: events lost without overflow");
+}
+
+// More than CAP events between two reads: the oldest are lost and counted,
+// the newest CAP arrive in order, and the reader carries on from there.
+static void overflowAtCap() {
+  Link link;
+  Sender tx;
+  Receiver rx;
+  tx.send(link);
+  link.endFrame();
+  rx.read(link); // links to the empty log
+
+  for (int extra : {0, 1, 5, CAP, 3 * CAP + 7}) {
+    const size_t before = rx.got.size();
+    const uint32_t lostBefore = rx.reader.lost;
+    const uint32_t first = tx.next;
+    tx.fire(CAP + extra, 0);
+    tx.send(link);
+    link.endFrame();
+    rx.read(link);
+    char what[96];
+    snprintf(what, sizeof(what),
+             "overflow: CAP + %d events did not give the last CAP in order",
+             extra);
+    check(isRun(rx.got, before, first + extra, CAP), what);
+    snprintf(what, sizeof(what), "overflow: CAP + %d events lost %u, not %d",
+             extra, rx.reader.lost - lostBefore, extra);
+    check(rx.reader.lost - lostBefore == (uint32_t)extra, what);
+
+    // Then back to normal: the next pair arrives in full.
+    const size_t after = rx.got.size();
+    tx.fire(2, 1);
+    tx.send(link);
+    link.endFrame();
+    rx.read(link);
+    check(isRun(rx.got, after, first + CAP + extra, 2),
+          "overflow: the reader did not carry on after losing events");
+  }
+  printf("overflow: %u lost in total\n", rx.reader.lost);
+}
+
+// Linking adopts the log without replaying it, and so does re-linking after
+// unlink(), however many events the sender fired meanwhile.
+static void linkAdoptsLog() {
+  Link link;
+  Sender tx;
+  Receiver rx;
+  tx.fire(5, 0);
+  tx.send(link);
+  link.endFrame();
+  rx.read(link);
+  check(rx.got.empty(), "link: events fired before linking were replayed");
+
+  rx.reader.unlink();
+  tx.fire(40, 1);
+  tx.send(link);
+  link.endFrame();
+  rx.read(link);
+  check(rx.got.empty() && rx.reader.lost == 0,
+        "link: events fired before re-linking were replayed or lost");
+
+  tx.fire(3, 2);
+  tx.send(link);
+  link.endFrame();
+  rx.read(link);
+  check(isRun(rx.got, 0, 45, 3), "link: events after linking did not arrive");
+}
+
+// The running total wraps at 2^32 without losing or repeating events.
+static void totalWraps() {
+  Link link;
+  Sender tx;
+  Receiver rx;
+  tx.events.written = 0xfffffff0u;
+  tx.send(link);
+  link.endFrame();
+  rx.read(link);
+  tx.fire(CAP + 3, 0);
+  tx.send(link);
+  link.endFrame();
+  rx.read(link);
+  check(isRun(rx.got, 0, 3, CAP) && rx.reader.lost == 3,
+        "wrap: overflow across 2^32 miscounted");
+  tx.fire(7, 1);
+  tx.send(link);
+  link.endFrame();
+  rx.read(link);
+  check(isRun(rx.got, CAP, CAP + 3, 7) && tx.events.written < 0x100u,
+        "wrap: events after 2^32 missing or out of order");
+}
+
+int main() {
+  burstsArriveInOrder();
+  overflowAtCap();
+  linkAdoptsLog();
+  totalWraps();
+  printf(failures ? "%d failures\n" : "ok\n", failures);
+  return failures ? 1 : 0;
+}
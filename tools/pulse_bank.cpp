@@ -0,0 +1,101 @@
+// Checks PulseBank (src/PulseBank.hpp) against one dsp::PulseGenerator per
+// channel: random triggers, re-triggers and resets over 2M samples, for a
+// full bank and for ones that end inside a group of four. The high masks and
+// the voltages writePolyGates() would write must match sample for sample.
+//
+//   make -C tools pulse_bank && tools/build/pulse_bank
+
+#include "PulseBank.hpp"
+
+#include <cstdio>
+
+// Rack's dsp::PulseGenerator, as of Rack 2.
+struct RefPulseGenerator {
+  float remaining = 0.f;
+  void reset() { remaining = 0.f; }
+  bool process(float deltaTime) {
+    if (remaining > 0.f) {
+      remaining -= deltaTime;
+      return true;
+    }
+    return false;
+  }
+  void trigger(float duration = 1e-3f) {
+    if (duration > remaining)
+      remaining = duration;
+  }
+};
+
+static int failures = 0;
+
+static void check(bool ok, const char *what) {
+  if (!ok) {
+    printf("FAIL: %s\n", what);
+    ++failures;
+  }
+}
+
+struct Lcg {
+  uint32_t state;
+  explicit Lcg(uint32_t seed) : state(seed) {}
+  float uniform() {
+    state = state * 1664525u + 1013904223u;
+    return (state >> 8) * (1.f / 16777216.f);
+  }
+};
+
+template <int N> static void matchesPulseGenerators(long samples) {
+  PulseBank<N> bank;
+  RefPulseGenerator ref[N];
+  Lcg rng(N);
+  long maskDiffs = 0, voltDiffs = 0, highSamples = 0;
+  for (long n = 0; n < samples; ++n) {
+    // Mostly 48 kHz, sometimes another rate, as after a sample rate change.
+    float dt = 1.f / 48000.f;
+    if (rng.uniform() < 0.001f)
+      dt = 1.f / (22050.f + 170000.f * rng.uniform());
+    if (rng.uniform() < 1e-5f) {
+      bank.reset();
+      for (RefPulseGenerator &g : ref)
+        g.reset();
+    }
+    // Sparse triggers, with the odd burst on every channel. Durations from
+    // zero (no pulse) to 50 ms, often the 1 ms trigger default.
+    const bool burst = rng.uniform() < 1e-4f;
+    for (int ch = 0; ch < N; ++ch) {
+      if (!burst && rng.uniform() >= 3e-4f)
+        continue;
+      const float u = rng.uniform();
+      const float d = u < 0.1f ? 0.f : u < 0.5f ? 1e-3f : 0.05f * rng.uniform();
+      bank.trigger(ch, d);
+      ref[ch].trigger(d);
+    }
+    const uint32_t high = bank.process(dt);
+    uint32_t want = 0;
+    for (int ch = 0; ch < N; ++ch)
+      want |= (uint32_t)ref[ch].process(dt) << ch;
+    maskDiffs += high != want;
+    highSamples += want != 0;
+    // What writePolyGates() stores, lane by lane.
+    for (int ch = 0; ch < N; ++ch) {
+      const float v = POLY_GATE_LANES[(high >> (ch & ~3)) & 0xF][ch & 3];
+      voltDiffs += v != ((want >> ch) & 1 ? 10.f : 0.f);
+    }
+  }
+  printf("PulseBank<%d>: %ld samples, %ld with a pulse, %ld mask and %ld "
+         "voltage mismatches\n",
+         N, samples, highSamples, maskDiffs, voltDiffs);
+  char what[80];
+  snprintf(what, sizeof(what), "PulseBank<%d> differs from PulseGenerator", N);
+  check(maskDiffs == 0 && voltDiffs == 0 && highSamples > samples / 20, what);
+}
+
+int main() {
+  const long samples = 2000000;
+  matchesPulseGenerators<16>(samples);
+  matchesPulseGenerators<8>(samples);
+  matchesPulseGenerators<5>(samples);
+  matchesPulseGenerators<1>(samples);
+  printf(failures ? "%d failures\n" : "ok\n", failures);
+  return failures ? 1 : 0;
+}
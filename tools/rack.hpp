@@ -0,0 +1,9 @@
+#pragma once
+
+// Stands in for the SDK's <rack.hpp> here, so shared plugin headers such as
+// PulseBank.hpp include it as usual and get the plain C++ helpers of
+// src/uzz/UzzRack.hpp. RACK_HEADLESS tells them the engine and widget types
+// are missing.
+#define RACK_HEADLESS
+
+#include "uzz/UzzRack.hpp"
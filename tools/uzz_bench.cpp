@@ -0,0 +1,102 @@
+// UZZ benchmarks: what 8 tracks in one module cost, and a tick of the
+// traversal tables against the old scan. Wall-clock figures, so they stay
+// out of `make check`.
+//
+//   make -C tools bench
+
+#include "uzz_fixture.hpp"
+#include "uzz_nav_ref.hpp"
+
+// Tracks (user-031): one module running 8 tracks does the clock, reset,
+// window and tick bookkeeping once, so it costs less than 8 modules of one
+// track each. Best of three runs of 60 s of audio each.
+static void tracksBench() {
+  const uint64_t n = (uint64_t)(60.0 * 48000.0);
+  double one = 1e9, eight = 1e9, separate = 1e9;
+  for (int run = 0; run < 3; ++run) {
+    std::unique_ptr<UzzSim> a = busySim(1, 1);
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < n; ++i)
+      a->process();
+    one = std::min(one, secondsSince(t0));
+
+    std::unique_ptr<UzzSim> b = busySim(UZZ_MAX_TRACKS, 1);
+    t0 = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < n; ++i)
+      b->process();
+    eight = std::min(eight, secondsSince(t0));
+
+    std::unique_ptr<UzzSim> c[UZZ_MAX_TRACKS];
+    for (int k = 0; k < UZZ_MAX_TRACKS; ++k)
+      c[k] = busySim(1, 1 + k);
+    t0 = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < n; ++i)
+      for (int k = 0; k < UZZ_MAX_TRACKS; ++k)
+        c[k]->process();
+    separate = std::min(separate, secondsSince(t0));
+  }
+  const double ns = 1e9 / n;
+  printf("tracks: 1 track %.1f ns/sample, 8 tracks %.1f ns/sample, "
+         "8 modules x 1 track %.1f ns/sample\n",
+         one * ns, eight * ns, separate * ns);
+  check(eight < 0.8 * separate,
+        "8 tracks in one module cost as much as 8 modules");
+}
+
+// Cost of one tick per direction over 16 steps, old scan against the cached
+// tables (the update() key check included): with 4 steps skipped, and with
+// 15, the scan's worst case.
+static void traversalBench() {
+  static const int SPARSE[16] = {0, 2, 0, 0, 2, 0, 0, 0,
+                                 2, 0, 0, 0, 0, 2, 0, 0};
+  static const int LONE[16] = {0, 2, 2, 2, 2, 2, 2, 2,
+                               2, 2, 2, 2, 2, 2, 2, 2};
+  const int *patterns[2] = {SPARSE, LONE};
+  const char *names[2] = {"4 skipped", "15 skipped"};
+  const int n = 2000000;
+  for (int p = 0; p < 2; ++p) {
+    const int *modes = patterns[p];
+    StepTraversal<UZZ_MAX_STEPS>::Mask mask = 0;
+    for (int i = 0; i < 16; ++i)
+      if (modes[i] != SM_SKIP)
+        mask |= (StepTraversal<UZZ_MAX_STEPS>::Mask)1 << i;
+    double oldTotal = 0.0, newTotal = 0.0;
+    for (int dir = DIR_MODE_MIN; dir <= DIR_MODE_MAX; ++dir) {
+      double best[2] = {1e9, 1e9};
+      volatile int sink = 0;
+      for (int run = 0; run < 3; ++run) {
+        RefNavigator ref;
+        StepNavigator nav;
+        StepTraversal<UZZ_MAX_STEPS> tr;
+        UzzRng rng;
+        rng.seed(1, 0);
+        bool w, all;
+        int s = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < n; ++i)
+          sink = s =
+              ref.getNextStep(s, 0, 16, dir, modes, false, w, all, 3, rng);
+        best[0] = std::min(best[0], secondsSince(t0));
+        s = 0;
+        t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < n; ++i) {
+          tr.update(dir, 0, 16, mask, 3, 16);
+          sink = s = nav.getNextStep(s, tr, false, w, all, rng);
+        }
+        best[1] = std::min(best[1], secondsSince(t0));
+      }
+      (void)sink;
+      printf("traversal %-10s %-9s scan %6.1f ns, tables %5.1f ns per tick\n",
+             names[p], dirLabel(dir), best[0] * 1e9 / n, best[1] * 1e9 / n);
+      oldTotal += best[0];
+      newTotal += best[1];
+    }
+    check(newTotal < oldTotal, "the traversal tables are slower than the scan");
+  }
+}
+
+int main() {
+  tracksBench();
+  traversalBench();
+  return report();
+}
@@ -0,0 +1,868 @@
+// UZZ engine and timing: tracks, compiled tables, traversal, the event
+// scheduler and gate timing, the clock PLL, the seed, micro-timing, ADDR
+// scan and the latency probe.
+//
+//   make -C tools uzz_engine && tools/build/uzz_engine
+
+#include "uzz/UzzLatency.hpp"
+#include "uzz/UzzScan.hpp"
+#include "uzz_fixture.hpp"
+#include "uzz_nav_ref.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <thread>
+
+// Tracks (user-031). Each of the 8 tracks plays its own rows: with every
+// step certain, track t of one module gives, sample for sample, the gate,
+// pitch and MOD outputs of a one-track module holding the same rows.
+static void tracksIndependent() {
+  std::unique_ptr<UzzSim> eight = busySim(UZZ_MAX_TRACKS, 31);
+  std::unique_ptr<UzzSim> one[UZZ_MAX_TRACKS];
+  eight->in.pGlobal = 1.f;
+  for (int t = 0; t < UZZ_MAX_TRACKS; ++t)
+    for (int i = 0; i < UZZ_MAX_STEPS; ++i)
+      eight->raw[t][ROW_PROB][i] = 0.f;
+  eight->compile();
+  for (int t = 0; t < UZZ_MAX_TRACKS; ++t) {
+    one[t].reset(new UzzSim());
+    for (int r = 0; r < NUM_STEP_ROWS; ++r)
+      for (int i = 0; i < UZZ_MAX_STEPS; ++i)
+        one[t]->raw[0][r][i] = eight->raw[t][r][i];
+    one[t]->compile();
+  }
+  const uint64_t n = 20 * 48000;
+  long differ = 0, gates = 0;
+  for (uint64_t i = 0; i < n; ++i) {
+    eight->process();
+    for (int t = 0; t < UZZ_MAX_TRACKS; ++t) {
+      UzzSim &s = *one[t];
+      s.process();
+      differ += eight->out.gate[t] != s.out.gate[0] ||
+                eight->out.pitch[t] != s.out.pitch[0] ||
+                eight->out.m1[t] != s.out.m1[0] ||
+                eight->out.m2[t] != s.out.m2[0];
+      gates += s.out.gate[0];
+    }
+  }
+  printf("tracks: 8 tracks against 8 one-track runs, %ld samples differ "
+         "(%ld gate-high samples)\n",
+         differ, gates);
+  check(differ == 0 && gates > 0,
+        "a track of an 8-track module does not play as a lone track");
+}
+
+// Compiled step tables (user-032). The window mask is the set of slots the
+// window covers, for every slot count, start and length; and recompiling
+// only the steps whose raw values changed, as refreshSnapshot() does, gives
+// the same table as compiling every step again.
+static bool sameStep(const UzzStepSnap &a, const UzzStepSnap &b) {
+  return a.mode == b.mode && a.sounding == b.sounding && a.semis == b.semis &&
+         a.oct == b.oct && a.m1V == b.m1V && a.m2V == b.m2V &&
+         a.duty == b.duty && a.prob == b.prob && a.pulses == b.pulses &&
+         a.chord == b.chord;
+}
+
+static void compiledTables() {
+  typedef StepTraversal<UZZ_MAX_STEPS>::Mask Mask;
+  long windows = 0, badMasks = 0;
+  for (int slots = 1; slots <= UZZ_MAX_STEPS; ++slots)
+    for (int start = 0; start < slots; ++start)
+      for (int len = 1; len <= slots; ++len) {
+        StepTraversal<UZZ_MAX_STEPS> tr;
+        tr.update(DIR_FWD, start, len, ~0ull, 0, slots);
+        Mask want = 0;
+        for (int k = 0; k < len; ++k)
+          want |= (Mask)1 << ((start + k) % slots);
+        badMasks += tr.windowMask() != want;
+        ++windows;
+      }
+  printf("window mask: %ld windows, %ld wrong\n", windows, badMasks);
+  check(badMasks == 0, "window mask differs from the slots the window covers");
+
+  std::unique_ptr<UzzSim> sim(new UzzSim());
+  sim->randomize(32, 1, BUSY_MODES, 5);
+  for (int r = 0; r < NUM_STEP_ROWS; ++r)
+    for (int i = 0; i < UZZ_MAX_STEPS; ++i)
+      sim->raw[0][r][i] = r == ROW_MODE ? (float)SM_PLAY : STEP_ROW_DEFAULTS[r];
+  sim->in.slots = UZZ_MAX_STEPS;
+  sim->compile();
+  UzzTrackSnap &s = sim->engine.snap[0];
+  UzzRng rng;
+  rng.seed(32, 0);
+  long edits = 0, badSteps = 0;
+  for (int round = 0; round < 2000; ++round) {
+    // Change a few values, including modes to and from SKIP.
+    const int n = 1 + (int)(rng.uniform() * 4.f);
+    for (int k = 0; k < n; ++k) {
+      const int i = (int)(rng.uniform() * UZZ_MAX_STEPS);
+      const int r = (int)(rng.uniform() * NUM_STEP_ROWS);
+      const float u = rng.uniform();
+      float &v = sim->raw[0][r][i];
+      switch (r) {
+      case ROW_MODE:
+        v = (float)ALL_STEP_MODES[(int)(u * 8.f)];
+        break;
+      case ROW_PITCH:
+        v = std::floor(u * 24.f);
+        break;
+      case ROW_OCT:
+        v = std::floor(u * 5.f) - 2.f;
+        break;
+      case ROW_PROB:
+        v = std::floor(u * 108.f) - 100.f;
+        break;
+      default: // DUR, MOD1, MOD2
+        v = 10.f * u;
+      }
+    }
+    for (int i = 0; i < UZZ_MAX_STEPS; ++i) {
+      bool changed = false;
+      for (int r = 0; r < NUM_STEP_ROWS; ++r)
+        if (sim->raw[0][r][i] != s.raw[r][i]) {
+          s.raw[r][i] = sim->raw[0][r][i];
+          changed = true;
+        }
+      if (changed) {
+        compileStepSnap(s, i, nullptr, 0.f, sim->m1Range, sim->m2Range, 0);
+        ++edits;
+      }
+    }
+    UzzTrackSnap full = s;
+    full.playMask = ~0ull;
+    for (int i = 0; i < UZZ_MAX_STEPS; ++i)
+      compileStepSnap(full, i, nullptr, 0.f, sim->m1Range, sim->m2Range, 0);
+    for (int i = 0; i < UZZ_MAX_STEPS; ++i)
+      badSteps += !sameStep(s.step[i], full.step[i]);
+    badSteps += s.playMask != full.playMask;
+  }
+  printf("step tables: %ld steps recompiled on change, %ld differ from a full "
+         "compile\n",
+         edits, badSteps);
+  check(badSteps == 0, "recompiling changed steps differs from a full compile");
+}
+
+// Step traversal (user-033): the cached StepTraversal tables walked by
+// StepNavigator give the same steps, wraps, all-skip flags, navigator state
+// and random draws as the old per-tick scan (RefNavigator), for every
+// direction, window start and length, over lone and chained slot counts,
+// with the skip pattern changing as it runs.
+static void traversalMatchesReference() {
+  static const int SLOTS[] = {16, 32, 48, 64};
+  uint64_t lcg = 1;
+  auto rnd = [&](int n) {
+    lcg = lcg * 6364136223846793005ull + 1442695040888963407ull;
+    return (int)((lcg >> 33) % (uint64_t)n);
+  };
+  long steps = 0, bad = 0;
+  for (int slots : SLOTS)
+    for (int dir = DIR_MODE_MIN; dir <= DIR_MODE_MAX; ++dir)
+      for (int start = 0; start < slots; ++start)
+        for (int len = 1; len <= slots; len += (slots == 16 ? 1 : 3)) {
+          StepTraversal<UZZ_MAX_STEPS> tr;
+          StepNavigator nav;
+          RefNavigator ref;
+          ref.slots = slots;
+          UzzRng rngA, rngB;
+          rngA.seed(start * 131 + len, dir + 2);
+          rngB = rngA;
+          int modes[UZZ_MAX_STEPS];
+          int a = (start + rnd(len)) % slots, b = a;
+          nav.seqPos = ref.seqPos = rnd(2 * len);
+          nav.pingDir = ref.pingDir = rnd(2);
+          const int jumpN = 2 + rnd(6);
+          for (int k = 0; k < 96; ++k) {
+            if (k % 24 == 0) {
+              // Dense, sparse, all skipped or none skipped.
+              const int density = rnd(5);
+              for (int i = 0; i < slots; ++i)
+                modes[i] = density == 4 || rnd(4) < density ? SM_SKIP
+                                                            : SM_PLAY;
+            }
+            StepTraversal<UZZ_MAX_STEPS>::Mask mask = 0;
+            for (int i = 0; i < slots; ++i)
+              if (modes[i] != SM_SKIP)
+                mask |= (StepTraversal<UZZ_MAX_STEPS>::Mask)1 << i;
+            tr.update(dir, start, len, mask, jumpN, slots);
+            const bool current = rnd(10) == 0;
+            bool wa, sa, wb, sb;
+            a = nav.getNextStep(a, tr, current, wa, sa, rngA);
+            b = ref.getNextStep(b, start, len, dir, modes, current, wb, sb,
+                                jumpN, rngB);
+            ++steps;
+            if (a != b || wa != wb || sa != sb || nav.seqPos != ref.seqPos ||
+                nav.pingDir != ref.pingDir || nav.drunkDir != ref.drunkDir ||
+                rngA.gen.state[0] != rngB.gen.state[0]) {
+              if (bad++ < 5)
+                printf("traversal: %s slots %d start %d len %d tick %d: "
+                       "%d vs %d\n",
+                       dirLabel(dir), slots, start, len, k, a, b);
+              b = a;
+              ref.seqPos = nav.seqPos;
+              ref.pingDir = nav.pingDir;
+              rngB = rngA;
+            }
+          }
+        }
+  printf("traversal: %ld steps compared, %ld mismatches\n", steps, bad);
+  check(bad == 0, "StepTraversal differs from the per-tick scan");
+}
+
+// Phase-locked RATIO (user-035). A clock with edges at `edges` through
+// ClockProcessor at 48 kHz, PLL on or off; returns the tick times. Each edge
+// ramps up over one sample and stays high 5 ms.
+static std::vector<double> clockTicks(bool pll,
+                                      const std::vector<double> &edges,
+                                      float ratio, double seconds) {
+  ClockProcessor c;
+  c.reset();
+  c.pllMode = pll;
+  std::vector<double> ticks;
+  const double dt = 1.0 / 48000.0;
+  size_t e = 0;
+  for (long n = 0; n * dt < seconds; ++n) {
+    const double t = n * dt;
+    while (e + 1 < edges.size() && edges[e + 1] <= t)
+      ++e;
+    const double since = t - edges[e];
+    float v = 0.f;
+    if (since >= 0.0)
+      v = since < dt ? (float)(10.0 * since / dt) : since < 0.005 ? 10.f : 0.f;
+    float delay;
+    if (c.process((float)dt, v, ratio, 0.f, true, false, delay)) {
+      c.onTick();
+      ticks.push_back(t);
+    }
+  }
+  return ticks;
+}
+
+struct PllStats {
+  double intervalDev = 0.0; // SD of tick intervals, fraction of nominal
+  double meanPhase = 0.0;   // mean |tick - beat|, seconds, nearest tick
+  double maxPhase = 0.0;
+  int bunched = 0; // intervals under 0.75 of nominal
+  int dropped = 0; // over 1.25
+  int ticks = 0;   // ticks after `from`
+  // First beat from which every beat has a tick within 5 ms and every
+  // interval is within 10 % of nominal; -1 if never.
+  double lockedFrom = -1.0;
+};
+
+// Phase is taken on every `stride`-th beat from `first`: at x1.5 a tick
+// falls on every other beat only.
+static PllStats pllStats(const std::vector<double> &ticks,
+                         const std::vector<double> &beats, float ratio,
+                         double from, int stride = 1, int first = 0) {
+  PllStats s;
+  double sum = 0.0, sum2 = 0.0;
+  int n = 0;
+  // Last time a tick interval or a beat was off.
+  double lastBad = from;
+  for (size_t i = 1; i < ticks.size(); ++i) {
+    if (ticks[i - 1] <= from)
+      continue;
+    size_t b = 0;
+    while (b + 2 < beats.size() && beats[b + 1] <= ticks[i - 1])
+      ++b;
+    const double d =
+        (ticks[i] - ticks[i - 1]) / ((beats[b + 1] - beats[b]) / ratio);
+    sum += d;
+    sum2 += d * d;
+    ++n;
+    s.bunched += d < 0.75;
+    s.dropped += d > 1.25;
+    if (std::fabs(d - 1.0) > 0.1)
+      lastBad = std::max(lastBad, ticks[i]);
+  }
+  for (double t : ticks)
+    s.ticks += t > from;
+  const double m = sum / n;
+  s.intervalDev = std::sqrt(std::max(0.0, sum2 / n - m * m));
+  int nb = 0;
+  for (size_t b = first; b < beats.size(); b += stride) {
+    const double beat = beats[b];
+    if (beat <= from || beat > ticks.back() - 1.0)
+      continue;
+    double best = 1e9;
+    for (double t : ticks)
+      if (std::fabs(t - beat) < std::fabs(best))
+        best = t - beat;
+    s.meanPhase += std::fabs(best);
+    s.maxPhase = std::max(s.maxPhase, std::fabs(best));
+    if (std::fabs(best) > 0.005)
+      lastBad = std::max(lastBad, beat);
+    ++nb;
+  }
+  s.meanPhase /= nb;
+  for (double beat : beats)
+    if (beat > lastBad) {
+      s.lockedFrom = beat;
+      break;
+    }
+  return s;
+}
+
+// Gaussian edge jitter from a fixed LCG (Box-Muller), the same on every
+// standard library.
+struct Jitter {
+  uint64_t state = 7;
+  double uniform() {
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    return ((state >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+  }
+  double gauss(double sigma) {
+    return sigma * std::sqrt(-2.0 * std::log(uniform())) *
+           std::cos(6.283185307179586 * uniform());
+  }
+};
+
+static void printPll(const char *name, float ratio, bool pll,
+                     const PllStats &s) {
+  printf("pll: %-26s x%-4g %-6s interval SD %5.2f%%, |phase| mean %.2f ms "
+         "max %.2f ms, bunched %d, dropped %d\n",
+         name, ratio, pll ? "PLL" : "legacy", s.intervalDev * 100.0,
+         s.meanPhase * 1e3, s.maxPhase * 1e3, s.bunched, s.dropped);
+}
+
+static void clockPll() {
+  const double seconds = 60.0;
+  Jitter jitter;
+  // 120 BPM quarters, 3 ms of Gaussian jitter on each edge.
+  std::vector<double> beats, edges;
+  for (double t = 0.01; t < seconds + 1.0; t += 0.5) {
+    beats.push_back(t);
+    edges.push_back(t + jitter.gauss(0.003));
+  }
+  PllStats legacy = pllStats(clockTicks(false, edges, 4.f, seconds), beats,
+                             4.f, 3.0);
+  PllStats locked = pllStats(clockTicks(true, edges, 4.f, seconds), beats,
+                             4.f, 3.0);
+  printPll("120 BPM, 3 ms jitter", 4.f, false, legacy);
+  printPll("120 BPM, 3 ms jitter", 4.f, true, locked);
+  check(locked.intervalDev < 0.02 && locked.bunched == 0,
+        "PLL x4 under 3 ms jitter: interval SD over 2 % or bunched ticks");
+  check(locked.intervalDev < 0.5 * legacy.intervalDev,
+        "PLL x4 under jitter is not twice as steady as the legacy clock");
+  // The legacy timer leaves the last tick of each beat to the edge, however
+  // late it comes.
+  check(legacy.bunched == 0, "the legacy x4 clock bunches ticks under jitter");
+
+  // Tempo ramp 100 -> 160 BPM over the minute, 1 ms jitter.
+  beats.clear();
+  edges.clear();
+  for (double t = 0.01; t < seconds + 1.0;
+       t += 60.0 / (100.0 + 60.0 * t / seconds)) {
+    beats.push_back(t);
+    edges.push_back(t + jitter.gauss(0.001));
+  }
+  locked = pllStats(clockTicks(true, edges, 4.f, seconds), beats, 4.f, 3.0);
+  printPll("ramp 100-160 BPM, 1 ms", 4.f, true, locked);
+  check(locked.intervalDev < 0.02 && locked.bunched == 0,
+        "PLL x4 does not follow a tempo ramp smoothly");
+
+  // Fractional ratios: x1.5 and x2.5 give exactly 3 and 5 ticks per 2 beats
+  // on a steady clock, the group starting on every other beat (which ones
+  // depends on where it locked; RESET picks them in the module).
+  beats.clear();
+  for (double t = 0.01; t < seconds + 1.0; t += 0.5)
+    beats.push_back(t);
+  for (float ratio : {1.5f, 2.5f}) {
+    const std::vector<double> ticks = clockTicks(true, beats, ratio, 20.0);
+    locked = pllStats(ticks, beats, ratio, 3.0, 2, 0);
+    const PllStats odd = pllStats(ticks, beats, ratio, 3.0, 2, 1);
+    if (odd.meanPhase < locked.meanPhase)
+      locked = odd;
+    printPll("120 BPM, steady", ratio, true, locked);
+    const double expect = (20.0 - 3.0) / 0.5 * ratio;
+    check(std::fabs(locked.ticks - expect) <= 1.0 && locked.maxPhase < 0.001,
+          "PLL fractional ratio does not give N ticks per 2 beats on beat");
+  }
+
+  // Tempo step 120 -> 150 BPM at 30 s: lock time.
+  beats.clear();
+  for (double t = 0.01; t < seconds + 1.0; t += (t < 30.0 ? 0.5 : 0.4))
+    beats.push_back(t);
+  locked = pllStats(clockTicks(true, beats, 4.f, seconds), beats, 4.f, 30.0);
+  const double lockTime = locked.lockedFrom - 30.0;
+  printf("pll: tempo step 120->150 BPM x4, locked %.2f s after the step\n",
+         lockTime);
+  check(locked.lockedFrom > 0.0 && lockTime < 3.0,
+        "PLL takes over 3 s to re-lock after a tempo step");
+}
+
+// Event scheduler (user-036). EventScheduler against a plain list kept in
+// (time, type, insertion) order, with random pushes, cancels and pops across
+// the 2^32 wrap of the sample counter.
+static void schedulerMatchesList() {
+  struct Ev {
+    uint32_t time;
+    int type, target, seq;
+  };
+  EventScheduler<64> q;
+  std::vector<Ev> ref;
+  UzzRng rng;
+  rng.seed(36, 0);
+  uint32_t now = 0xFFFF0000u;
+  int seq = 0;
+  long ops = 0, bad = 0;
+  auto runsBefore = [&](const Ev &a, const Ev &b) {
+    if (a.time != b.time)
+      return (int32_t)(a.time - now) < (int32_t)(b.time - now);
+    if (a.type != b.type)
+      return a.type < b.type;
+    return a.seq < b.seq;
+  };
+  for (int k = 0; k < 200000; ++k, ++ops) {
+    const float u = rng.uniform();
+    const int type = (int)(rng.uniform() * 4.f);
+    const int target = (int)(rng.uniform() * 3.f);
+    if (u < 0.45f) {
+      const uint32_t t = now + (uint32_t)(rng.uniform() * 5000.f);
+      const bool pushed = q.push(t, type, target, seq & 0xFFFF);
+      if (pushed != (ref.size() < 64))
+        ++bad;
+      if (pushed) {
+        Ev e = {t, type, target, seq};
+        auto it = ref.begin();
+        while (it != ref.end() && !runsBefore(e, *it))
+          ++it;
+        ref.insert(it, e);
+      }
+      ++seq;
+    } else if (u < 0.5f) {
+      q.cancel(type, target);
+      for (size_t i = ref.size(); i-- > 0;)
+        if (ref[i].type == type && ref[i].target == target)
+          ref.erase(ref.begin() + i);
+    } else if (u < 0.55f) {
+      const uint32_t after = now + (uint32_t)(rng.uniform() * 2000.f);
+      q.cancelAfter(type, target, after);
+      for (size_t i = ref.size(); i-- > 0;)
+        if (ref[i].type == type && ref[i].target == target &&
+            (int32_t)(ref[i].time - after) > 0)
+          ref.erase(ref.begin() + i);
+    } else {
+      now += (uint32_t)(rng.uniform() * 300.f);
+      while (q.due(now)) {
+        const SchedEvent e = q.pop();
+        if (ref.empty() || e.time != ref[0].time || e.type != ref[0].type ||
+            e.target != ref[0].target || e.arg != (ref[0].seq & 0xFFFF))
+          ++bad;
+        if (!ref.empty())
+          ref.erase(ref.begin());
+      }
+      if (!ref.empty() && (int32_t)(ref[0].time - now) <= 0)
+        ++bad;
+    }
+    if (q.count != (int)ref.size())
+      ++bad;
+  }
+  printf("scheduler: %ld operations across the counter wrap, %ld mismatches\n",
+         ops, bad);
+  check(bad == 0, "EventScheduler differs from an ordered list");
+}
+
+// Rising and falling edges of track 1's gate and the samples it landed on a
+// step, over `seconds`, with RESET on the samples in `resets`.
+struct GateTrace {
+  std::vector<uint64_t> on, off, ticks;
+};
+
+static GateTrace traceGate(UzzSim &sim, double seconds,
+                           const std::vector<uint64_t> &resets = {}) {
+  GateTrace g;
+  bool high = false;
+  size_t r = 0;
+  const uint64_t n = (uint64_t)(seconds * sim.sampleRate);
+  for (uint64_t i = 0; i < n; ++i) {
+    const bool reset = r < resets.size() && resets[r] == i;
+    r += reset;
+    sim.process(reset);
+    if (sim.out.moved & 1)
+      g.ticks.push_back(i);
+    if (sim.out.gate[0] != high)
+      (high ? g.off : g.on).push_back(i);
+    high = sim.out.gate[0];
+  }
+  return g;
+}
+
+// Every step the same: mode, the PROB/pulse knob and DUR.
+static std::unique_ptr<UzzSim> uniformSim(int mode, float prob, float dur) {
+  std::unique_ptr<UzzSim> sim(new UzzSim());
+  for (int i = 0; i < UZZ_MAX_STEPS; ++i) {
+    sim->raw[0][ROW_MODE][i] = (float)mode;
+    sim->raw[0][ROW_PROB][i] = prob;
+    sim->raw[0][ROW_DUR][i] = dur;
+  }
+  sim->compile();
+  return sim;
+}
+
+// Gate timing on the scheduler: ratchet sub-pulses land on the sample
+// nearest to their ideal time and all last the same; a long GATED step holds
+// its full length; RESET cuts a ratchet and a HOLD count short.
+static void gateTiming() {
+  const int tickSamples = 6000; // 16ths of 120 BPM at 48 kHz
+  const uint64_t firstTick = 480; // the first clock edge, at 10 ms
+  std::unique_ptr<UzzSim> sim = uniformSim(SM_PULSE, 3.f, 0.5f);
+  GateTrace g = traceGate(*sim, 4.0);
+  int worst = 0, lenSpread = 0, subPulses = 0;
+  size_t on = 0;
+  for (size_t k = 1; k + 1 < g.ticks.size(); ++k)
+    for (int j = 0; j < 4; ++j, ++on, ++subPulses) {
+      while (on < g.on.size() && g.on[on] < g.ticks[k])
+        ++on;
+      if (on >= g.on.size())
+        break;
+      const long ideal = (long)g.ticks[k] + std::lround(j * tickSamples / 4.0);
+      worst = std::max(worst, (int)std::labs((long)g.on[on] - ideal));
+      lenSpread = std::max(lenSpread,
+                           (int)std::labs((long)(g.off[on] - g.on[on]) -
+                                          (long)(g.off[1] - g.on[1])));
+    }
+  printf("ratchets: %d sub-pulses, at most %d samples from the ideal onset, "
+         "lengths within %d samples\n",
+         subPulses, worst, lenSpread);
+  check(subPulses > 100 && worst <= 1 && lenSpread <= 1,
+        "ratchet sub-pulses drift from their ideal onsets or lengths");
+
+  // GATED over 8 ticks: one gate of 8 periods less TRIG_LEN, the same length
+  // every time (the period estimate leaves it a sample or two short).
+  sim = uniformSim(SM_GATED, 7.f, 0.5f);
+  g = traceGate(*sim, 12.0);
+  const long want = std::lround((8 * 0.125 - TRIG_LEN) * 48000.0);
+  long minLen = LONG_MAX, maxLen = 0;
+  for (size_t k = 1; k < g.off.size(); ++k) {
+    minLen = std::min(minLen, (long)(g.off[k] - g.on[k]));
+    maxLen = std::max(maxLen, (long)(g.off[k] - g.on[k]));
+  }
+  printf("gated: %zu gates of %ld..%ld samples, ideal %ld\n",
+         g.off.size() - 1, minLen, maxLen, want);
+  check(g.off.size() > 5 && maxLen - minLen == 0 &&
+            std::labs(minLen - want) <= 2,
+        "a long GATED gate drifts or misses its length");
+
+  // RESET 2000 samples into an 8-pulse ratchet: nothing more plays until the
+  // next tick.
+  sim = uniformSim(SM_PULSE, 7.f, 0.5f);
+  const uint64_t resetAt = firstTick + 8 * tickSamples + 2000;
+  g = traceGate(*sim, 2.0, {resetAt});
+  int late = 0;
+  uint64_t nextTick = 0;
+  for (uint64_t t : g.ticks)
+    if (t > resetAt && !nextTick)
+      nextTick = t;
+  for (uint64_t t : g.on)
+    late += t > resetAt && t < nextTick;
+  printf("reset: %d sub-pulses after RESET before the next tick\n", late);
+  check(nextTick && late == 0, "RESET does not cancel a running ratchet");
+
+  // HOLD of 4 ticks, RESET after the second tick of the third hold: the next
+  // tick plays the start step afresh instead of spending the rest of the
+  // hold.
+  sim = uniformSim(SM_HOLD, 3.f, 0.5f);
+  const uint64_t holdReset = firstTick + 9 * tickSamples + 3000;
+  g = traceGate(*sim, 2.0, {holdReset});
+  std::vector<uint64_t> want4 = {firstTick, firstTick + 4 * tickSamples,
+                                 firstTick + 8 * tickSamples,
+                                 firstTick + 10 * tickSamples};
+  g.ticks.resize(std::min(g.ticks.size(), want4.size()));
+  check(g.ticks == want4,
+        "RESET between ticks keeps the HOLD count of the step it left");
+}
+
+// Per-instance seed (user-039). With the seed restarted on RESET, two passes
+// play the same; each track draws from its own stream, so adding tracks
+// leaves track 1's rolls alone; and a row fill takes two values per 64-bit
+// draw.
+
+static void seedReplay() {
+  const uint64_t seed = 0x5EED0039ull;
+  const uint64_t pass = 32 * 6000; // 32 ticks, a whole number of clocks
+  int same = 0;
+  for (int dir : {DIR_RANDOM, DIR_DRUNK}) {
+    std::unique_ptr<UzzSim> sim = randomSim(UZZ_MAX_TRACKS, dir);
+    sim->engine.reseed(seed);
+    passTrace(*sim, pass, UZZ_MAX_TRACKS);
+    sim->engine.reseed(seed);
+    const std::string a = passTrace(*sim, pass, UZZ_MAX_TRACKS);
+    sim->engine.reseed(seed);
+    const std::string b = passTrace(*sim, pass, UZZ_MAX_TRACKS);
+    same += a == b && !a.empty();
+  }
+  check(same == 2, "two passes after RESET with the seed restarted differ");
+
+  std::unique_ptr<UzzSim> one = randomSim(1, DIR_RANDOM);
+  std::unique_ptr<UzzSim> eight = randomSim(UZZ_MAX_TRACKS, DIR_RANDOM);
+  one->engine.reseed(seed);
+  eight->engine.reseed(seed);
+  const std::string a = passTrace(*one, 4 * pass, 1);
+  const std::string b = passTrace(*eight, 4 * pass, 1);
+  printf("seed: %zu trace bytes replayed, track 1 alone and among 8 %s\n",
+         a.size(), a == b ? "match" : "differ");
+  check(a == b, "adding tracks changes track 1's random draws");
+
+  UzzRng x, y;
+  x.seed(seed, 0);
+  y.seed(seed, 0);
+  float v[16];
+  x.fill(v, 16);
+  bool twoPerDraw = true;
+  for (int i = 0; i < 16; i += 2) {
+    const uint64_t r = y.gen();
+    twoPerDraw = twoPerDraw && v[i] == (float)(r >> 40) / 16777216.f &&
+                 v[i + 1] == (float)((r >> 16) & 0xFFFFFF) / 16777216.f;
+  }
+  check(twoPerDraw && x.gen() == y.gen(),
+        "a row fill does not take two values per 64-bit draw");
+}
+
+// Micro-timing (user-044). At 44.1 kHz and a 4410-sample tick, with MPC 66%
+// and two step offsets, every landing moves from the straight run's by the
+// groove of its tick plus the offset of its step, limited to half a step.
+// Step 6 (-40%) and step 8 (+30%) fall on swung ticks; early steps may be a
+// sample off, late ones must be exact.
+static std::vector<uint64_t> grooveLandings(bool groove, int *steps) {
+  std::unique_ptr<UzzSim> sim = playSim(44);
+  sim->sampleRate = 44100.0;
+  sim->period = 0.1;
+  sim->in.sampleTime = (float)(1.0 / sim->sampleRate);
+  if (groove) {
+    for (int i = 0; i < 16; ++i)
+      sim->engine.grooveFrac[i] = UZZ_GROOVES[4].offset[i]; // MPC 66%
+    sim->engine.microFrac[0][6] = -0.4f;
+    sim->engine.microFrac[0][8] = 0.3f;
+  }
+  sim->engine.timingChanged();
+  std::vector<uint64_t> at;
+  eachLanding(*sim, 48 * 4410, [&](uint64_t n) {
+    if (steps && at.size() < 48)
+      steps[at.size()] = sim->engine.tracks[0].step;
+    at.push_back(n);
+  });
+  return at;
+}
+
+static void microTiming() {
+  int steps[48];
+  const std::vector<uint64_t> straight = grooveLandings(false, nullptr);
+  const std::vector<uint64_t> swung = grooveLandings(true, steps);
+  int wrong = 0;
+  long swing = 0, early = 0, clamped = 0;
+  const size_t n = std::min<size_t>(48, std::min(straight.size(),
+                                                 swung.size()));
+  for (size_t k = 0; k < n; ++k) {
+    const long d = (long)swung[k] - (long)straight[k];
+    const long groove = k & 1 ? std::lround(0.32f * 4410.f) : 0;
+    long micro = 0;
+    if (steps[k] == 6)
+      micro = std::lround(-0.4f * 4410.f);
+    else if (steps[k] == 8)
+      micro = std::lround(0.3f * 4410.f);
+    // An early step is timed against the predicted tick, which can be a
+    // sample off the real edge at a 4410.x-sample period.
+    const long want = std::max(-2205L, std::min(2205L, groove + micro));
+    wrong += std::abs(d - want) > (want < 0 ? 1 : 0);
+    if (k & 1 && !micro)
+      swing = d;
+    else if (steps[k] == 6)
+      early = -d;
+    else if (steps[k] == 8)
+      clamped = d;
+  }
+  printf("groove: MPC 66%% moves odd ticks %ld samples, a -40%% step plays "
+         "%ld early, +30%% on a swung step %ld late; %d of %zu wrong\n",
+         swing, early, clamped, wrong, n);
+  check(n == 48 && wrong == 0 && swing == 1411 && early == 353 &&
+            clamped == 2205,
+        "micro-timed steps do not land on groove plus offset");
+}
+
+// ADDR scan (user-047). Neighbouring bands overlap by 2 x HYST of a step
+// for every window length; outside its band the CV picks the same step as
+// clocked ADDR's rounding; a CV sitting on a boundary with +-0.15 step of
+// noise changes step at most once where plain rounding chatters; and on the
+// engine, with no clock, a noisy ramp plays the 16 steps once each, in
+// order.
+static void addrScan() {
+  UzzAddrScan scan;
+  int badBands = 0;
+  for (int n = 2; n <= UZZ_MAX_STEPS; ++n) {
+    scan.process(0.f, n);
+    for (int k = 0; k + 1 < n; ++k)
+      badBands += std::fabs((scan.hi[k] - scan.lo[k + 1]) * scan.perVolt -
+                            2.f * UzzAddrScan::HYST) > 1e-4f;
+  }
+  check(badBands == 0, "ADDR scan bands do not overlap by 2 x HYST");
+
+  UzzRng rng;
+  rng.seed(47, 0);
+  int badPicks = 0;
+  for (int i = 0; i < 100000; ++i) {
+    const int n = 2 + (int)(rng.uniform() * 31.f);
+    const int prev = scan.process(10.f * rng.uniform(), n);
+    const float v = 10.f * rng.uniform();
+    const int got = scan.process(v, n);
+    const float x = v * scan.perVolt;
+    const int round = clamp((int)std::lround(x), 0, n - 1);
+    const bool held = got == prev &&
+                      std::fabs(x - (float)prev) < 0.5f + UzzAddrScan::HYST;
+    badPicks += got != round && !held;
+  }
+  check(badPicks == 0, "ADDR scan leaves clocked ADDR's rounding");
+
+  int changes = 0, plainChanges = 0, plainPrev = -1, last = -1;
+  scan.process(0.f, 16);
+  const float edge = 7.5f / scan.perVolt; // between steps 7 and 8
+  for (int i = 0; i < 48000; ++i) {
+    const float v = edge + (rng.uniform() - 0.5f) * 0.3f / scan.perVolt;
+    const int got = scan.process(v, 16);
+    const int plain = (int)std::lround(v * scan.perVolt);
+    changes += last >= 0 && got != last;
+    plainChanges += plainPrev >= 0 && plain != plainPrev;
+    last = got;
+    plainPrev = plain;
+  }
+
+  std::unique_ptr<UzzSim> sim(new UzzSim());
+  sim->clockOn = false;
+  sim->in.addressed = true;
+  sim->in.scan = true;
+  sim->compile();
+  UzzAddrScan engineScan;
+  std::vector<int> visited;
+  for (int i = 0; i < 48000; ++i) {
+    const float ramp = 10.f * (float)i / 48000.f;
+    const float v = clamp(ramp + (rng.uniform() - 0.5f) * 0.1f, 0.f, 10.f);
+    sim->in.relAddr = engineScan.process(v, sim->in.steps);
+    sim->process();
+    if (sim->out.moved & 1)
+      visited.push_back(sim->engine.tracks[0].step);
+  }
+  int badOrder = visited.size() != 15;
+  for (size_t k = 0; k < visited.size(); ++k)
+    badOrder += visited[k] != (int)k + 1;
+  printf("addr scan: a noisy boundary changes step %d times (%d without "
+         "hysteresis); a noisy ramp lands %zu times, %d out of order\n",
+         changes, plainChanges, visited.size(), badOrder);
+  check(changes <= 1, "ADDR scan chatters on a noisy boundary");
+  check(badOrder == 0, "an ADDR scan ramp does not play the steps in order");
+}
+
+// Latency probe (user-048). Attached, it does not change what the engine
+// plays. On a steady clock the tick of each edge plays on the edge's own
+// sample at x1 and when multiplying, at most four samples after it when
+// dividing, and the gate opens on the tick; at xN one tick in N carries an
+// edge; at /2 half the edges go unclaimed. The CSV has a line per logged
+// tick.
+static void latencyProbe() {
+  const float ratios[] = {1.f, 2.f, 4.f, 0.5f};
+  for (float ratio : ratios) {
+    std::unique_ptr<UzzSim> bare(new UzzSim()), probed(new UzzSim());
+    UzzLatencyProbe probe;
+    probed->engine.probe = &probe;
+    int diffs = 0;
+    for (UzzSim *sim : {bare.get(), probed.get()}) {
+      sim->in.ratio = ratio;
+      sim->compile();
+    }
+    for (int n = 0; n < 48000 * 8; ++n) {
+      bare->process();
+      probed->process();
+      diffs += bare->out.gate[0] != probed->out.gate[0] ||
+               bare->out.pitch[0] != probed->out.pitch[0] ||
+               bare->out.stepGates != probed->out.stepGates;
+    }
+    UzzLatencyLog log;
+    check(probe.snapshot(log), "no latency snapshot with nothing writing");
+    int withEdge = 0;
+    for (int k = 0; k < log.count; ++k)
+      withEdge += log.log[k].hasEdge;
+    const std::string csv = log.csv();
+    const int lines = (int)std::count(csv.begin(), csv.end(), '\n');
+    printf("latency x%.1f: %u edges, %u ticks, %u unclaimed; edge->tick %s, "
+           "tick->gate %s; %d samples differ with the probe\n",
+           ratio, log.edges, log.ticks, log.unclaimed,
+           log.describe(log.edgeToTick).c_str(),
+           log.describe(log.tickToGate).c_str(), diffs);
+    check(diffs == 0, "attaching the latency probe changes the output");
+    check(log.edgeToTick.min >= 0 &&
+              log.edgeToTick.max <= (ratio >= 1.f ? 0 : 4) &&
+              log.tickToGate.max == 0 && log.tickToGate.n > 0,
+          "a steady clock shows a tick off its edge or a late gate");
+    check(lines == log.count + 1, "the latency CSV misses ticks");
+    if (ratio == 1.f)
+      check(log.unclaimed == 0 && withEdge == log.count,
+            "at x1 a tick does not claim its edge");
+    else if (ratio > 1.f)
+      check(std::abs((int)ratio * withEdge - log.count) <= (int)ratio,
+            "at xN not one tick in N claims an edge");
+    else
+      check(std::abs((int)(2 * log.unclaimed) - (int)log.edges) <= 2,
+            "at /2 not every other edge goes unclaimed");
+  }
+}
+
+// A menu thread taking snapshots while the engine runs at x4 only ever sees
+// whole updates: the ring head and fill match the tick count, and the ring
+// holds no record older than one it has already overwritten.
+static void latencySnapshots() {
+  std::unique_ptr<UzzSim> sim(new UzzSim());
+  UzzLatencyProbe probe;
+  sim->engine.probe = &probe;
+  sim->in.ratio = 4.f;
+  sim->period = 0.002; // a tick every 24 samples
+  sim->pulseWidth = 0.0005;
+  sim->compile();
+  std::atomic<bool> done{false};
+  long taken = 0, busy = 0, torn = 0;
+  std::thread menu([&]() {
+    UzzLatencyLog log;
+    while (!done.load()) {
+      if (!probe.snapshot(log, 1)) {
+        ++busy;
+        continue;
+      }
+      ++taken;
+      bool ok = log.head == (int)(log.ticks % UzzLatencyLog::SIZE) &&
+                log.count == (int)std::min<uint32_t>(log.ticks,
+                                                      UzzLatencyLog::SIZE);
+      // Oldest to newest, the logged ticks only go forward.
+      const int first = (log.head + UzzLatencyLog::SIZE - log.count) %
+                        UzzLatencyLog::SIZE;
+      for (int k = 1; ok && k < log.count; ++k)
+        ok = (int32_t)(log.log[(first + k) % UzzLatencyLog::SIZE].tick -
+                       log.log[(first + k - 1) % UzzLatencyLog::SIZE].tick) >
+             0;
+      torn += !ok;
+    }
+  });
+  for (int n = 0; n < 48000 * 20; ++n)
+    sim->process();
+  done.store(true);
+  menu.join();
+  UzzLatencyLog last;
+  probe.snapshot(last);
+  printf("latency snapshots: %u ticks, %ld snapshots taken, %ld retried, %ld "
+         "torn\n",
+         last.ticks, taken, busy, torn);
+  check(taken > 0 && torn == 0, "a latency snapshot shows a torn update");
+}
+
+int main() {
+  tracksIndependent();
+  compiledTables();
+  traversalMatchesReference();
+  clockPll();
+  schedulerMatchesList();
+  gateTiming();
+  seedReplay();
+  microTiming();
+  addrScan();
+  latencyProbe();
+  latencySnapshots();
+  return report();
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "uzz_sim.hpp"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+// What the UZZ check programs share: the failure count and its report, the
+// usual simulators, and the loops most checks run them through. Each program
+// backs the claims of one subsystem, a function per feature, and exits
+// non-zero when a check fails.
+
+inline int &failures() {
+  static int n = 0;
+  return n;
+}
+
+inline void check(bool ok, const char *what) {
+  if (!ok) {
+    ++failures();
+    printf("FAIL: %s\n", what);
+  }
+}
+
+// The end of main(): "ok" or the failure count, and the exit code.
+inline int report() {
+  printf(failures() ? "%d failures\n" : "ok\n", failures());
+  return failures() ? 1 : 0;
+}
+
+inline double secondsSince(std::chrono::steady_clock::time_point t0) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0)
+      .count();
+}
+
+static const int PLAY_ONLY[] = {SM_PLAY};
+static const int BUSY_MODES[] = {SM_PLAY, SM_PLAY, SM_PULSE, SM_GATED,
+                                 SM_ACCUM_UP};
+static const int ALL_STEP_MODES[] = {SM_PLAY,     SM_MUTE,       SM_SKIP,
+                                     SM_ACCUM_UP, SM_ACCUM_DOWN, SM_PULSE,
+                                     SM_GATED,    SM_HOLD};
+
+// A running engine with `tracks` tracks of random steps at 16ths of 120 BPM.
+inline std::unique_ptr<UzzSim> busySim(int tracks, uint64_t seed) {
+  std::unique_ptr<UzzSim> sim(new UzzSim());
+  sim->engine.reseed(seed);
+  sim->randomize(seed, tracks, BUSY_MODES, 5);
+  sim->engine.trackCount = tracks;
+  sim->in.pGlobal = 0.9f;
+  sim->compile();
+  return sim;
+}
+
+// One track of random PLAY steps: every tick lands and sounds. Compiled
+// unless the caller still has rows to change.
+inline std::unique_ptr<UzzSim> playSim(uint64_t seed, bool compile = true) {
+  std::unique_ptr<UzzSim> sim(new UzzSim());
+  sim->randomize(seed, 1, PLAY_ONLY, 1);
+  if (compile)
+    sim->compile();
+  return sim;
+}
+
+// Random steps of the busy modes in direction `dir`, some left to chance.
+inline std::unique_ptr<UzzSim> randomSim(int tracks, int dir) {
+  std::unique_ptr<UzzSim> sim(new UzzSim());
+  sim->randomize(39, tracks, BUSY_MODES, 5);
+  sim->engine.trackCount = tracks;
+  sim->in.modeDir = dir;
+  sim->in.pGlobal = 0.7f;
+  sim->compile();
+  return sim;
+}
+
+// Runs `samples` samples and calls f(n) on each one on which track 1 lands
+// on a step (sim.engine.tracks[0].step).
+template <typename F>
+void eachLanding(UzzSim &sim, uint64_t samples, F f) {
+  for (uint64_t n = 0; n < samples; ++n) {
+    sim.process();
+    if (sim.out.moved & 1)
+      f(n);
+  }
+}
+
+// One line per landing of the first `tracks` tracks: sample, track, gate and
+// pitch. RESET on the first sample.
+inline std::string passTrace(UzzSim &sim, uint64_t samples, int tracks) {
+  std::string trace;
+  char line[48];
+  for (uint64_t i = 0; i < samples; ++i) {
+    sim.process(i == 0);
+    for (int t = 0; t < tracks; ++t)
+      if (sim.out.moved >> t & 1) {
+        snprintf(line, sizeof(line), "%llu %d %d %.4f\n",
+                 (unsigned long long)i, t, (int)sim.out.gate[t],
+                 sim.out.pitch[t]);
+        trace += line;
+      }
+  }
+  return trace;
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "uzz/UzzRandom.hpp"
+#include "uzz/UzzTypes.hpp"
+
+#include <cstdlib>
+
+// Reference model for StepTraversal + StepNavigator: the navigator as it was
+// before the traversal tables, which scanned the step modes on every tick.
+// Kept as it was apart from two things: RANDOM and DRUNK draw from a UzzRng,
+// like the current one, and the window wraps around `slots` instead of a
+// fixed 16, so chains can be checked too (with slots = 16 it is the original
+// code). uzz_engine compares the two step by step.
+struct RefNavigator {
+  int pingDir = 0;
+  int drunkDir = 1;
+  int seqPos = 0;
+  int slots = 16;
+
+  int wrap(int i) const { return ((i % slots) + slots) % slots; }
+
+  static int igcd(int a, int b) {
+    a = std::abs(a);
+    b = std::abs(b);
+    while (b) {
+      int t = b;
+      b = a % b;
+      a = t;
+    }
+    return a ? a : 1;
+  }
+
+  int findNextPlayable(int start, int len, int currentRel, int direction,
+                       const int *modes, bool &allSkip) {
+    allSkip = true;
+    int rel = currentRel;
+
+    for (int tries = 0; tries < len; ++tries) {
+      rel = (direction > 0) ? (rel + 1) % len : (rel - 1 + len) % len;
+      int cand = wrap(start + rel);
+
+      if (modes[cand] != SM_SKIP) {
+        allSkip = false;
+        return cand;
+      }
+    }
+
+    int relTheo =
+        (direction > 0) ? (currentRel + 1) % len : (currentRel - 1 + len) % len;
+    return wrap(start + relTheo);
+  }
+
+  int getNextStep(int currentStep, int start, int steps, int dirMode,
+                  const int *modes, bool playCurrentStep, bool &wrapped,
+                  bool &allSkip, int jumpN, UzzRng &rng) {
+    int relBefore = wrap(currentStep - start);
+    int nextStep = currentStep;
+    wrapped = false;
+    allSkip = false;
+
+    if (playCurrentStep) {
+      allSkip = modes[currentStep] == SM_SKIP;
+      return currentStep;
+    }
+
+    if (dirMode == DIR_FWD || dirMode == DIR_REV) {
+      int direction = (dirMode == DIR_FWD) ? 1 : -1;
+      nextStep =
+          findNextPlayable(start, steps, relBefore, direction, modes, allSkip);
+
+      int relAfter = wrap(nextStep - start);
+      wrapped =
+          (direction > 0) ? (relAfter < relBefore) : (relAfter > relBefore);
+    } else if (dirMode == DIR_PENDULUM) {
+      int direction = (pingDir == 0) ? 1 : -1;
+      bool all1 = false;
+      int cand1 =
+          findNextPlayable(start, steps, relBefore, direction, modes, all1);
+      int relAfter1 = wrap(cand1 - start);
+      bool wouldWrap =
+          (direction > 0) ? (relAfter1 < relBefore) : (relAfter1 > relBefore);
+
+      if (!all1 && !wouldWrap) {
+        nextStep = cand1;
+        wrapped = false;
+      } else {
+        pingDir = 1 - pingDir;
+        int direction2 = (pingDir == 0) ? 1 : -1;
+        bool all2 = false;
+        nextStep =
+            findNextPlayable(start, steps, relBefore, direction2, modes, all2);
+        wrapped = true;
+      }
+    } else if (dirMode == DIR_PINGPONG) {
+      int cycleLen = 2 * steps;
+      int oldPos = seqPos;
+      seqPos = (seqPos + 1) % cycleLen;
+      int rel = (seqPos < steps) ? seqPos : (2 * steps - 1 - seqPos);
+      nextStep = wrap(start + rel);
+      wrapped = (seqPos == 0 && oldPos != 0);
+    } else if (dirMode == DIR_ODD_EVEN) {
+      int oldPos = seqPos;
+      seqPos = (seqPos + 1) % steps;
+      int half = (steps + 1) / 2;
+      int rel = (seqPos < half) ? seqPos * 2 : (seqPos - half) * 2 + 1;
+      nextStep = wrap(start + rel);
+      wrapped = (seqPos == 0 && oldPos != 0);
+    } else if (dirMode == DIR_JUMP) {
+      int jn = clamp(jumpN, 2, steps > 1 ? steps - 1 : 1);
+      int cycleLen = steps / igcd(steps, jn);
+      int oldPos = seqPos % cycleLen;
+      seqPos = (oldPos + 1) % cycleLen;
+      int rel = (seqPos * jn) % steps;
+      nextStep = wrap(start + rel);
+      wrapped = (seqPos == 0 && oldPos != 0);
+    } else if (dirMode == DIR_CONVERGE) {
+      int oldPos = seqPos;
+      seqPos = (seqPos + 1) % steps;
+      int rel = (seqPos % 2 == 0) ? seqPos / 2 : steps - 1 - seqPos / 2;
+      nextStep = wrap(start + rel);
+      wrapped = (seqPos == 0 && oldPos != 0);
+    } else if (dirMode == DIR_DIVERGE) {
+      int oldPos = seqPos;
+      seqPos = (seqPos + 1) % steps;
+      int center = (steps - 1) / 2;
+      int rel = (seqPos % 2 == 0) ? center - seqPos / 2
+                                  : center + (seqPos + 1) / 2;
+      nextStep = wrap(start + rel);
+      wrapped = (seqPos == 0 && oldPos != 0);
+    } else if (dirMode == DIR_RANDOM) {
+      int pool[64];
+      int poolSize = 0;
+
+      for (int k = 0; k < steps; ++k) {
+        int sIdx = wrap(start + k);
+        if (modes[sIdx] != SM_SKIP)
+          pool[poolSize++] = sIdx;
+      }
+
+      if (poolSize > 0) {
+        int idx = (int)std::floor(rng.uniform() * poolSize);
+        idx = clamp(idx, 0, poolSize - 1);
+        nextStep = pool[idx];
+      } else {
+        bool dummy = false;
+        nextStep = findNextPlayable(start, steps, relBefore, 1, modes, dummy);
+      }
+      wrapped = false;
+    } else {
+      drunkDir = (rng.uniform() < 0.5f) ? -1 : 1;
+
+      bool allA = false;
+      int candA =
+          findNextPlayable(start, steps, relBefore, drunkDir, modes, allA);
+
+      if (!allA) {
+        nextStep = candA;
+      } else {
+        bool allB = false;
+        nextStep =
+            findNextPlayable(start, steps, relBefore, -drunkDir, modes, allB);
+      }
+
+      int relAfter = wrap(nextStep - start);
+      wrapped = (relBefore == 0 && relAfter == (steps - 1)) ||
+                (relBefore == (steps - 1) && relAfter == 0);
+    }
+
+    return nextStep;
+  }
+};
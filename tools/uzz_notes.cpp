@@ -0,0 +1,236 @@
+// UZZ notes: the scale quantizer, chords and trig conditions.
+//
+//   make -C tools uzz_notes && tools/build/uzz_notes
+
+#include "uzz/UzzCond.hpp"
+#include "uzz_fixture.hpp"
+
+#include <climits>
+
+// Scale quantizer (user-042). The table gives, for every root and scale and
+// for semitones well past its 128 entries, the nearest in-scale note, the
+// lower on a tie; "Off" is the identity. On the engine, a track with a scale
+// plays that note for the whole sum of PITCH, OCT and XPOSE, and switching
+// the scale back off gives the same trace as a track never quantized.
+static int nearestInScale(int root, int scale, int n) {
+  const UzzScaleDef &def = UZZ_SCALES[scale];
+  int best = INT_MAX;
+  for (int oct = -20; oct <= 20; ++oct)
+    for (int k = 0; k < def.n; ++k) {
+      const int c = def.s[k] + root + 12 * oct;
+      const int d = std::abs(c - n), bd = std::abs(best - n);
+      if (best == INT_MAX || d < bd || (d == bd && c < best))
+        best = c;
+    }
+  return best;
+}
+
+static void scaleTable() {
+  int wrong = 0, offMoved = 0, checked = 0;
+  UzzScaleLut lut;
+  for (int scale = 0; scale < UZZ_NUM_SCALES; ++scale)
+    for (int root = 0; root < 12; ++root) {
+      lut.set(root, scale);
+      for (int n = -200; n <= 200; ++n, ++checked) {
+        wrong += lut.quantize(n) != nearestInScale(root, scale, n);
+        offMoved += scale == 0 && lut.quantize(n) != n;
+      }
+    }
+  printf("scale: %d notes over %d scales and 12 roots, %d off the nearest "
+         "in-scale note\n",
+         checked, UZZ_NUM_SCALES, wrong);
+  check(wrong == 0, "the scale table misses the nearest in-scale note");
+  check(offMoved == 0, "the Off scale moves notes");
+
+  const int root = 2, minor = 2; // D natural minor
+  std::unique_ptr<UzzSim> sim = randomSim(1, DIR_FWD);
+  sim->in.xposeSemis = 5;
+  sim->engine.setScale(root, minor);
+  int offScale = 0, landings = 0;
+  eachLanding(*sim, 64 * 6000, [&](uint64_t) {
+    const int step = sim->engine.tracks[0].step;
+    const UzzStepSnap &st = sim->engine.snap[0].step[step];
+    const int sum = (int)std::lround(st.semis) + 5 + st.oct * 12 +
+                    sim->engine.tracks[0].accumOffset[step];
+    offScale += sim->out.pitch[0] !=
+                (float)nearestInScale(root, minor, sum) / 12.f;
+    ++landings;
+  });
+  check(landings > 50 && offScale == 0,
+        "a quantized track does not play the nearest in-scale note");
+
+  std::unique_ptr<UzzSim> plain = randomSim(1, DIR_FWD);
+  std::unique_ptr<UzzSim> undone = randomSim(1, DIR_FWD);
+  undone->engine.setScale(root, minor);
+  undone->engine.setScale(0, 0);
+  const std::string a = passTrace(*plain, 32 * 6000, 1);
+  const std::string b = passTrace(*undone, 32 * 6000, 1);
+  check(!a.empty() && a == b, "a scale switched off still changes the output");
+}
+
+// Chords (user-046). Chromatic chords are their semitone intervals; with a
+// scale, voice d is the d-th scale note above the root (7 adds an octave),
+// for every scale and root. On the engine, each voice of the float_4 slew is
+// bit for bit the scalar slew of the unslewed voice, and voices a chord does
+// not have repeat the root.
+static int scaleNoteAbove(const UzzScaleLut &lut, int pc, int d) {
+  int n = pc;
+  for (int k = 0; k < d % 7; ++k) {
+    ++n;
+    while (!lut.in[n % 12])
+      ++n;
+  }
+  return n - pc + 12 * (d / 7);
+}
+
+static std::unique_ptr<UzzSim> chordSim(float slew) {
+  std::unique_ptr<UzzSim> sim(new UzzSim());
+  sim->randomize(46, 2, BUSY_MODES, 5);
+  for (int t = 0; t < 2; ++t)
+    for (int i = 0; i < 16; ++i)
+      sim->chord[t][i] = (i * 5 + t * 3) % UZZ_NUM_CHORDS;
+  sim->engine.trackCount = 2;
+  sim->engine.setScale(9, 4); // A dorian
+  sim->in.slewAlpha = slew;
+  sim->compile();
+  return sim;
+}
+
+static void chords() {
+  UzzScaleLut lut;
+  UzzChordLut table;
+  int wrong = 0;
+  for (int scale = 0; scale < UZZ_NUM_SCALES; ++scale)
+    for (int root = 0; root < 12; ++root) {
+      lut.set(root, scale);
+      table.build(lut);
+      for (int c = 0; c < UZZ_NUM_CHORDS; ++c)
+        for (int pc = 0; pc < 12; ++pc) {
+          if (scale && !lut.in[pc])
+            continue;
+          const UzzChordDef &def = UZZ_CHORDS[c];
+          for (int k = 0; k < UZZ_CHORD_VOICES; ++k) {
+            int semis = 0;
+            if (k < def.n)
+              semis = scale ? scaleNoteAbove(lut, pc, def.degrees[k])
+                            : def.semis[k];
+            wrong += table.off[c][pc][k] != (float)semis / 12.f;
+          }
+        }
+    }
+  check(wrong == 0, "a chord voice is not its interval or scale note");
+
+  std::unique_ptr<UzzSim> dry = chordSim(1.f);
+  std::unique_ptr<UzzSim> wet = chordSim(0.002f);
+  float ref[2][UZZ_CHORD_VOICES];
+  int slewDiffs = 0, rootDiffs = 0;
+  const uint64_t samples = 64 * 6000;
+  for (uint64_t n = 0; n < samples; ++n) {
+    dry->process();
+    wet->process();
+    for (int t = 0; t < 2; ++t)
+      for (int k = 0; k < UZZ_CHORD_VOICES; ++k) {
+        const float target = dry->out.voices[t][k];
+        float &r = ref[t][k];
+        // The scalar slew as it was, one voice at a time.
+        r = n == 0 ? target : r + (target - r) * 0.002f;
+        slewDiffs += wet->out.voices[t][k] != r;
+        if (k >= dry->out.chordVoices[t])
+          rootDiffs += target != dry->out.pitch[t];
+      }
+  }
+  printf("chords: %d chords x 12 roots x %d scales, %d voices off; %llu "
+         "samples, %d slewed voices differ from the scalar slew\n",
+         UZZ_NUM_CHORDS, UZZ_NUM_SCALES, wrong, (unsigned long long)samples,
+         slewDiffs);
+  check(slewDiffs == 0, "the float_4 slew differs from the scalar slew");
+  check(rootDiffs == 0, "a voice the chord does not have is not the root");
+}
+
+// Trig conditions (user-050). Every A:B index maps back to its A and B. On
+// the engine, over 24 cycles with FILL low then high, each conditional step
+// sounds exactly on the cycles a step-by-step reading of the condition
+// allows, PRE following the last step with a condition or a roll.
+static void conditions() {
+  int badIndex = 0, next = UZZ_COND_RATIO_BASE;
+  for (int b = 2; b <= UZZ_COND_MAX_B; ++b)
+    for (int a = 1; a <= b; ++a, ++next) {
+      const UzzCondDef d = uzzCond(uzzCondRatio(a, b));
+      badIndex += uzzCondRatio(a, b) != next || d.kind != COND_RATIO ||
+                  d.a != a || d.b != b;
+    }
+  badIndex += next != UZZ_NUM_CONDS;
+  check(badIndex == 0, "an A:B condition index does not map back to A:B");
+
+  std::unique_ptr<UzzSim> sim(new UzzSim());
+  sim->engine.reseed(50);
+  for (int i = 0; i < 16; ++i) {
+    sim->raw[0][ROW_MODE][i] = SM_PLAY;
+    sim->raw[0][ROW_PROB][i] = 0.f;
+  }
+  sim->raw[0][ROW_PROB][10] = -50.f; // a roll, no condition
+  int8_t *cond = sim->engine.cond[0];
+  cond[1] = (int8_t)uzzCondRatio(1, 2);
+  cond[2] = (int8_t)uzzCondRatio(2, 3);
+  cond[3] = COND_PRE;
+  cond[4] = COND_FIRST;
+  cond[5] = COND_NOT_FIRST;
+  cond[6] = COND_FILL;
+  cond[7] = COND_NOT_PRE;
+  cond[8] = COND_NOT_FILL;
+  cond[9] = (int8_t)uzzCondRatio(8, 8);
+  cond[11] = COND_PRE;
+  cond[12] = COND_NOT_PRE;
+  sim->engine.conditionsChanged();
+  sim->compile();
+
+  const int cycles = 24;
+  sim->process(true); // cycle 0 starts at RESET
+  int cycle = -1, wrong = 0, landed = 0, rolled = 0;
+  bool last = false;
+  while (cycle < cycles) {
+    sim->in.fill = cycle >= cycles / 2;
+    sim->process();
+    if (!(sim->out.moved & 1))
+      continue;
+    const int i = sim->engine.tracks[0].step;
+    if (i == 0)
+      ++cycle;
+    if (cycle >= cycles)
+      break;
+    const bool fill = sim->in.fill, got = sim->out.gate[0];
+    const UzzCondDef d = uzzCond(cond[i]);
+    bool want = true, sets = true;
+    switch (d.kind) {
+    case COND_FILL: want = fill; break;
+    case COND_NOT_FILL: want = !fill; break;
+    case COND_PRE: want = last; sets = false; break;
+    case COND_NOT_PRE: want = !last; sets = false; break;
+    case COND_FIRST: want = cycle == 0; break;
+    case COND_NOT_FIRST: want = cycle != 0; break;
+    case COND_RATIO: want = cycle % d.b == d.a - 1; break;
+    default: sets = i == 10; break;
+    }
+    if (i == 10) {
+      want = got; // the roll, read back
+      rolled += got;
+    }
+    wrong += got != want;
+    if (sets)
+      last = got;
+    ++landed;
+  }
+  printf("conditions: %d steps over %d cycles, %d of %d rolls sounded, %d "
+         "off their condition\n",
+         landed, cycles, rolled, cycles, wrong);
+  check(landed == 16 * cycles && wrong == 0,
+        "a step sounds off its trig condition");
+  check(rolled > 0 && rolled < cycles, "PRE is not checked after both rolls");
+}
+
+int main() {
+  scaleTable();
+  chords();
+  conditions();
+  return report();
+}
@@ -0,0 +1,416 @@
+// UZZ pattern data: snapshots, the UI command queue and row edits, chaining
+// and CV record.
+//
+//   make -C tools uzz_patterns && tools/build/uzz_patterns
+
+#include "uzz/CommandQueue.hpp"
+#include "uzz/UzzSnapshots.hpp"
+#include "uzz_fixture.hpp"
+
+#include <climits>
+#include <thread>
+
+// Pattern snapshots (user-037). A step packs to 12 bytes and survives the
+// patch's hex form: the integer rows exactly, DUR, MOD1 and MOD2 to within
+// half a 16-bit step. A recall staged mid-step changes nothing until the
+// next tick, which plays the recalled pattern; MORPH lands on the target and
+// keeps PITCH on whole semitones.
+static void snapshots() {
+  check(sizeof(UzzPackedStep) == 12, "a packed snapshot step is not 12 bytes");
+  UzzRng rng;
+  rng.seed(37, 0);
+  UzzSnapshot a;
+  float raw[UZZ_MAX_TRACKS][16][NUM_STEP_ROWS];
+  int accum[UZZ_MAX_TRACKS][16];
+  for (int t = 0; t < UZZ_MAX_TRACKS; ++t)
+    for (int i = 0; i < 16; ++i) {
+      float *r = raw[t][i];
+      r[ROW_PITCH] = std::floor(rng.uniform() * 24.f);
+      r[ROW_OCT] = std::floor(rng.uniform() * 5.f) - 2.f;
+      r[ROW_MODE] = std::floor(rng.uniform() * 8.f);
+      r[ROW_DUR] = rng.uniform();
+      r[ROW_M1] = 10.f * rng.uniform();
+      r[ROW_M2] = 10.f * rng.uniform();
+      r[ROW_PROB] = std::floor(rng.uniform() * 108.f) - 100.f;
+      accum[t][i] = (int)std::floor(rng.uniform() * 25.f) - 12;
+      a.step[t][i].pack(r, accum[t][i]);
+    }
+  a.used = true;
+  const std::string hex = a.toHex();
+  UzzSnapshot b;
+  check(!b.fromHex(hex.substr(1).c_str()) && !b.used,
+        "a snapshot of the wrong length was accepted");
+  check(b.fromHex(hex.c_str()) && b.toHex() == hex,
+        "a snapshot does not survive its hex form");
+  int badRows = 0;
+  float worst = 0.f;
+  for (int t = 0; t < UZZ_MAX_TRACKS; ++t)
+    for (int i = 0; i < 16; ++i) {
+      float back[NUM_STEP_ROWS];
+      b.step[t][i].unpack(back);
+      const float *r = raw[t][i];
+      badRows += back[ROW_PITCH] != r[ROW_PITCH] ||
+                 back[ROW_OCT] != r[ROW_OCT] ||
+                 back[ROW_MODE] != r[ROW_MODE] ||
+                 back[ROW_PROB] != r[ROW_PROB] ||
+                 b.step[t][i].accum != accum[t][i];
+      worst = std::max(worst, std::fabs(back[ROW_DUR] - r[ROW_DUR]));
+      worst = std::max(worst, std::fabs(back[ROW_M1] - r[ROW_M1]) / 10.f);
+      worst = std::max(worst, std::fabs(back[ROW_M2] - r[ROW_M2]) / 10.f);
+    }
+  printf("snapshots: %zu hex characters, %d integer rows changed, DUR/MOD "
+         "within %.2g of their range\n",
+         hex.size(), badRows, worst);
+  check(badRows == 0 && worst <= 0.5f / 65535.f + 1e-6f,
+        "snapshot packing loses more than half a 16-bit step");
+
+  // Recall: pattern A plays; 1000 samples into its fourth step, pattern B
+  // (every pitch moved up 5) is staged. Against a run that never recalls,
+  // nothing differs until the next tick, which plays B.
+  std::unique_ptr<UzzSim> plain = playSim(37, false);
+  std::unique_ptr<UzzSim> recall = playSim(37, false);
+  for (UzzSim *sim : {plain.get(), recall.get()}) {
+    for (int i = 0; i < 16; ++i)
+      sim->raw[0][ROW_PITCH][i] = (float)(i % 12);
+    sim->compile();
+  }
+  const uint64_t stageAt = 480 + 3 * 6000 + 1000;
+  uint64_t tickAt = 0;
+  int before = 0, after = 0;
+  for (uint64_t n = 0; n < stageAt + 2 * 6000; ++n) {
+    if (n == stageAt) {
+      UzzTrackSnap &st = recall->engine.staged[0];
+      st = recall->engine.snap[0];
+      for (int i = 0; i < 16; ++i) {
+        st.raw[ROW_PITCH][i] += 5.f;
+        compileStepSnap(st, i, nullptr, 0.f, recall->m1Range,
+                        recall->m2Range, 0);
+      }
+      recall->engine.commitStaged();
+    }
+    plain->process();
+    recall->process();
+    if (!tickAt && n > stageAt && (recall->out.moved & 1))
+      tickAt = n;
+    if (!tickAt)
+      before += plain->out.pitch[0] != recall->out.pitch[0] ||
+                plain->out.gate[0] != recall->out.gate[0];
+    else if (n < tickAt + 100)
+      after += std::fabs(recall->out.pitch[0] - plain->out.pitch[0] -
+                         5.f / 12.f) > 1e-5f;
+  }
+  printf("recall: staged at %llu, swapped on the tick at %llu; %d samples "
+         "differ before it, %d after it miss the recalled pitch\n",
+         (unsigned long long)stageAt, (unsigned long long)tickAt, before,
+         after);
+  check(tickAt == 480 + 4 * 6000 && before == 0 && after == 0 &&
+            recall->engine.stagedSwapped,
+        "a staged recall does not take over on the next tick");
+
+  // MORPH: full morph reaches the target row, half way stays on semitones.
+  UzzTrackSnap s;
+  float target[NUM_STEP_ROWS];
+  int offGrid = 0, missed = 0;
+  for (int k = 0; k < 1000; ++k) {
+    for (int r = 0; r < NUM_STEP_ROWS; ++r) {
+      s.raw[r][0] = raw[k & 7][k & 15][r];
+      target[r] = raw[(k + 3) & 7][(k + 5) & 15][r];
+    }
+    const float morph = rng.uniform();
+    compileStepSnap(s, 0, target, morph, UZZRanges::MR_0_10,
+                    UZZRanges::MR_0_10, 0);
+    offGrid += s.step[0].semis != std::round(s.step[0].semis);
+    compileStepSnap(s, 0, target, 1.f, UZZRanges::MR_0_10,
+                    UZZRanges::MR_0_10, 0);
+    missed += s.step[0].semis != target[ROW_PITCH] ||
+              std::fabs(s.step[0].duty -
+                        clamp(target[ROW_DUR], 0.01f, 0.95f)) > 1e-6f;
+  }
+  check(offGrid == 0 && missed == 0,
+        "MORPH leaves PITCH off the semitone grid or misses its target");
+}
+
+// Snapshots on a three-module chain (48 slots). The store takes every slot,
+// accumulator offsets included, and the hex form keeps them; a recall staged
+// mid-step swaps all 48 in on the next tick, after which the run plays as one
+// that had the snapshot all along. MORPH reaches past slot 16 only with a snapshot
+// that holds it.
+static void chainSnapshots() {
+  std::unique_ptr<UzzSim> plain = playSim(41, false);
+  std::unique_ptr<UzzSim> recall = playSim(41, false);
+  for (UzzSim *sim : {plain.get(), recall.get()}) {
+    sim->in.slots = 48;
+    sim->in.steps = 48;
+    for (int i = 0; i < 48; ++i)
+      sim->engine.tracks[0].accumOffset[i] = i % 5 - 2;
+    sim->compile();
+  }
+  UzzSnapshot sn;
+  sn.store(recall->engine, 48,
+           [&](int t, int r, int i) { return recall->raw[t][r][i]; });
+  UzzSnapshot back;
+  check(sn.slots == 48 && back.fromHex(sn.toHex().c_str()) &&
+            back.slots == 48 && back.toHex() == sn.toHex(),
+        "a 48-slot snapshot does not survive its hex form");
+  UzzSnapshot short16;
+  short16.store(recall->engine, 16,
+                [&](int t, int r, int i) { return recall->raw[t][r][i]; });
+  check(!back.fromHex(short16.toHex().substr(20).c_str()) &&
+            back.fromHex(short16.toHex().c_str()) && back.slots == 16,
+        "a 16-slot snapshot is not read back as one");
+
+  // Pattern B on the recalling run: every pitch moved, no accumulators.
+  for (int i = 0; i < 48; ++i) {
+    float &p = recall->raw[0][ROW_PITCH][i];
+    p = std::fmod(p + 5.f, 24.f);
+    recall->engine.tracks[0].accumOffset[i] = 0;
+  }
+  recall->compile();
+
+  const uint64_t stageAt = 480 + 3 * 6000 + 1000;
+  uint64_t tickAt = 0;
+  int before = 0, after = 0, landings = 0;
+  for (uint64_t n = 0; n < stageAt + 50 * 6000; ++n) {
+    if (n == stageAt)
+      sn.stage(recall->engine, 48, 23, [&](UzzTrackSnap &s, int, int i) {
+        compileStepSnap(s, i, nullptr, 0.f, recall->m1Range,
+                        recall->m2Range, 0);
+      });
+    plain->process();
+    recall->process();
+    if (!tickAt && n > stageAt && (recall->out.moved & 1))
+      tickAt = n;
+    if (!tickAt) {
+      before += plain->out.pitch[0] == recall->out.pitch[0];
+    } else if (recall->out.moved & 1) {
+      ++landings;
+      after += std::fabs(recall->out.pitch[0] - plain->out.pitch[0]) > 1e-5f;
+    }
+  }
+  printf("chain recall: swapped on the tick at %llu, %d of %d steps after "
+         "it miss the snapshot\n",
+         (unsigned long long)tickAt, after, landings);
+  check(tickAt == 480 + 4 * 6000 && before == 0 && landings >= 48 &&
+            after == 0,
+        "a chain recall does not swap every slot in on the next tick");
+
+  // The followers' rows go down the chain from the swapped-in pattern.
+  int wrong = 0;
+  for (int t = 0; t < UZZ_MAX_TRACKS; ++t)
+    for (int i = 16; i < 48; ++i) {
+      float raw[NUM_STEP_ROWS];
+      sn.step[t][i].unpack(raw);
+      for (int r = 0; r < NUM_STEP_ROWS; ++r)
+        wrong += recall->engine.snap[t].raw[r][i] !=
+                 (r == ROW_PITCH ? std::min(raw[r], 23.f) : raw[r]);
+    }
+  check(wrong == 0, "the followers' slots do not hold the recalled rows");
+
+  float target[NUM_STEP_ROWS];
+  check(sn.target(0, 40, target) && !short16.target(0, 40, target) &&
+            short16.target(0, 15, target),
+        "MORPH targets the wrong slots of a chain snapshot");
+}
+
+// UI command queue (user-038). A UI thread pushing in bursts, retrying
+// when the queue is full, and the audio thread popping: every command
+// arrives once and in order. A push onto a full queue is refused and leaves
+// the queue as it was.
+static void commandQueue() {
+  struct Cmd {
+    uint32_t seq;
+    int type;
+  };
+  std::unique_ptr<CommandQueue<Cmd, 64>> q(new CommandQueue<Cmd, 64>());
+  const uint32_t n = 1000000;
+  long refused = 0;
+  std::thread ui([&]() {
+    for (uint32_t k = 0; k < n; ++k) {
+      const Cmd c = {k, (int)(k % 7)};
+      while (!q->push(c)) {
+        ++refused;
+        std::this_thread::yield();
+      }
+    }
+  });
+  uint32_t expect = 0;
+  long bad = 0;
+  Cmd c;
+  while (expect < n) {
+    if (!q->pop(c)) {
+      std::this_thread::yield();
+      continue;
+    }
+    bad += c.seq != expect || c.type != (int)(expect % 7);
+    ++expect;
+  }
+  ui.join();
+  bad += q->pop(c);
+  printf("command queue: %u commands across threads, %ld pushes refused "
+         "while full, %ld out of order\n",
+         n, refused, bad);
+  check(bad == 0, "commands lost, repeated or reordered across threads");
+
+  CommandQueue<Cmd, 64> full;
+  int pushed = 0;
+  while (full.push(Cmd{(uint32_t)pushed, 0}))
+    ++pushed;
+  bool order = pushed == 64;
+  for (int k = 0; k < 64; ++k)
+    order = order && full.pop(c) && c.seq == (uint32_t)k;
+  check(order && !full.pop(c),
+        "a full command queue did not hold 64 commands in order");
+}
+
+// Row edits (user-038). A row written the way writeEditRow() does it, into
+// a copy of the playing tables swapped in at once, plays from the next
+// landing on: against a run that never edits, every later landing of an
+// accumulating pattern is exactly the five semitones up, and nothing differs
+// before. The accumulators run on through the swap.
+static void rowEdit() {
+  std::unique_ptr<UzzSim> plain = busySim(4, 38), edited = busySim(4, 38);
+  const uint64_t editAt = 480 + 5 * 6000 + 1000;
+  int before = 0, after = 0, landings = 0;
+  for (uint64_t n = 0; n < editAt + 64 * 6000; ++n) {
+    if (n == editAt) {
+      UzzEngine &e = edited->engine;
+      for (int t = 0; t < e.trackCount; ++t)
+        e.staged[t] = e.snap[t];
+      UzzTrackSnap &s = e.staged[0];
+      for (int i = 0; i < 16; ++i) {
+        s.raw[ROW_PITCH][i] += 5.f;
+        compileStepSnap(s, i, nullptr, 0.f, edited->m1Range, edited->m2Range,
+                        0);
+      }
+      e.commitEdit();
+    }
+    plain->process();
+    edited->process();
+    if (n < editAt) {
+      before += plain->out.pitch[0] != edited->out.pitch[0];
+    } else if (edited->out.moved & 1) {
+      ++landings;
+      after += std::fabs(edited->out.pitch[0] - plain->out.pitch[0] -
+                         5.f / 12.f) > 1e-5f ||
+               edited->out.gate[0] != plain->out.gate[0];
+    }
+  }
+  printf("row edit: %d landings after the swap, %d samples differ before "
+         "it, %d landings miss the edited row\n",
+         landings, before, after);
+  check(landings > 0 && before == 0 && after == 0 &&
+            !edited->engine.stagedSwapped,
+        "a row edit swapped in does not play from the next landing");
+}
+
+// Chaining (user-040). A leader with two followers plays 48 slots in order,
+// never lands on a follower's SKIP step, and the step gate of each position
+// falls in the 16-position share of the module that holds it.
+static void chain() {
+  std::unique_ptr<UzzSim> sim = playSim(40, false);
+  const int skips[] = {20, 25, 47};
+  for (int i : skips)
+    sim->raw[0][ROW_MODE][i] = SM_SKIP;
+  sim->in.slots = 48;
+  sim->in.steps = 48;
+  sim->compile();
+  std::vector<int> visited;
+  int badGates = 0;
+  eachLanding(*sim, 3 * 48 * 6000, [&](uint64_t) {
+    const int slot = sim->engine.tracks[0].step;
+    visited.push_back(slot);
+    // What leader (k = 0) and followers (k = 1, 2) put on STEP GATES.
+    for (int k = 0; k < 3; ++k) {
+      const uint32_t share =
+          (uint32_t)(sim->out.stepGates >> (16 * k)) & 0xFFFF;
+      badGates += share != (k == slot / 16 ? 1u << (slot % 16) : 0u);
+    }
+  });
+  int badOrder = 0;
+  for (size_t k = 1; k < visited.size(); ++k) {
+    int want = (visited[k - 1] + 1) % 48;
+    while (want == 20 || want == 25 || want == 47)
+      want = (want + 1) % 48;
+    badOrder += visited[k] != want;
+  }
+  printf("chain: %zu steps over 48 slots, %d out of order, %d step gates in "
+         "the wrong module\n",
+         visited.size(), badOrder, badGates);
+  check(visited.size() > 100 && badOrder == 0 && badGates == 0,
+        "a 3-module chain does not play its 48 slots with SKIP and gates");
+}
+
+// CV record (user-045). A recorded voltage becomes the nearest note the OCT
+// and PITCH rows can play that is in the scale, for every scale, root and
+// pitch range. On the engine, a 16-note line with octave jumps and notes out
+// of range, recorded as the track lands on each step, plays back from the
+// next pass step for step in pitch and MOD1.
+static int nearestPlayable(const UzzScaleLut &lut, int range, int n) {
+  int best = INT_MAX;
+  for (int c = -24; c <= 24 + range; ++c)
+    if (lut.in[((c % 12) + 12) % 12] &&
+        (best == INT_MAX || std::abs(c - n) < std::abs(best - n)))
+      best = c;
+  return best;
+}
+
+static void cvRecord() {
+  UzzScaleLut lut;
+  int wrong = 0, checked = 0;
+  for (int range : {11, 23})
+    for (int scale = 0; scale < UZZ_NUM_SCALES; ++scale)
+      for (int root = 0; root < 12; ++root) {
+        lut.set(root, scale);
+        for (int n = -60; n <= 72; ++n, ++checked) {
+          int oct, pitch;
+          uzzRecordNote((float)n / 12.f, range, lut, oct, pitch);
+          wrong += oct < -2 || oct > 2 || pitch < 0 || pitch > range ||
+                   12 * oct + pitch != nearestPlayable(lut, range, n);
+        }
+      }
+  printf("cv record: %d voltages over 2 pitch ranges, %d not the nearest "
+         "playable note\n",
+         checked, wrong);
+  check(wrong == 0, "a recorded note is not the nearest playable one");
+
+  const float line[16] = {0.f,   7 / 12.f, 1.f,   -1.f,    2.f,  -2.f,
+                          2.9f,  4.f,      -3.f,  0.25f,   1.5f, -1.75f,
+                          10.f,  -10.f,    0.5f,  11 / 12.f};
+  int bad = 0, played = 0;
+  for (int scale : {0, 2}) {
+    std::unique_ptr<UzzSim> sim = playSim(45);
+    sim->engine.setScale(2, scale);
+    UzzTrackSnap &s = sim->engine.snap[0];
+    eachLanding(*sim, 2 * 16 * 6000, [&](uint64_t n) {
+      const int i = sim->engine.tracks[0].step;
+      const float mod = 0.7f * (float)i - 0.5f;
+      if (n < 16 * 6000) {
+        // What writeEditStep() does for each row: the value, then the step.
+        int oct, pitch;
+        uzzRecordNote(line[i], 11, sim->engine.scale, oct, pitch);
+        s.raw[ROW_OCT][i] = (float)oct;
+        s.raw[ROW_PITCH][i] = (float)pitch;
+        s.raw[ROW_M1][i] = clamp(mod, 0.f, 10.f);
+        compileStepSnap(s, i, nullptr, 0.f, sim->m1Range, sim->m2Range, 0);
+        return;
+      }
+      const int want = nearestPlayable(sim->engine.scale, 11,
+                                       (int)std::lround(line[i] * 12.f));
+      bad += std::fabs(sim->out.pitch[0] * 12.f - (float)want) > 1e-3f ||
+             sim->out.m1[0] != clamp(mod, 0.f, 10.f);
+      ++played;
+    });
+  }
+  check(played == 32 && bad == 0,
+        "a recorded line does not play back step for step");
+}
+
+int main() {
+  snapshots();
+  chainSnapshots();
+  commandQueue();
+  rowEdit();
+  chain();
+  cvRecord();
+  return report();
+}
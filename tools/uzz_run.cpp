@@ -0,0 +1,282 @@
+// Headless UZZ runner. Plays a set of seeded scenarios through UzzEngine
+// without Rack and writes what comes out as a trace: one line per sample on
+// which a gate, step gate or EOC changes or a track lands on a step, with the
+// pitch of every track at that moment. Compared against the goldens in
+// tools/golden/, it catches any change in what the engine plays.
+//
+//   make -C tools golden          compare against tools/golden/
+//   make -C tools golden-update   rewrite them after an intended change
+//   tools/build/uzz_run --bench   engine throughput, 8 tracks
+
+#include "uzz_sim.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <sstream>
+
+struct Scenario {
+  const char *name;
+  double seconds;
+  void (*setup)(UzzSim &sim);
+  // RESET edges, every `resetEvery` seconds; 0 = none.
+  double resetEvery;
+};
+
+static const int PLAY_MODES[] = {SM_PLAY, SM_PLAY, SM_MUTE, SM_SKIP,
+                                 SM_ACCUM_UP, SM_ACCUM_DOWN};
+static const int PULSE_MODES[] = {SM_PLAY, SM_PULSE, SM_GATED, SM_HOLD};
+static const int ALL_MODES[] = {SM_PLAY,       SM_MUTE,  SM_SKIP,
+                                SM_ACCUM_UP,   SM_ACCUM_DOWN, SM_PULSE,
+                                SM_GATED,      SM_HOLD};
+
+static void plain(UzzSim &sim) { sim.randomize(1, 1, PLAY_MODES, 6); }
+
+template <int Dir> static void direction(UzzSim &sim) {
+  sim.randomize(2, 1, PLAY_MODES, 6);
+  sim.in.modeDir = Dir;
+  sim.in.start = 3;
+  sim.in.steps = 11;
+  sim.engine.jumpN = 3;
+}
+
+static void pulses(UzzSim &sim) {
+  sim.randomize(3, 2, PULSE_MODES, 4);
+  sim.engine.trackCount = 2;
+}
+
+static void holdGlobal(UzzSim &sim) {
+  sim.randomize(4, 1, PLAY_MODES, 6);
+  sim.engine.pulseMode = UzzEngine::PM_HOLD;
+  sim.in.gateMode = 1;
+}
+
+static void poly(UzzSim &sim) {
+  sim.randomize(5, UZZ_MAX_TRACKS, ALL_MODES, 8);
+  sim.engine.trackCount = UZZ_MAX_TRACKS;
+  sim.engine.setScale(2, 3);
+  UzzRng rng;
+  rng.seed(5, 1);
+  for (int t = 0; t < UZZ_MAX_TRACKS; ++t)
+    for (int i = 0; i < 16; ++i)
+      sim.chord[t][i] = (int)(rng.uniform() * UZZ_NUM_CHORDS);
+  sim.in.pGlobal = 0.8f;
+  sim.in.xposeSemis = 5;
+  sim.in.slewAlpha = 0.05f;
+  sim.in.accumAmt = 3;
+  sim.in.accumWrap = 1;
+}
+
+static void ratioSwing(UzzSim &sim) {
+  sim.randomize(6, 1, PULSE_MODES, 4);
+  sim.in.ratio = 1.5f;
+  sim.in.swing = 0.3f;
+  sim.jitter = 0.002;
+}
+
+static void ratioDivide(UzzSim &sim) {
+  sim.randomize(7, 1, PLAY_MODES, 6);
+  sim.in.ratio = 1.f / 3.f;
+  sim.period = 0.05;
+}
+
+static void phaseLocked(UzzSim &sim) {
+  sim.randomize(8, 1, PLAY_MODES, 6);
+  sim.engine.clock.pllMode = true;
+  sim.in.ratio = 4.f;
+  sim.period = 0.5;
+  sim.jitter = 0.003;
+}
+
+static void groove(UzzSim &sim) {
+  sim.randomize(9, 2, PLAY_MODES, 6);
+  sim.engine.trackCount = 2;
+  for (int i = 0; i < 16; ++i)
+    sim.engine.grooveFrac[i] = UZZ_GROOVES[6].offset[i];
+  UzzRng rng;
+  rng.seed(9, 1);
+  for (int i = 0; i < 16; ++i)
+    sim.engine.microFrac[1][i] = 0.4f * rng.uniform() - 0.2f;
+  sim.engine.timingChanged();
+}
+
+static void conditions(UzzSim &sim) {
+  sim.randomize(10, 2, PLAY_MODES, 6);
+  sim.engine.trackCount = 2;
+  UzzRng rng;
+  rng.seed(10, 1);
+  for (int t = 0; t < 2; ++t)
+    for (int i = 0; i < 16; ++i)
+      sim.engine.cond[t][i] =
+          rng.uniform() < 0.5f ? 0 : (int8_t)(rng.uniform() * UZZ_NUM_CONDS);
+  sim.engine.conditionsChanged();
+  sim.in.steps = 8;
+}
+
+static void chain(UzzSim &sim) {
+  sim.randomize(11, 2, PLAY_MODES, 6);
+  sim.engine.trackCount = 2;
+  sim.in.slots = 48;
+  sim.in.start = 5;
+  sim.in.steps = 40;
+  sim.in.modeDir = DIR_PINGPONG;
+}
+
+static void resets(UzzSim &sim) {
+  sim.randomize(12, 1, PULSE_MODES, 4);
+  sim.engine.eocOnReset = true;
+  sim.in.start = 2;
+  sim.in.steps = 7;
+}
+
+static const Scenario SCENARIOS[] = {
+    {"forward", 4.0, plain, 0.0},
+    {"dir_pendulum", 2.0, direction<DIR_PENDULUM>, 0.0},
+    {"dir_backward", 2.0, direction<DIR_REV>, 0.0},
+    {"dir_random", 2.0, direction<DIR_RANDOM>, 0.0},
+    {"dir_drunk", 2.0, direction<DIR_DRUNK>, 0.0},
+    {"dir_pingpong", 2.0, direction<DIR_PINGPONG>, 0.0},
+    {"dir_odd_even", 2.0, direction<DIR_ODD_EVEN>, 0.0},
+    {"dir_jump", 2.0, direction<DIR_JUMP>, 0.0},
+    {"dir_converge", 2.0, direction<DIR_CONVERGE>, 0.0},
+    {"dir_diverge", 2.0, direction<DIR_DIVERGE>, 0.0},
+    {"pulses", 4.0, pulses, 0.0},
+    {"hold_trig", 4.0, holdGlobal, 0.0},
+    {"poly8", 4.0, poly, 0.0},
+    {"ratio_swing_jitter", 4.0, ratioSwing, 0.0},
+    {"ratio_divide", 4.0, ratioDivide, 0.0},
+    {"phase_locked", 6.0, phaseLocked, 0.0},
+    {"groove", 4.0, groove, 0.0},
+    {"conditions", 8.0, conditions, 0.0},
+    {"chain", 6.0, chain, 0.0},
+    {"resets", 4.0, resets, 0.77},
+};
+
+static std::string trace(const Scenario &sc) {
+  std::unique_ptr<UzzSim> owner(new UzzSim());
+  UzzSim &sim = *owner;
+  sim.engine.reseed(0x5EEDull);
+  sc.setup(sim);
+  sim.compile();
+  std::ostringstream os;
+  uint32_t lastGates = 0;
+  uint64_t lastSteps = 0;
+  bool lastEoc = false;
+  const uint64_t n = (uint64_t)(sc.seconds * sim.sampleRate);
+  const uint64_t resetEvery = (uint64_t)(sc.resetEvery * sim.sampleRate);
+  char line[64];
+  for (uint64_t i = 0; i < n; ++i) {
+    sim.process(resetEvery && i > 0 && i % resetEvery == 0);
+    const UzzEngine::Output &o = sim.out;
+    uint32_t gates = 0;
+    for (int t = 0; t < sim.engine.trackCount; ++t)
+      gates |= (uint32_t)o.gate[t] << t;
+    if (gates == lastGates && o.stepGates == lastSteps && o.eoc == lastEoc &&
+        !o.moved)
+      continue;
+    lastGates = gates;
+    lastSteps = o.stepGates;
+    lastEoc = o.eoc;
+    snprintf(line, sizeof(line), "%llu g%02x s%llx e%d m%02x",
+             (unsigned long long)i, gates, (unsigned long long)o.stepGates,
+             (int)o.eoc, o.moved);
+    os << line;
+    for (int t = 0; t < sim.engine.trackCount; ++t) {
+      snprintf(line, sizeof(line), " %.4f", o.pitch[t]);
+      os << line;
+    }
+    os << '\n';
+  }
+  return os.str();
+}
+
+static bool readFile(const std::string &path, std::string &out) {
+  std::ifstream f(path.c_str());
+  if (!f)
+    return false;
+  std::ostringstream os;
+  os << f.rdbuf();
+  out = os.str();
+  return true;
+}
+
+// First line on which a and b differ, 1-based; 0 if they are equal.
+static int firstDiff(const std::string &a, const std::string &b,
+                     std::string &lineA, std::string &lineB) {
+  std::istringstream sa(a), sb(b);
+  for (int n = 1;; ++n) {
+    const bool ga = (bool)std::getline(sa, lineA);
+    const bool gb = (bool)std::getline(sb, lineB);
+    if (!ga && !gb)
+      return 0;
+    if (!ga)
+      lineA = "(end)";
+    if (!gb)
+      lineB = "(end)";
+    if (!ga || !gb || lineA != lineB)
+      return n;
+  }
+}
+
+static void bench() {
+  std::unique_ptr<UzzSim> owner(new UzzSim());
+  UzzSim &sim = *owner;
+  sim.engine.reseed(1);
+  poly(sim);
+  sim.compile();
+  const double seconds = 120.0;
+  const uint64_t n = (uint64_t)(seconds * sim.sampleRate);
+  uint64_t steps = 0;
+  const auto t0 = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < n; ++i) {
+    sim.process();
+    steps += sim.out.moved & 1;
+  }
+  const double s = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - t0)
+                       .count();
+  printf("8 tracks: %.1f Msamples/s, %.0fx realtime at 48 kHz, %.1f ns per "
+         "sample (%llu steps)\n",
+         n / s * 1e-6, seconds / s, s / n * 1e9, (unsigned long long)steps);
+}
+
+int main(int argc, char **argv) {
+  bool write = false;
+  std::string dir = "golden";
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "--write"))
+      write = true;
+    else if (!std::strcmp(argv[i], "--bench")) {
+      bench();
+      return 0;
+    } else
+      dir = argv[i];
+  }
+  int failures = 0;
+  for (const Scenario &sc : SCENARIOS) {
+    const std::string got = trace(sc);
+    const std::string path = dir + "/" + sc.name + ".trace";
+    if (write) {
+      std::ofstream(path.c_str()) << got;
+      continue;
+    }
+    std::string want, a, b;
+    if (!readFile(path, want)) {
+      printf("%s: missing %s\n", sc.name, path.c_str());
+      ++failures;
+      continue;
+    }
+    if (const int line = firstDiff(want, got, a, b)) {
+      printf("%s: differs at line %d\n  golden: %s\n  now:    %s\n", sc.name,
+             line, a.c_str(), b.c_str());
+      ++failures;
+    }
+  }
+  if (write)
+    printf("wrote %d traces to %s\n",
+           (int)(sizeof(SCENARIOS) / sizeof(SCENARIOS[0])), dir.c_str());
+  else
+    printf(failures ? "%d scenarios differ\n" : "ok\n", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "uzz/UzzEngine.hpp"
+
+#include <cstdio>
+#include <string>
+
+// Headless UZZ for the tools: the engine plus the little the module does
+// around it — the raw step rows and their compiled tables, a clock source
+// and a RESET line. Built with UZZ_HEADLESS, so it needs no Rack SDK.
+struct UzzSim {
+  UzzEngine engine;
+  UzzEngine::Input in;
+  UzzEngine::Output out;
+
+  // Step rows of every track, value[row][slot] as in UzzTrackSnap::raw, and
+  // the chord of each of the first 16 slots.
+  float raw[UZZ_MAX_TRACKS][NUM_STEP_ROWS][UZZ_MAX_STEPS];
+  int chord[UZZ_MAX_TRACKS][16] = {};
+  int m1Range = UZZRanges::MR_0_10;
+  int m2Range = UZZRanges::MR_0_10;
+
+  // Clock: one pulse of `pulseWidth` every `period` seconds, each edge moved
+  // by up to +-jitter seconds. clockOn = false leaves CLK unpatched.
+  bool clockOn = true;
+  double period = 0.125;
+  double jitter = 0.0;
+  double pulseWidth = 0.005;
+  double nextEdge = 0.01;
+  double edgeAt = -1.0;
+  uint32_t jitterState = 12345;
+
+  double sampleRate = 48000.0;
+  uint64_t samples = 0;
+
+  UzzSim() {
+    for (int t = 0; t < UZZ_MAX_TRACKS; ++t)
+      for (int r = 0; r < NUM_STEP_ROWS; ++r)
+        for (int i = 0; i < UZZ_MAX_STEPS; ++i)
+          raw[t][r][i] = STEP_ROW_DEFAULTS[r];
+    in.sampleTime = (float)(1.0 / sampleRate);
+    engine.reset(0);
+  }
+
+  // Fills the rows of `tracks` tracks from seed with values in the knobs'
+  // ranges; `modes` lists the step modes to draw from.
+  void randomize(uint64_t seed, int tracks, const int *modes, int nModes) {
+    UzzRng rng;
+    rng.seed(seed, 0);
+    for (int t = 0; t < tracks; ++t)
+      for (int i = 0; i < UZZ_MAX_STEPS; ++i) {
+        float *r[NUM_STEP_ROWS];
+        for (int k = 0; k < NUM_STEP_ROWS; ++k)
+          r[k] = &raw[t][k][i];
+        *r[ROW_PITCH] = std::floor(rng.uniform() * 24.f);
+        *r[ROW_OCT] = std::floor(rng.uniform() * 5.f) - 2.f;
+        *r[ROW_MODE] = (float)modes[(int)(rng.uniform() * nModes)];
+        *r[ROW_DUR] = 0.05f + 0.9f * rng.uniform();
+        *r[ROW_M1] = 10.f * rng.uniform();
+        *r[ROW_M2] = 10.f * rng.uniform();
+        // Half the steps certain, the rest a probability or a pulse count.
+        const float p = rng.uniform();
+        *r[ROW_PROB] = p < 0.5f   ? 0.f
+                       : p < 0.8f ? -std::floor(rng.uniform() * 100.f)
+                                  : std::floor(1.f + rng.uniform() * 6.f);
+      }
+  }
+
+  // Compiles every slot of the playing tracks, as the module's
+  // refreshSnapshot() does.
+  void compile() {
+    for (int t = 0; t < engine.trackCount; ++t) {
+      UzzTrackSnap &s = engine.snap[t];
+      for (int i = 0; i < in.slots; ++i) {
+        for (int r = 0; r < NUM_STEP_ROWS; ++r)
+          s.raw[r][i] = raw[t][r][i];
+        compileStepSnap(s, i, nullptr, 0.f, m1Range, m2Range,
+                        i < 16 ? chord[t][i] : 0);
+      }
+      s.valid = true;
+    }
+  }
+
+  float nextJitter() {
+    jitterState = jitterState * 1664525u + 1013904223u;
+    return (jitterState >> 8) * (2.f / 16777216.f) - 1.f;
+  }
+
+  // One sample. `reset` is a rising edge on RESET this sample.
+  void process(bool reset = false) {
+    const double t = samples / sampleRate;
+    if (clockOn && t >= nextEdge) {
+      edgeAt = nextEdge;
+      nextEdge += period + jitter * nextJitter();
+    }
+    in.clkConnected = clockOn;
+    in.clkVoltage =
+        clockOn && edgeAt >= 0.0 && t < edgeAt + pulseWidth ? 10.f : 0.f;
+    in.reset = reset;
+    engine.process(in, out);
+    ++samples;
+  }
+};